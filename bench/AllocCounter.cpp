@@ -0,0 +1,36 @@
+// Counts every global heap allocation so benchmarks can report allocs/op.
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "Bench.h"
+
+namespace {
+std::atomic<uint64_t> gCount{0};
+std::atomic<uint64_t> gBytes{0};
+
+void* counted(std::size_t n) {
+  gCount.fetch_add(1, std::memory_order_relaxed);
+  gBytes.fetch_add(n, std::memory_order_relaxed);
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+} // namespace
+
+namespace bench {
+AllocStats allocStats() {
+  return AllocStats{gCount.load(std::memory_order_relaxed), gBytes.load(std::memory_order_relaxed)};
+}
+} // namespace bench
+
+void* operator new(std::size_t n) { return counted(n); }
+void* operator new[](std::size_t n) { return counted(n); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+  try { return counted(n); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept {
+  try { return counted(n); } catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,62 @@
+#pragma once
+/**
+ * @file Bench.h
+ * @brief Tiny host micro-benchmark harness (env:native only).
+ *
+ * - BENCHMARK(name) registers `void body(uint64_t iters)`; the body runs its
+ *   operation `iters` times.
+ * - The runner doubles iters until one run takes --min-ms, then keeps the
+ *   fastest of --repeat runs and reports ns/op plus heap allocations per op.
+ * - One JSON object per line on stdout, so CI can diff against a baseline:
+ *   {"bench":"state.update","iters":4194304,"ns_per_op":3.12,"allocs_per_op":0,"bytes_per_op":0}
+ * - A body may attach quality figures with metric("key", value); they are
+ *   appended to its line (e.g. step-response latency of a filter).
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bench {
+
+/** Running totals from the global operator new override (AllocCounter.cpp). */
+struct AllocStats {
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+};
+AllocStats allocStats();
+
+using Body = void (*)(uint64_t iters);
+
+/** Report an extra figure for the running case (last value per key wins). */
+void metric(const char* key, double value);
+
+struct Case {
+  const char* name;
+  Body        body;
+  Case*       next;
+
+  Case(const char* n, Body b) : name(n), body(b), next(head()) { head() = this; }
+  static Case*& head() {
+    static Case* h = nullptr;
+    return h;
+  }
+};
+
+/** Keep `v` (and everything it depends on) from being optimized away. */
+template <typename T>
+inline void doNotOptimize(const T& v) {
+  asm volatile("" : : "r,m"(v) : "memory");
+}
+
+/** Force pending writes to memory to be considered observable. */
+inline void clobber() { asm volatile("" : : : "memory"); }
+
+} // namespace bench
+
+#define BENCH_CAT2_(a, b) a##b
+#define BENCH_CAT_(a, b)  BENCH_CAT2_(a, b)
+
+#define BENCHMARK(name)                                                         \
+  static void BENCH_CAT_(benchBody_, __LINE__)(uint64_t iters);                 \
+  static ::bench::Case BENCH_CAT_(benchCase_, __LINE__){name, &BENCH_CAT_(benchBody_, __LINE__)}; \
+  static void BENCH_CAT_(benchBody_, __LINE__)(uint64_t iters)
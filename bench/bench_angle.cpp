@@ -0,0 +1,167 @@
+// Angle math and the ALS31300 driver over mocked I2C callbacks.
+#include <cmath>
+#include <cstdint>
+#include "Bench.h"
+#include "util/Angle.h"
+#include "util/AngleTracker.h"
+#include "drivers/allegro/als31300.h"
+#include "drivers/allegro/als31300Registers.h"
+
+namespace {
+
+// Mock bus: every read returns a fresh conversion for a slowly rotating field
+uint32_t gSample = 0;
+
+void putWord(uint8_t* b, uint32_t v) {
+  b[0] = uint8_t(v >> 24); b[1] = uint8_t(v >> 16); b[2] = uint8_t(v >> 8); b[3] = uint8_t(v);
+}
+
+bool mockRegister(uint8_t) { return true; }
+bool mockUnregister(uint8_t) { return true; }
+bool mockChangeAddress(uint8_t, uint8_t) { return true; }
+bool mockWrite(uint8_t, uint8_t*, size_t) { return true; }
+
+bool mockRead(uint8_t, uint8_t* index, size_t indexLen, uint8_t* out, size_t outLen) {
+  const uint8_t reg = indexLen ? index[0] : 0x28;     // loop modes park on 0x28
+  const util::Angle a = util::Angle::fromCdeg(static_cast<int32_t>(gSample++ * 97));
+  // Cheap synthetic field: a square-ish path is enough to exercise every octant
+  const int32_t c = a.cdeg();
+  const int32_t fx = (c < 18000 ? 1000 - c / 9 : -1000 + (c - 18000) / 9);
+  const int32_t fy = (c < 9000 || c >= 27000) ? (c < 9000 ? c / 9 : (c - 36000) / 9)
+                                              : 1000 - (c - 9000) / 9;
+  const uint32_t x12 = uint32_t(fx) & 0xFFF, y12 = uint32_t(fy) & 0xFFF, z12 = 0x100;
+
+  ALS31300::Register0x28 r28{0};
+  r28.xAxisMsbs = x12 >> 4; r28.yAxisMsbs = y12 >> 4; r28.zAxisMsbs = z12 >> 4;
+  r28.newData = 1; r28.temperatureMsbs = 0x1A;
+  ALS31300::Register0x29 r29{0};
+  r29.xAxisLsbs = x12 & 0xF; r29.yAxisLsbs = y12 & 0xF; r29.zAxisLsbs = z12 & 0xF;
+
+  if (reg == 0x28 && outLen >= 4) putWord(out, r28.raw);
+  if (reg == 0x28 && outLen >= 8) putWord(out + 4, r29.raw);
+  if (reg == 0x29 && outLen >= 4) putWord(out, r29.raw);
+  if (reg != 0x28 && reg != 0x29 && outLen >= 4) putWord(out, 0);  // config registers
+  return true;
+}
+
+void installMock() {
+  ALS31300::Sensor::setCallbacks(mockRegister, mockUnregister, mockChangeAddress, mockWrite, mockRead);
+}
+
+void runAls(ALS31300::Sensor::ReadMode mode, uint64_t iters) {
+  installMock();
+  ALS31300::Sensor s(0x60);
+  s.setReadMode(mode);
+  for (uint64_t i = 0; i < iters; ++i) {
+    s.update();
+    bench::doNotOptimize(s.angle());
+  }
+}
+
+// Step-response mock: field of a magnet at gTrueCdeg, |B| = 1000 counts, with
+// +-8 counts of deterministic per-axis noise (about 0.25 deg sigma)
+int32_t  gTrueCdeg = 0;
+uint32_t gNoise    = 12345;
+
+int32_t noise8() {
+  gNoise = gNoise * 1664525u + 1013904223u;
+  return static_cast<int32_t>(gNoise >> 28) - 8;
+}
+
+bool stepRead(uint8_t, uint8_t* index, size_t indexLen, uint8_t* out, size_t outLen) {
+  const uint8_t reg = indexLen ? index[0] : 0x28;
+  const double rad = gTrueCdeg * 3.14159265358979323846 / 18000.0;
+  const uint32_t x12 = uint32_t(int32_t(std::lround(1000.0 * std::cos(rad))) + noise8()) & 0xFFF;
+  const uint32_t y12 = uint32_t(int32_t(std::lround(1000.0 * std::sin(rad))) + noise8()) & 0xFFF;
+  const uint32_t z12 = 0x100;
+
+  ALS31300::Register0x28 r28{0};
+  r28.xAxisMsbs = x12 >> 4; r28.yAxisMsbs = y12 >> 4; r28.zAxisMsbs = z12 >> 4;
+  r28.newData = 1; r28.temperatureMsbs = 0x1A;
+  ALS31300::Register0x29 r29{0};
+  r29.xAxisLsbs = x12 & 0xF; r29.yAxisLsbs = y12 & 0xF; r29.zAxisLsbs = z12 & 0xF;
+
+  if (reg == 0x28 && outLen >= 4) putWord(out, r28.raw);
+  if (reg == 0x28 && outLen >= 8) putWord(out + 4, r29.raw);
+  if (reg == 0x29 && outLen >= 4) putWord(out, r29.raw);
+  if (reg != 0x28 && reg != 0x29 && outLen >= 4) putWord(out, 0);
+  return true;
+}
+
+/**
+ * Driver (+ optional tracker) against a 0 <-> 90 deg square wave, 100 samples
+ * per level. ns/op is per sample; the metrics come from the second rising
+ * edge (the first one also measures filter priming):
+ *   rise_ms        step until the output is within 10% (9 deg) of the target
+ *   overshoot_cdeg largest excursion past 90 deg
+ *   jitter_cdeg    peak-to-peak over the last 20 samples of the level
+ */
+void runStep(bool tracked, uint8_t filterShift, uint32_t periodUs, uint64_t iters) {
+  constexpr uint64_t kHalf = 100;
+  ALS31300::Sensor::setCallbacks(mockRegister, mockUnregister, mockChangeAddress, mockWrite, stepRead);
+  ALS31300::Sensor s(0x60);
+  s.setReadMode(ALS31300::Sensor::ReadMode::FullLoop);
+  s.setFilterShift(filterShift);
+  util::AngleTracker tracker({25, 20000, 1000});
+  gNoise = 12345;
+
+  int64_t riseAt = -1;
+  int32_t overshoot = 0, lo = 36000, hi = -36000;
+  uint32_t nowUs = 0;
+  for (uint64_t i = 0; i < iters; ++i, nowUs += periodUs) {
+    const uint64_t phase = i % (2 * kHalf);
+    gTrueCdeg = phase < kHalf ? 0 : 9000;
+    s.update();
+    util::Angle a = s.angle();
+    if (tracked) {
+      tracker.update(a, nowUs);
+      a = tracker.angle();
+    }
+    bench::doNotOptimize(a);
+
+    // Second rising edge: samples [3*kHalf, 4*kHalf)
+    if (i >= 3 * kHalf && i < 4 * kHalf) {
+      const int32_t err = a.deltaFrom(util::Angle::fromDeg(90));
+      if (riseAt < 0 && err > -900) riseAt = static_cast<int64_t>(i - 3 * kHalf);
+      if (err > overshoot) overshoot = err;
+      if (i >= 4 * kHalf - 20) {
+        if (err < lo) lo = err;
+        if (err > hi) hi = err;
+      }
+    }
+  }
+  if (iters >= 4 * kHalf) {
+    bench::metric("rise_ms", riseAt < 0 ? -1.0 : riseAt * (periodUs / 1000.0));
+    bench::metric("overshoot_cdeg", overshoot);
+    bench::metric("jitter_cdeg", hi - lo);
+  }
+}
+
+} // namespace
+
+BENCHMARK("angle.atan2_cdeg") {
+  int32_t x = 1234, y = -567;
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(x);
+    bench::doNotOptimize(util::atan2Cdeg(y, x));
+    x = (x * 7 + 13) % 4096 - 2048;
+    y = (y * 5 + 11) % 4096 - 2048;
+  }
+}
+
+BENCHMARK("angle.distance_to") {
+  util::Angle a = util::Angle::fromCdeg(100);
+  const util::Angle b = util::Angle::fromCdeg(35900);
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(a);
+    bench::doNotOptimize(a.distanceTo(b));
+  }
+}
+
+BENCHMARK("als.update.two_reads") { runAls(ALS31300::Sensor::ReadMode::TwoReads, iters); }
+BENCHMARK("als.update.burst")     { runAls(ALS31300::Sensor::ReadMode::Burst, iters); }
+BENCHMARK("als.update.full_loop") { runAls(ALS31300::Sensor::ReadMode::FullLoop, iters); }
+
+BENCHMARK("angle.step.iir5.50hz")              { runStep(false, 5, 20000, iters); }
+BENCHMARK("angle.step.alpha_beta.50hz")        { runStep(true, 1, 20000, iters); }
+BENCHMARK("angle.step.alpha_beta.200hz")       { runStep(true, 1, 5000, iters); }
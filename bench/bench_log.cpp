@@ -0,0 +1,38 @@
+// Deferred log: the cost a DLOG_* call adds to the calling task, vs formatting in place.
+#include <cstdint>
+#include <cstdio>
+#include "Bench.h"
+#include "util/DeferredLog.h"
+
+namespace {
+char line[160];
+
+// Stand-in for the log task: empty the ring without formatting
+void discardQueued() {
+  util::dlog::Record r;
+  while (util::dlog::ring().pop(r)) {}
+}
+} // namespace
+
+BENCHMARK("dlog.write") {
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(util::dlog::write(util::dlog::Debug, "Angle changed: %d°", static_cast<int>(i & 0xFF)));
+    if ((i & 31) == 31) discardQueued();
+  }
+  discardQueued();
+}
+
+// The log task's side: one record formatted into a line
+BENCHMARK("dlog.format") {
+  for (uint64_t i = 0; i < iters; ++i) {
+    util::dlog::write(util::dlog::Debug, "Angle changed: %d°", static_cast<int>(i & 0xFF));
+    bench::doNotOptimize(util::dlog::next(line, sizeof(line)));
+  }
+}
+
+// What the caller paid before: formatting on the spot
+BENCHMARK("dlog.snprintf_baseline") {
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(std::snprintf(line, sizeof(line), "Angle changed: %d°\n", static_cast<int>(i & 0xFF)));
+  }
+}
@@ -0,0 +1,267 @@
+// Native MQTT client against an in-memory broker (no sockets), and command routing.
+#include <cstdint>
+#include <cstring>
+#include "Bench.h"
+#include "net/INetClient.h"
+#include "protocols/mqtt/MqttCommandRouter.h"
+#include "protocols/mqtt/MqttNativeClient.h"
+#include "protocols/mqtt/MqttOutboundQueue.h"
+#include "telemetry/LatencyProbe.h"
+#include "util/ByteSink.h"
+
+namespace {
+
+uint32_t fakeNowMs = 0;
+uint32_t fakeClock() { return fakeNowMs; }
+
+// Answers CONNECT/SUBSCRIBE/PINGREQ at once; PUBACKs wait for ackAll()
+class FakeBroker : public net::INetClient {
+public:
+  bool connect(const char*, uint16_t) override {
+    up_ = true;
+    inLen_ = outLen_ = outPos_ = 0;
+    return true;
+  }
+  bool connected() const override { return up_; }
+  void stop() override { up_ = false; }
+  void setTimeout(unsigned long) override {}
+
+  size_t write(const uint8_t* buf, size_t len) override {
+    if (stall) return 0;                          // socket buffer full for now
+    if (!up_ || inLen_ + len > sizeof(in_)) return 0;
+    std::memcpy(in_ + inLen_, buf, len);
+    inLen_ += len;
+    parse_();
+    return len;
+  }
+
+  int read(uint8_t* buf, size_t len) override {
+    const size_t n = (outLen_ - outPos_) < len ? (outLen_ - outPos_) : len;
+    std::memcpy(buf, out_ + outPos_, n);
+    outPos_ += n;
+    if (outPos_ == outLen_) outPos_ = outLen_ = 0;
+    return static_cast<int>(n);
+  }
+  int available() const override { return static_cast<int>(outLen_ - outPos_); }
+
+  void ackAll() {
+    for (size_t i = 0; i < pending_; ++i) {
+      const uint8_t ack[] = {0x40, 0x02, static_cast<uint8_t>(ids_[i] >> 8), static_cast<uint8_t>(ids_[i])};
+      reply_(ack, sizeof(ack));
+    }
+    pending_ = 0;
+  }
+
+  uint64_t publishes = 0;
+  bool     stall     = false;
+
+private:
+  void reply_(const uint8_t* p, size_t n) {
+    if (outLen_ + n > sizeof(out_)) return;
+    std::memcpy(out_ + outLen_, p, n);
+    outLen_ += n;
+  }
+
+  void parse_() {
+    size_t pos = 0;
+    for (;;) {
+      if (inLen_ - pos < 2) break;
+      size_t rem = 0, i = pos + 1;
+      int shift = 0;
+      while (i < inLen_ && (in_[i] & 0x80)) { rem |= size_t(in_[i] & 0x7F) << shift; shift += 7; ++i; }
+      if (i >= inLen_) break;
+      rem |= size_t(in_[i] & 0x7F) << shift;
+      const size_t body = i + 1, end = body + rem;
+      if (end > inLen_) break;
+
+      const uint8_t type = in_[pos];
+      switch (type & 0xF0) {
+        case 0x10: { const uint8_t ack[] = {0x20, 0x02, 0x00, 0x00}; reply_(ack, sizeof(ack)); break; }
+        case 0x30:
+          ++publishes;
+          if (((type >> 1) & 3) == 1 && pending_ < 64) {
+            const size_t t = (size_t(in_[body]) << 8) | in_[body + 1];
+            ids_[pending_++] = static_cast<uint16_t>((in_[body + 2 + t] << 8) | in_[body + 3 + t]);
+          }
+          break;
+        case 0x80: {
+          const uint8_t ack[] = {0x90, 0x03, in_[body], in_[body + 1], 0x00};
+          reply_(ack, sizeof(ack));
+          break;
+        }
+        case 0xC0: { const uint8_t pong[] = {0xD0, 0x00}; reply_(pong, sizeof(pong)); break; }
+        default: break;
+      }
+      pos = end;
+    }
+    inLen_ -= pos;
+    if (inLen_) std::memmove(in_, in_ + pos, inLen_);
+  }
+
+  bool     up_ = false;
+  uint8_t  in_[2048];
+  size_t   inLen_ = 0;
+  uint8_t  out_[2048];
+  size_t   outLen_ = 0, outPos_ = 0;
+  uint16_t ids_[64];
+  size_t   pending_ = 0;
+};
+
+template <typename Client>
+void open(Client& c) {
+  mqtt::Config cfg;
+  cfg.clientId = "cannon-2";
+  c.begin(cfg);
+  c.connect();
+  c.loop();
+}
+
+} // namespace
+
+BENCHMARK("mqtt.native.publish_qos0") {
+  FakeBroker broker;
+  mqtt::NativeClient<> client(broker, &fakeClock);
+  open(client);
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(client.publish("MermaidsTale/Cannon2/Hor", "pre_123", false, 0));
+  }
+}
+
+// Socket full at publish time: the packet waits in tx_ and still counts as sent,
+// so a caller (OutboundQueue) never re-queues it into a duplicate
+BENCHMARK("mqtt.native.publish_qos0.stalled") {
+  FakeBroker broker;
+  mqtt::NativeClient<> client(broker, &fakeClock);
+  open(client);
+  uint64_t refused = 0;
+  for (uint64_t i = 0; i < iters; ++i) {
+    broker.stall = true;
+    if (!client.publish("MermaidsTale/Cannon2/Fired", "triggered", false, 0)) ++refused;
+    broker.stall = false;
+    client.loop();
+  }
+  bench::metric("refused", static_cast<double>(refused));
+  bench::metric("delivered_per_op", iters ? static_cast<double>(broker.publishes) / iters : 0);
+}
+
+// QoS1 document larger than an in-flight slot: sent as QoS0, never refused,
+// so an OutboundQueue does not stall behind it
+BENCHMARK("mqtt.native.publish_qos1.oversize") {
+  FakeBroker broker;
+  mqtt::NativeClient<> client(broker, &fakeClock);
+  open(client);
+  static const uint8_t doc[200] = {};
+  uint64_t refused = 0;
+  for (uint64_t i = 0; i < iters; ++i) {
+    if (!client.publish("MermaidsTale/Cannon2/diagnostics/memory", doc, sizeof(doc), false, 1)) ++refused;
+    client.loop();
+  }
+  bench::metric("refused", static_cast<double>(refused));
+  bench::metric("delivered_per_op", iters ? static_cast<double>(broker.publishes) / iters : 0);
+  bench::metric("downgraded_per_op", iters ? static_cast<double>(client.stats().qos1Oversize) / iters : 0);
+}
+
+// A window of 8 events in flight, acknowledged together (one broker RTT per window)
+BENCHMARK("mqtt.native.publish_qos1.pipelined") {
+  FakeBroker broker;
+  mqtt::NativeClient<> client(broker, &fakeClock);
+  open(client);
+  uint64_t refused = 0;
+  for (uint64_t i = 0; i < iters; ++i) {
+    if (!client.publish("MermaidsTale/Cannon2/Fired", "triggered", false, 1)) ++refused;
+    if ((i & 7) == 7) {
+      broker.ackAll();
+      client.loop();
+    }
+  }
+  bench::metric("refused", static_cast<double>(refused));
+  bench::metric("pubacks_per_op", iters ? static_cast<double>(client.stats().pubacks) / iters : 0);
+}
+
+namespace {
+int routed = 0;
+void countCommand(const mqtt::Command&, void*) { ++routed; }
+} // namespace
+
+// Last of four "+" routes, as a broadcast reset reaches each cannon
+BENCHMARK("mqtt.router.dispatch") {
+  routed = 0;
+  mqtt::CommandRouter<> router;
+  router.on({"MermaidsTale", "+", "status"}, &countCommand);
+  router.on({"MermaidsTale", "+", "trace"},  &countCommand);
+  router.on({"MermaidsTale", "+", "rates"},  &countCommand);
+  router.on({"MermaidsTale", "+", "reset"},  &countCommand);
+  const uint8_t payload[] = {'t', 'r', 'u', 'e'};
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(router.dispatch("MermaidsTale/Cannons/reset", payload, sizeof(payload)));
+  }
+  bench::metric("routed_per_op", iters ? static_cast<double>(routed) / iters : 0);
+}
+
+namespace {
+// Inner client for the queue: up or down on demand, checks what arrives
+class CheckingClient : public mqtt::IMqttClient {
+public:
+  bool begin(const mqtt::Config&) override { return true; }
+  bool connect() override { return up; }
+  void loop() override {}
+  bool connected() const override { return up; }
+  void disconnect() override { up = false; }
+  bool publish(const char* topic, const char* payload, bool retain, int qos) override {
+    return publish(topic, reinterpret_cast<const uint8_t*>(payload), std::strlen(payload), retain, qos);
+  }
+  bool publish(const char*, const uint8_t* payload, size_t len, bool, int) override {
+    if (!up) return false;
+    const Expect& e = expect[next++ % 2];
+    if (len == e.len && std::memcmp(payload, e.data, len) == 0) ++intact;
+    return true;
+  }
+  bool beginPublish(const char*, size_t, bool, int) override { return false; }
+  size_t write(const uint8_t*, size_t) override { return 0; }
+  bool endPublish() override { return false; }
+  bool subscribe(const char*, int) override { return true; }
+  void onMessage(mqtt::MessageHandler) override {}
+
+  struct Expect { const char* data; size_t len; };
+  Expect   expect[2] = {};
+  bool     up = false;
+  uint64_t next = 0;
+  uint64_t intact = 0;
+};
+} // namespace
+
+// Worst-case probe and pong lines queued while the link is down, with the
+// firmware's Fifo entry size, must all come back byte for byte
+BENCHMARK("mqtt.outbound.probe_worst_case") {
+  char probe[integ::kMaxProbeLen + 1];
+  util::BufferSink probeSink(probe, sizeof(probe));
+  util::TextWriter pw(probeSink);
+  integ::writeProbe(pw, {integ::ProbeKind::Fired, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu});
+
+  char token[integ::kMaxPingToken];
+  std::memset(token, '9', sizeof(token));
+  char pong[integ::kMaxPongLen + 1];
+  util::BufferSink pongSink(pong, sizeof(pong));
+  util::TextWriter ow(pongSink);
+  integ::writePong(ow, token, sizeof(token), 0xFFFFFFFFu);
+
+  CheckingClient inner;
+  inner.expect[0] = {probe, probeSink.size()};
+  inner.expect[1] = {pong, pongSink.size()};
+  mqtt::OutboundQueue<2, 1, 16, 512, integ::kMaxPongLen> q(inner);
+  q.route("MermaidsTale/Cannon2/probe", mqtt::QueuePolicy::Fifo);
+  q.route("MermaidsTale/Cannon2/pong", mqtt::QueuePolicy::Fifo);
+
+  uint32_t nowMs = 0;
+  for (uint64_t i = 0; i < iters; ++i) {
+    inner.up = false;
+    q.publish("MermaidsTale/Cannon2/probe", reinterpret_cast<const uint8_t*>(probe), probeSink.size());
+    q.publish("MermaidsTale/Cannon2/pong", reinterpret_cast<const uint8_t*>(pong), pongSink.size());
+    inner.up = true;
+    q.drain(nowMs += 1000);
+  }
+  bench::metric("probe_bytes", static_cast<double>(probeSink.size()));
+  bench::metric("pong_bytes", static_cast<double>(pongSink.size()));
+  bench::metric("dropped", static_cast<double>(q.stats().dropped));
+  bench::metric("intact_per_op", iters ? static_cast<double>(inner.intact) / (2 * iters) : 0);
+}
@@ -0,0 +1,177 @@
+// ctl::State, cannon::StateView and the telemetry serializers.
+#include <cstdint>
+#include "Bench.h"
+#include "state/ControllerState.h"
+#include "state/CannonStateView.h"
+#include "gateway/CannonChannels.h"
+#include "telemetry/ControllerTelemetrySource.h"
+#include "features/telemetry/TelemetryPublisher.h"
+#include "telemetry/TraceFrame.h"
+
+namespace {
+
+// Deterministic sweep: slow rotation, occasional press, ball coming and going
+void step(ctl::State& s, uint64_t i) {
+  const uint32_t t = static_cast<uint32_t>(i) * 20;
+  s.update(t, util::Angle::fromCdeg(static_cast<int32_t>(i * 37)), (i & 63) < 4,
+           static_cast<uint16_t>(20 + (i % 80)), true);
+}
+
+/** Accepts everything, sends nothing: isolates serializer cost. */
+class NullMqttClient : public mqtt::IMqttClient {
+public:
+  bool begin(const mqtt::Config&) override { return true; }
+  bool connect() override { return true; }
+  void loop() override {}
+  bool connected() const override { return true; }
+  void disconnect() override {}
+  bool publish(const char*, const char* p, bool, int) override { bench::doNotOptimize(p); return true; }
+  bool publish(const char*, const uint8_t* p, size_t, bool, int) override { bench::doNotOptimize(p); return true; }
+  bool beginPublish(const char*, size_t len, bool, int) override { bench::doNotOptimize(len); return true; }
+  size_t write(const uint8_t* d, size_t len) override { bench::doNotOptimize(d); return len; }
+  bool endPublish() override { return true; }
+  bool subscribe(const char*, int) override { return true; }
+  void onMessage(mqtt::MessageHandler) override {}
+};
+
+} // namespace
+
+BENCHMARK("state.update") {
+  ctl::State s;
+  for (uint64_t i = 0; i < iters; ++i) {
+    step(s, i);
+    bench::doNotOptimize(s.lastChangeMask());
+  }
+}
+
+BENCHMARK("state.to_json") {
+  ctl::State s;
+  step(s, 12345);
+  char buf[128];
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(s.toJson(buf, sizeof(buf)));
+    bench::clobber();
+  }
+}
+
+BENCHMARK("state.to_delta_json") {
+  ctl::State s;
+  step(s, 1);
+  step(s, 2);
+  char buf[128];
+  const uint32_t all = ctl::ChangedAngle | ctl::ChangedButton | ctl::ChangedDistance | ctl::ChangedPresence;
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(s.toDeltaJson(buf, sizeof(buf), all));
+    bench::clobber();
+  }
+}
+
+BENCHMARK("state.write_json.counting") {
+  ctl::State s;
+  step(s, 12345);
+  for (uint64_t i = 0; i < iters; ++i) {
+    util::CountingSink c;
+    s.writeJson(c);
+    bench::doNotOptimize(c.size());
+  }
+}
+
+BENCHMARK("state.write_cbor") {
+  ctl::State s;
+  step(s, 12345);
+  for (uint64_t i = 0; i < iters; ++i) {
+    util::CountingSink c;
+    s.writeCbor(c, ctl::kAllFields);
+    bench::doNotOptimize(c.size());
+  }
+}
+
+BENCHMARK("state.write_packed") {
+  ctl::State s;
+  step(s, 12345);
+  for (uint64_t i = 0; i < iters; ++i) {
+    util::CountingSink c;
+    s.writePacked(c, ctl::kAllFields);
+    bench::doNotOptimize(c.size());
+  }
+}
+
+BENCHMARK("view.update") {
+  ctl::State s;
+  cannon::StateView<ctl::State> v(s);
+  for (uint64_t i = 0; i < iters; ++i) {
+    step(s, i);
+    bench::doNotOptimize(v.update());
+  }
+}
+
+BENCHMARK("telemetry.publish_snapshot") {
+  ctl::State s;
+  step(s, 12345);
+  ControllerTelemetrySource src(s);
+  NullMqttClient client;
+  telem::TelemetryConfig cfg{"MermaidsTale/Cannon2", "state", "changes", true, 0};
+  telem::TelemetryPublisher pub(client, src, cfg);
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(pub.publishSnapshot());
+  }
+}
+
+BENCHMARK("telemetry.publish_snapshot.json+packed") {
+  ctl::State s;
+  step(s, 12345);
+  ControllerTelemetrySource src(s);
+  NullMqttClient client;
+  telem::TelemetryConfig cfg{"MermaidsTale/Cannon2", "state", "changes", true, 0};
+  cfg.binEncoding = TelemetryEncoding::Packed;
+  telem::TelemetryPublisher pub(client, src, cfg);
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(pub.publishSnapshot());
+  }
+}
+
+BENCHMARK("trace.encode_frame.25") {
+  // Slowly turning magnet with sensor noise, ball resting: the typical tuning trace
+  integ::TraceSample samples[25];
+  for (int k = 0; k < 25; ++k) {
+    integ::TraceSample& t = samples[k];
+    t.tsMs = 1000u + 20u * k;
+    t.rawX = static_cast<int16_t>(800 + 3 * k + (k & 3));
+    t.rawY = static_cast<int16_t>(-400 + 2 * k - (k & 1));
+    t.rawZ = static_cast<int16_t>(50 + (k % 3));
+    t.x = static_cast<int16_t>(800 + 3 * k);
+    t.y = static_cast<int16_t>(-400 + 2 * k);
+    t.z = 51;
+    t.angleCdeg = static_cast<uint16_t>(33300 + 20 * k);
+    t.rangeMm = static_cast<uint8_t>(40 + (k & 1));
+    t.distanceMm = 40;
+    t.flags = integ::TraceAlsOk | integ::TracePresent | ((k & 1) ? integ::TraceRangeFresh : 0);
+  }
+  uint8_t frame[integ::traceFrameMaxBytes(25)];
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(integ::encodeTraceFrame(samples, 25, static_cast<uint16_t>(i), 0,
+                                                 frame, sizeof(frame)));
+    bench::clobber();
+  }
+}
+
+BENCHMARK("gateway.sample.4ch") {
+  // Four channels round-robin, each magnet turning at its own rate
+  gateway::CannonChannels<4> ch;
+  for (uint8_t k = 0; k < 4; ++k) ch.add(3 + k, 0x61 + k);
+  uint8_t blocks[16][8];
+  for (int k = 0; k < 16; ++k) {
+    const uint32_t x = static_cast<uint32_t>(800 - 40 * k) & 0xFFF;
+    const uint32_t y = static_cast<uint32_t>(-400 + 60 * k) & 0xFFF;
+    const uint32_t w28 = (x >> 4) << 24 | (y >> 4) << 16 | 1u << 7;   // newData
+    const uint32_t w29 = (x & 0xF) << 16 | (y & 0xF) << 12;
+    for (int b = 0; b < 4; ++b) {
+      blocks[k][b]     = static_cast<uint8_t>(w28 >> (24 - 8 * b));
+      blocks[k][4 + b] = static_cast<uint8_t>(w29 >> (24 - 8 * b));
+    }
+  }
+  for (uint64_t i = 0; i < iters; ++i) {
+    const std::size_t c = ch.next();
+    bench::doNotOptimize(ch.sample(c, static_cast<uint32_t>(i) * 5000u, blocks[(i >> 2) & 15], (i & 255) < 8));
+  }
+}
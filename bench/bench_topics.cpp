@@ -0,0 +1,56 @@
+// Topic building, validation and inbound dispatch.
+#include <cstdint>
+#include "Bench.h"
+#include "protocols/mqtt/MqttTopic.h"
+#include "telemetry/CannonTopics.h"
+
+BENCHMARK("mqttt.join") {
+  char out[64];
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(mqttt::join(out, sizeof(out), {"MermaidsTale", "Cannon2", "Hor"}));
+    bench::clobber();
+  }
+}
+
+BENCHMARK("mqttt.validate_publish") {
+  const char* topic = "MermaidsTale/Cannon2/Fired/at";
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(topic);
+    bench::doNotOptimize(mqttt::validatePublishTopic(topic));
+  }
+}
+
+BENCHMARK("mqttt.validate_subscribe") {
+  const char* filter = "MermaidsTale/+/reset/#";
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(filter);
+    bench::doNotOptimize(mqttt::validateSubscribeFilter(filter));
+  }
+}
+
+BENCHMARK("topics.build") {
+  cannon::Topics t;
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(t.build("MermaidsTale", static_cast<uint8_t>(i & 7)));
+  }
+}
+
+BENCHMARK("topics.find.hit") {
+  cannon::Topics t;
+  t.build("MermaidsTale", 2);
+  const char* topic = "MermaidsTale/Cannon2/reset";
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(topic);
+    bench::doNotOptimize(t.find(topic));
+  }
+}
+
+BENCHMARK("topics.find.miss") {
+  cannon::Topics t;
+  t.build("MermaidsTale", 2);
+  const char* topic = "MermaidsTale/Cannon3/reset";
+  for (uint64_t i = 0; i < iters; ++i) {
+    bench::doNotOptimize(topic);
+    bench::doNotOptimize(t.find(topic));
+  }
+}
@@ -0,0 +1,88 @@
+// Host benchmark runner: pio run -e native && .pio/build/native/program [--filter s] [--min-ms n] [--repeat n]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Bench.h"
+
+namespace {
+
+struct Metric {
+  const char* key;
+  double      value;
+};
+constexpr int kMaxMetrics = 8;
+Metric gMetrics[kMaxMetrics];
+int    gMetricCount = 0;
+
+struct Options {
+  const char* filter = nullptr;
+  double      minMs  = 50.0;
+  int         repeat = 5;
+};
+
+double runOnce(bench::Body body, uint64_t iters) {
+  using clock = std::chrono::steady_clock;
+  const auto t0 = clock::now();
+  body(iters);
+  const auto t1 = clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+void runCase(const bench::Case& c, const Options& opt) {
+  // Calibrate: grow until a single run is long enough to time reliably
+  uint64_t iters = 1;
+  const double minNs = opt.minMs * 1e6;
+  while (runOnce(c.body, iters) < minNs && iters < (1ull << 40)) iters <<= 1;
+
+  double best = 0;
+  for (int r = 0; r < opt.repeat; ++r) {
+    const double ns = runOnce(c.body, iters);
+    if (r == 0 || ns < best) best = ns;
+  }
+
+  gMetricCount = 0;
+  const bench::AllocStats a0 = bench::allocStats();
+  c.body(iters);
+  const bench::AllocStats a1 = bench::allocStats();
+
+  std::printf("{\"bench\":\"%s\",\"iters\":%llu,\"ns_per_op\":%.3f,"
+              "\"allocs_per_op\":%.3f,\"bytes_per_op\":%.1f",
+              c.name, static_cast<unsigned long long>(iters), best / iters,
+              static_cast<double>(a1.count - a0.count) / iters,
+              static_cast<double>(a1.bytes - a0.bytes) / iters);
+  for (int i = 0; i < gMetricCount; ++i) {
+    std::printf(",\"%s\":%.3f", gMetrics[i].key, gMetrics[i].value);
+  }
+  std::printf("}\n");
+  std::fflush(stdout);
+}
+
+} // namespace
+
+void bench::metric(const char* key, double value) {
+  for (int i = 0; i < gMetricCount; ++i) {
+    if (!std::strcmp(gMetrics[i].key, key)) { gMetrics[i].value = value; return; }
+  }
+  if (gMetricCount < kMaxMetrics) gMetrics[gMetricCount++] = Metric{key, value};
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--filter") && i + 1 < argc)      opt.filter = argv[++i];
+    else if (!std::strcmp(argv[i], "--min-ms") && i + 1 < argc) opt.minMs  = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "--repeat") && i + 1 < argc) opt.repeat = std::atoi(argv[++i]);
+    else {
+      std::fprintf(stderr, "usage: %s [--filter substr] [--min-ms n] [--repeat n]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (opt.repeat < 1) opt.repeat = 1;
+
+  for (const bench::Case* c = bench::Case::head(); c; c = c->next) {
+    if (opt.filter && !std::strstr(c->name, opt.filter)) continue;
+    runCase(*c, opt);
+  }
+  return 0;
+}
@@ -119,6 +119,13 @@ public:
 
   std::string toString() const; // implemented in pins.cpp
 
+  // Copy with a different GPIO group (e.g. preset + sensor IRQ lines)
+  constexpr BoardPins withGpio(GPIO gpio) const noexcept {
+    BoardPins p = *this;
+    p.gpio_ = gpio;
+    return p;
+  }
+
   // Handy preset
   static constexpr BoardPins DevKitS3_DefaultI2C(Pin sda = 8, Pin scl = 9,
                                                   I2CFreqHz hz = 400000U) noexcept {
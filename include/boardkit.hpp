@@ -22,3 +22,4 @@
 
 #include "drivers/allegro/als31300.h"
 #include "drivers/allegro/als31300Registers.h"
+#include "drivers/st/vl6180x.h"
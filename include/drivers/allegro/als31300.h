@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <cstddef>
 
+#include "util/Angle.h"
+
 // https://www.allegromicro.com/-/media/files/datasheets/als31300-datasheet.ashx
 
 namespace ALS31300
@@ -28,6 +30,8 @@ namespace ALS31300
         static bool defaultRegisterCallback(uint8_t) { return false; }
         static bool defaultUnregisterCallback(uint8_t) { return false; }
         static bool defaultChangeAddressCallback(uint8_t, uint8_t) { return false; }
+        static bool defaultTransportRead(void*, uint8_t, uint8_t*, size_t, uint8_t*, size_t) { return false; }
+        static bool defaultTransportWrite(void*, uint8_t, uint8_t*, size_t) { return false; }
 
         static ReadCallback i2cRead;
         static WriteCallback i2cWrite;
@@ -36,26 +40,142 @@ namespace ALS31300
         static ChangeAddressCallback i2cChangeAddress;
 
     public:
+        /**
+         * Per-instance I2C access: `ctx` is passed back on every call, so
+         * sensors on different buses never share state. I2CBus::ctxRead /
+         * I2CBus::ctxWrite with ctx = &bus fit directly.
+         */
+        struct Transport
+        {
+            using Read = bool (*)(void* ctx, uint8_t address, uint8_t* sendPayload, size_t sendSize, uint8_t* receivePayload, size_t receiveSize);
+            using Write = bool (*)(void* ctx, uint8_t address, uint8_t* sendPayload, size_t sendSize);
+
+            void* ctx = nullptr;
+            Read read = nullptr;
+            Write write = nullptr;
+        };
+
+        /**
+         * How update() fetches the 0x28/0x29 measurement pair.
+         * - TwoReads: one indexed transaction per register (legacy path).
+         * - Burst:    one indexed 8-byte block read (register pointer auto-increments).
+         * - FullLoop: Register0x27::i2cLoopMode = full loop; the part streams
+         *             0x28/0x29 back-to-back, so after the first indexed read every
+         *             sample is a bare 8-byte read with no index phase.
+         * - FastLoop: Register0x27::i2cLoopMode = fast loop; only 0x28 (MSBs) is
+         *             streamed, 4 bytes per sample at 8-bit resolution.
+         */
+        enum class ReadMode : uint8_t { TwoReads, Burst, FastLoop, FullLoop };
+
+        /** Register0x27::lowPowerCounter: time asleep between duty-cycled samples. */
+        enum class LowPowerInterval : uint8_t { Ms0_5, Ms1, Ms5, Ms10, Ms50, Ms100, Ms500, Ms1000 };
+
         static void setCallbacks(RegisterCallback registerCallback, UnregisterCallback unregisterCallback, ChangeAddressCallback changeAddressCallback, WriteCallback writeCallback, ReadCallback readCallback);
 
+        /** Legacy: I2C through the process-wide setCallbacks() functions. */
         Sensor(uint8_t address);
+        /** I2C through `transport` only; setCallbacks() is not consulted. */
+        Sensor(uint8_t address, const Transport& transport);
         ~Sensor();
 
+        /**
+         * Fetch a measurement and filter X/Y/Z. Returns false on bus error.
+         * When the part reports no new conversion (Register0x28::newData == 0)
+         * the filter is left untouched and hasNewData() returns false.
+         */
         bool update();
-        uint16_t getAngle();
+
+        /** Heading from the filtered X/Y field, in centi-degrees (no float math). */
+        util::Angle angle() const;
+        /** Whole degrees 0..359 (rounded). */
+        uint16_t getAngle() const { return angle().deg(); }
+
+        /**
+         * IIR strength as a power of two: each sample moves the filtered value
+         * 1/2^shift of the way (5 == the historical 32-tap filter, 0 == raw).
+         */
+        void setFilterShift(uint8_t shift) { filterShift_ = shift > 12 ? 12 : shift; primed_ = false; }
+        uint8_t filterShift() const { return filterShift_; }
+
+        /** Select the read strategy; programs Register0x27 for the loop modes. */
+        bool setReadMode(ReadMode mode);
+        ReadMode readMode() const { return readMode_; }
+
+        /** True if the last successful update() carried a fresh conversion. */
+        bool hasNewData() const { return newData_; }
+
+        /**
+         * Motion wake, part 1 (EEPROM Register0x02/0x03): delta-mode interrupt
+         * on X and Y, latched. INT (open drain, active low) asserts once either
+         * axis moves more than its 6-bit threshold (0..63, datasheet scale)
+         * from where it was when the interrupt was last cleared. The EEPROM
+         * is only written when the contents differ, so calling this on every
+         * start costs two reads.
+         */
+        bool setWakeThresholds(uint8_t xThreshold, uint8_t yThreshold);
+
+        /**
+         * Motion wake, part 2 (Register0x27): duty-cycled low-power mode, one
+         * conversion per `interval` with the interrupt compare still running,
+         * or back to continuous conversion. The read mode is kept; clears a
+         * latched interrupt on entry so the delta reference is the field now.
+         */
+        bool setLowPower(bool enable, LowPowerInterval interval = LowPowerInterval::Ms100);
+        bool lowPower() const { return lowPower_; }
+
+        /** Release a latched INT (Register0x29::intWrite). */
+        bool clearInterrupt();
+
+        /** Register0x28::interrupt as of the last successful update(). */
+        bool interruptFlagged() const { return interrupt_; }
 
         bool programAddress(uint8_t newAddress);
 
-        float x = 0.0f;
-        float y = 0.0f;
-        float z = 0.0f;
+        /**
+         * Start over at `newAddress`: filter, loop-mode, low-power and new-data
+         * state are cleared as if freshly constructed (transport and
+         * registration kept).
+         */
+        void restart(uint8_t newAddress);
+
+        // Filtered field, raw 12-bit sensor units
+        int16_t x = 0;
+        int16_t y = 0;
+        int16_t z = 0;
+
+        // Last unfiltered sample (sign-extended 12-bit), for tracing/tuning
+        int16_t rawX = 0;
+        int16_t rawY = 0;
+        int16_t rawZ = 0;
+        int16_t temperatureCenti = 0; // 0.01 degC, from the 12-bit 0x28/0x29 temperature field
 
         uint8_t address = 0;
 
     private:
-        float avgAngle = 0.0f;
+        // Q(filterShift_) accumulators: value << filterShift_ at steady state
+        int32_t xAcc_ = 0;
+        int32_t yAcc_ = 0;
+        int32_t zAcc_ = 0;
+        uint8_t filterShift_ = 5;
+        bool    primed_ = false;
+
+        ReadMode readMode_ = ReadMode::TwoReads;
+        bool     loopPrimed_ = false; // register pointer already parked on 0x28
+        bool     newData_ = false;
+        bool     interrupt_ = false;
+        bool     lowPower_ = false;
+        LowPowerInterval lowPowerInterval_ = LowPowerInterval::Ms100;
+
+        Transport transport_;
+        bool      legacy_ = true;   // registered through i2cRegister
+
+        static bool legacyRead(void*, uint8_t address, uint8_t* send, size_t sendSize, uint8_t* recv, size_t recvSize) { return i2cRead(address, send, sendSize, recv, recvSize); }
+        static bool legacyWrite(void*, uint8_t address, uint8_t* send, size_t sendSize) { return i2cWrite(address, send, sendSize); }
+
+        bool busRead(uint8_t* send, size_t sendSize, uint8_t* recv, size_t recvSize) { return transport_.read(transport_.ctx, address, send, sendSize, recv, recvSize); }
+        bool busWrite(uint8_t* send, size_t sendSize) { return transport_.write(transport_.ctx, address, send, sendSize); }
 
-        float angleFromXY(float x, float y);
-        void xyFromAngle(float angle, float& x, float& y);
+        bool readMeasurement(uint32_t& reg28, uint32_t& reg29);
+        bool writeRegister27(ReadMode mode, bool lowPower, LowPowerInterval interval);
     };
 }
\ No newline at end of file
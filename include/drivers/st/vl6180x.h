@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "hal/i2c.h"
+#include "hal/gpio.h"
+
+// https://www.st.com/resource/en/datasheet/vl6180x.pdf
+
+namespace VL6180X
+{
+    /** Continuous-ranging timing. The part needs period > convergence + ~5 ms readout. */
+    struct RangingConfig
+    {
+        uint16_t intermeasurementMs = 20; // 10..2550 ms, 10 ms steps
+        uint8_t  maxConvergenceMs   = 10; // 1..63 ms
+    };
+
+    /** One completed range measurement. */
+    struct RangeSample
+    {
+        uint8_t  rangeMm = 0;
+        uint8_t  status  = 0;   // RESULT__RANGE_STATUS error code (0 = OK)
+        uint32_t tsMs    = 0;   // millis() when the result was read
+    };
+
+    /**
+     * RangingEngine: non-blocking continuous ranging on top of an already
+     * initialized VL6180X (e.g. after Adafruit_VL6180X::begin() loaded the
+     * tuning settings).
+     *
+     * - GPIO1 is programmed as an active-low "new range sample ready" output.
+     * - If a GPIO1 pin is wired, its falling edge sets a flag from the ISR and
+     *   poll() only touches the bus when a sample is waiting.
+     * - Without a pin (GPIO_NC), poll() reads the one-byte interrupt status
+     *   register instead; still no busy-waiting.
+     * - If the IRQ goes quiet for several periods (missed edge, unwired pin)
+     *   poll() falls back to the status register so ranging never stalls.
+     */
+    class RangingEngine
+    {
+    public:
+        static constexpr uint8_t defaultAddress = 0x29;
+
+        RangingEngine(I2CBus& bus, GpioPin gpio1 = GpioPin(), uint8_t address = defaultAddress);
+
+        /** Program interrupt, timing and start continuous ranging. */
+        bool start(const RangingConfig& config = RangingConfig{});
+
+        /** Stop continuous ranging and release the GPIO1 interrupt. */
+        bool stop();
+
+        /** Never blocks on convergence. Returns true if `out` holds a new sample. */
+        bool poll(RangeSample& out);
+
+        bool running() const { return running_; }
+        bool usingInterrupt() const { return gpio1_.valid(); }
+        const RangingConfig& config() const { return config_; }
+
+        /** Optional hook invoked from the ISR (e.g. to wake a task). */
+        using ReadyHook = void (*)(void* arg);
+        void setReadyHook(ReadyHook hook, void* arg) { hook_ = hook; hookArg_ = arg; }
+
+    private:
+        bool write8(uint16_t reg, uint8_t value);
+        bool read8(uint16_t reg, uint8_t& value);
+        bool sampleReady(unsigned long nowMs);
+
+        static void onReady(void* arg);
+
+        I2CBus&       bus_;
+        GpioPin       gpio1_;
+        uint8_t       address_;
+        RangingConfig config_{};
+        bool          running_ = false;
+
+        volatile bool ready_ = false;
+        ReadyHook     hook_ = nullptr;
+        void*         hookArg_ = nullptr;
+        unsigned long lastSampleMs_ = 0;
+    };
+}
@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cstdio>
 #include "protocols/mqtt/MqttClient.h"          // your IMqttClient abstraction
+#include "protocols/mqtt/MqttPublishStream.h"
 #include "features/telemetry/TelemetrySource.h"
 
 namespace telem {
@@ -13,6 +14,11 @@ struct TelemetryConfig {
   const char* deltaEvt;  // e.g. "evt/changes"
   bool retainState = true;
   int  qos = 0;
+  // Optional compact copy on parallel topics so JSON consumers are untouched.
+  // Off while binEncoding == Json (the primary topics always carry JSON).
+  TelemetryEncoding binEncoding = TelemetryEncoding::Json;
+  const char* stateBinEvt = "state.bin";
+  const char* deltaBinEvt = "changes.bin";
 };
 
 class TelemetryPublisher {
@@ -22,33 +28,62 @@ public:
                      const TelemetryConfig& cfg) noexcept
   : client_(client), source_(source), cfg_(cfg) {}
 
+  // Payloads are measured, then streamed straight into the PUBLISH packet,
+  // so there is no payload buffer and no size cap beyond the client's own.
   bool publishDeltas() {
-    char topic[128]; if (!join(topic, sizeof(topic), cfg_.base, cfg_.deltaEvt)) return false;
-    char payload[256];
-    if (!source_.buildDeltaJson(payload, sizeof(payload))) return false; // nothing changed
-    return client_.publish(topic, payload, /*retain=*/false, cfg_.qos);
+    if (!topicsReady()) return false;
+    bool ok = mqtt::publishStreamed(client_, deltaTopic_,
+      [this](util::ByteSink& s) { return source_.writeDeltaJson(s); }, // false: nothing changed
+      /*retain=*/false, cfg_.qos);
+    if (ok && binaryOn()) {
+      ok = mqtt::publishStreamed(client_, deltaBinTopic_,
+        [this](util::ByteSink& s) { return source_.writeDelta(s, cfg_.binEncoding); },
+        /*retain=*/false, cfg_.qos);
+    }
+    return ok;
   }
 
   bool publishSnapshot() {
-    char topic[128]; if (!join(topic, sizeof(topic), cfg_.base, cfg_.stateEvt)) return false;
-    char payload[256];
-    size_t n = source_.buildSnapshotJson(payload, sizeof(payload));
-    safeTerm(payload, sizeof(payload), n);
-    return client_.publish(topic, payload, cfg_.retainState, cfg_.qos);
+    if (!topicsReady()) return false;
+    bool ok = mqtt::publishStreamed(client_, stateTopic_,
+      [this](util::ByteSink& s) { return source_.writeSnapshotJson(s); },
+      cfg_.retainState, cfg_.qos);
+    if (binaryOn()) {
+      ok = mqtt::publishStreamed(client_, stateBinTopic_,
+        [this](util::ByteSink& s) { return source_.writeSnapshot(s, cfg_.binEncoding); },
+        cfg_.retainState, cfg_.qos) && ok;
+    }
+    return ok;
   }
 
 private:
   mqtt::IMqttClient&  client_;
   ITelemetrySource&   source_;
   TelemetryConfig     cfg_;
+  char                stateTopic_[128] = {};
+  char                deltaTopic_[128] = {};
+  char                stateBinTopic_[128] = {};
+  char                deltaBinTopic_[128] = {};
+  bool                joined_ = false;
+
+  bool binaryOn() const { return cfg_.binEncoding != TelemetryEncoding::Json; }
+
+  // Topics are joined once, on first publish (cfg_.base may be filled after construction)
+  bool topicsReady() {
+    if (!joined_) {
+      joined_ = join(stateTopic_, sizeof(stateTopic_), cfg_.base, cfg_.stateEvt) &&
+                join(deltaTopic_, sizeof(deltaTopic_), cfg_.base, cfg_.deltaEvt) &&
+                (!binaryOn() ||
+                 (join(stateBinTopic_, sizeof(stateBinTopic_), cfg_.base, cfg_.stateBinEvt) &&
+                  join(deltaBinTopic_, sizeof(deltaBinTopic_), cfg_.base, cfg_.deltaBinEvt)));
+    }
+    return joined_;
+  }
 
   static bool join(char* out, size_t cap, const char* a, const char* b) {
     int n = std::snprintf(out, cap, "%s/%s", a, b);
     return n > 0 && (size_t)n < cap;
   }
-  static void safeTerm(char* out, size_t cap, size_t n) {
-    if (cap) out[(n < cap) ? n : cap - 1] = '\0';
-  }
 };
 
 } // namespace telem
@@ -1,14 +1,43 @@
 #pragma once
 #include <cstddef>
+#include <cstdint>
+#include "util/ByteSink.h"
+
+// Payload formats a source may offer. JSON is the human-readable default;
+// CBOR and Packed are compact binary forms with a schema owned by the source.
+enum class TelemetryEncoding : uint8_t { Json, Cbor, Packed };
 
 // A minimal "provider" that can produce telemetry payloads as JSON.
 // No project-specific types here. Implement this near your machine code.
 struct ITelemetrySource {
   virtual ~ITelemetrySource() = default;
 
+  // Write only changed fields into out, return false if nothing changed (or the sink failed).
+  // Must produce identical bytes when called twice in a row (measure, then stream).
+  virtual bool writeDeltaJson(util::ByteSink& out) = 0;
+
+  // Write full snapshot into out, return true if fully written. Same determinism rule.
+  virtual bool writeSnapshotJson(util::ByteSink& out) = 0;
+
+  // Any encoding (same determinism rule). JSON maps to the methods above;
+  // sources without a binary form return false for Cbor/Packed.
+  virtual bool writeDelta(util::ByteSink& out, TelemetryEncoding enc) {
+    return enc == TelemetryEncoding::Json && writeDeltaJson(out);
+  }
+  virtual bool writeSnapshot(util::ByteSink& out, TelemetryEncoding enc) {
+    return enc == TelemetryEncoding::Json && writeSnapshotJson(out);
+  }
+
+  // Buffer helpers over the sink variants.
   // Write only changed fields into out[0..cap), return true if anything changed/payload written.
-  virtual bool buildDeltaJson(char* out, size_t cap) = 0;
+  virtual bool buildDeltaJson(char* out, size_t cap) {
+    util::BufferSink sink(out, cap);
+    return writeDeltaJson(sink) && sink.ok();
+  }
 
-  // Write full snapshot into out[0..cap), return bytes written.
-  virtual size_t buildSnapshotJson(char* out, size_t cap) = 0;
+  // Write full snapshot into out[0..cap), return bytes written (0 on failure).
+  virtual size_t buildSnapshotJson(char* out, size_t cap) {
+    util::BufferSink sink(out, cap);
+    return (writeSnapshotJson(sink) && sink.ok()) ? sink.size() : 0;
+  }
 };
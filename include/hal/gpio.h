@@ -10,6 +10,7 @@
 enum class ActivePolarity : uint8_t { ActiveHigh, ActiveLow };
 enum class Pull          : uint8_t { None, Up, Down };
 enum class GpioMode      : uint8_t { Input, Output, OpenDrain };
+enum class GpioEdge      : uint8_t { Rising, Falling, Both };  // raw (electrical) edges
 
 // Allow projects to override the underlying pin storage type at build time.
 // Example (platformio.ini): build_flags = -DGPIO_PIN_T=uint32_t
@@ -69,6 +70,23 @@ public:
   void writeRaw(bool high) const { if (valid()) digitalWrite(pin_, high ? HIGH : LOW); }
   void toggle() const            { write(!read()); }
 
+  // Edge interrupt on this pin. The ISR runs in interrupt context: keep it
+  // short and IRAM-resident (IRAM_ATTR) on ESP32.
+  using IsrFn = void (*)(void* arg);
+  void attachIrq(IsrFn isr, void* arg, GpioEdge edge) const {
+    if (!valid()) return;
+    const int mode = (edge == GpioEdge::Rising)  ? RISING
+                   : (edge == GpioEdge::Falling) ? FALLING
+                                                 : CHANGE;
+    attachInterruptArg(digitalPinToInterrupt(pin_), isr, arg, mode);
+  }
+  void detachIrq() const { if (valid()) detachInterrupt(digitalPinToInterrupt(pin_)); }
+
+  // Electrical edge on which the logical state becomes active
+  constexpr GpioEdge activeEdge() const noexcept {
+    return (pol_ == ActivePolarity::ActiveHigh) ? GpioEdge::Rising : GpioEdge::Falling;
+  }
+
   // Mutable configuration (if you want to reuse the object)
   void setMode(GpioMode m)               { mode_ = m; }
   void setPull(Pull p)                   { pull_ = p; }
@@ -1,22 +1,43 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
 #include <cstddef>
 #include "board/pins.h"
 
+class TwoWire;
+
 /**
  * I2CBus: Arduino/Wire-backed I²C wrapper with no globals.
- * - Owns SDA/SCL/frequency/timeout.
+ * - Owns SDA/SCL/frequency/timeout and a controller port (0 = Wire,
+ *   1 = Wire1), so each hardware controller can be its own live instance.
  * - Idempotent init via begin().
- * - Static callback thunks so sensor drivers (e.g., ALS31300) can pass
- *   plain function pointers without depending on Wire directly.
+ * - Context thunks (ctxRead/ctxWrite, ctx = the I2CBus*) for drivers that
+ *   take a per-instance transport, e.g. ALS31300::Sensor::Transport.
+ * - Legacy static callback thunks route to one "active" instance, for
+ *   drivers that only accept plain function pointers.
  *
  * Usage:
- *   I2CBus bus(pins.i2c());      // construct from your BoardPins::I2C
- *   bus.begin();                 // initialize Wire once
+ *   I2CBus angleBus(pins.i2c());                        // port 0 (Wire)
+ *   I2CBus rangeBus(BoardPins::I2C{8, 9}, 50, 1);       // port 1 (Wire1)
+ *   ALS31300::Sensor als(0x60, {&angleBus, I2CBus::ctxRead, I2CBus::ctxWrite});
+ *   adafruitVl.begin(&rangeBus.wire());
+ *
+ *   // legacy
  *   I2CBus::setActive(&bus);     // route callbacks to this instance
  *   ALS31300::Sensor::setCallbacks(
  *     I2CBus::cbRegisterDevice, I2CBus::cbUnregisterDevice,
  *     I2CBus::cbChangeAddress,  I2CBus::cbWrite, I2CBus::cbRead);
+ *
+ * Async engine (ESP32, optional):
+ *   bus.startAsync();            // worker task + transaction queue
+ *   I2CBus::Transaction t; t.address = 0x29; t.tx = idx; t.txLen = 2;
+ *   t.rx = buf; t.rxLen = 1; t.done = onDone; t.ctx = this;
+ *   bus.submit(t);               // returns immediately; onDone runs on the worker
+ *   // or chain t.next = &u; bus.submit(t) to run both in one bus acquisition
+ *
+ * Once started, read()/write() (and so every thunk) become a synchronous
+ * facade: they submit a transaction and sleep until the worker completes it.
+ * Each started bus has its own worker, so two buses transfer in parallel.
  */
 class I2CBus {
 public:
@@ -26,29 +47,54 @@ public:
   constexpr I2CBus(BoardPins::Pin sda,
                    BoardPins::Pin scl,
                    BoardPins::I2CFreqHz hz = 400000U,
-                   std::uint16_t timeout_ms = 50) noexcept
-  : sda_(sda), scl_(scl), hz_(hz), timeout_ms_(timeout_ms) {}
+                   std::uint16_t timeout_ms = 50,
+                   std::uint8_t port = 0) noexcept
+  : sda_(sda), scl_(scl), hz_(hz), timeout_ms_(timeout_ms), port_(port) {}
 
   // Construct from BoardPins::I2C struct
   constexpr explicit I2CBus(const BoardPins::I2C& cfg,
-                            std::uint16_t timeout_ms = 50) noexcept
-  : sda_(cfg.sda), scl_(cfg.scl), hz_(cfg.hz), timeout_ms_(timeout_ms) {}
+                            std::uint16_t timeout_ms = 50,
+                            std::uint8_t port = 0) noexcept
+  : sda_(cfg.sda), scl_(cfg.scl), hz_(cfg.hz), timeout_ms_(timeout_ms), port_(port) {}
 
-  /** Initialize Wire with this bus config (safe to call multiple times). */
+  /** Initialize this port's Wire instance (safe to call multiple times). */
   void begin();
 
+  /** Controller port (0 = Wire, 1 = Wire1). */
+  std::uint8_t port() const { return port_; }
+
+  /** The Arduino TwoWire behind this bus, for libraries that want one. */
+  TwoWire& wire() const;
+
+  /** Address-only transfer; the Wire endTransmission() code (0 = ACK). */
+  std::uint8_t probe(Addr address);
+
   /** Probe an address (returns true if device ACKs). */
-  bool devicePresent(Addr address);
+  bool devicePresent(Addr address) { return probe(address) == 0; }
 
   /** Write payload with STOP. */
   bool write(Addr address, const std::uint8_t* payload, std::size_t n);
 
-  /** Write register/index (no STOP), then read bytes (repeated START). */
+  /**
+   * Write register/index (no STOP), then read bytes (repeated START).
+   * With index_len == 0 this is a plain read (no write phase), for devices
+   * that stream from an already-set register pointer.
+   */
   bool read(Addr address,
             const std::uint8_t* index, std::size_t index_len,
             std::uint8_t* out, std::size_t out_len);
 
-  // ---- Driver callback thunks (route to the "active" I2CBus instance) ----
+  /** Change the bus clock (e.g. 100 kHz / 400 kHz / 1 MHz); applies immediately if started. */
+  void setFrequency(BoardPins::I2CFreqHz hz);
+  BoardPins::I2CFreqHz frequency() const { return hz_; }
+
+  // ---- Per-instance thunks (ctx is the I2CBus*) ----
+  static bool ctxWrite(void* bus, std::uint8_t addr, std::uint8_t* payload, std::size_t n);
+  static bool ctxRead (void* bus, std::uint8_t addr,
+                       std::uint8_t* send, std::size_t send_n,
+                       std::uint8_t* recv, std::size_t recv_n);
+
+  // ---- Legacy callback thunks (route to the "active" I2CBus instance) ----
   static void setActive(I2CBus* bus);
   static bool cbRegisterDevice(std::uint8_t addr);
   static bool cbUnregisterDevice(std::uint8_t addr);
@@ -58,6 +104,57 @@ public:
                       std::uint8_t* send, std::size_t send_n,
                       std::uint8_t* recv, std::size_t recv_n);
 
+  // ---- Asynchronous transaction engine ----
+
+  enum class TxnState : std::uint8_t { Idle, Queued, Done, Failed };
+
+  /**
+   * One write-then-read transaction (either phase may be empty). Caller owns
+   * the descriptor and both buffers until the state leaves Queued.
+   * Transactions linked through `next` form a batch that the worker runs
+   * back-to-back with repeated STARTs inside a single bus acquisition.
+   */
+  struct Transaction {
+    using Callback = void (*)(Transaction& txn, bool ok, void* ctx);
+
+    Addr                 address = 0;
+    const std::uint8_t*  tx      = nullptr;
+    std::size_t          txLen   = 0;
+    std::uint8_t*        rx      = nullptr;
+    std::size_t          rxLen   = 0;
+    Callback             done    = nullptr;  // runs on the I2C worker task
+    void*                ctx     = nullptr;
+    Transaction*         next    = nullptr;  // batch chain (only the head is submitted)
+
+    std::atomic<TxnState> state{TxnState::Idle};
+    void*                 waiter = nullptr;  // task to notify on completion; set before submit() to use wait()
+
+    bool pending()   const { return state.load(std::memory_order_acquire) == TxnState::Queued; }
+    bool succeeded() const { return state.load(std::memory_order_acquire) == TxnState::Done; }
+  };
+
+  /**
+   * Start the worker task that drains the transaction queue through the
+   * ESP-IDF I2C master driver on this bus. Safe to call more than once.
+   * @return false if the platform has no async backend or allocation failed.
+   */
+  bool startAsync(std::size_t queueDepth = 16, unsigned priority = 5, int core = 1);
+  bool asyncRunning() const { return queue_ != nullptr; }
+  /** Worker task (TaskHandle_t), nullptr before startAsync(). For stack watermarks. */
+  void* workerTask() const { return worker_; }
+
+  /** Queue a transaction (or a `next`-linked batch). Never blocks. */
+  bool submit(Transaction& head);
+
+  /**
+   * Block the calling task until `head` (and its batch) completes or
+   * timeout_ms elapses. Returns true if every transaction succeeded.
+   */
+  bool wait(Transaction& head, std::uint32_t timeout_ms);
+
+  /** Submit + wait in one call (what the synchronous facade uses). */
+  bool transact(Transaction& head, std::uint32_t timeout_ms);
+
   /**
    * @brief Attempt to free a stuck I²C bus when SDA is held low by a slave.
    *
@@ -79,7 +176,18 @@ private:
   BoardPins::Pin        scl_;
   BoardPins::I2CFreqHz  hz_;
   std::uint16_t         timeout_ms_;
+  std::uint8_t          port_;
   bool                  inited_ = false;
 
+  void*                 queue_  = nullptr;  // QueueHandle_t of Transaction*
+  void*                 worker_ = nullptr;  // TaskHandle_t
+
+  bool wireWrite_(Addr address, const std::uint8_t* payload, std::size_t n);
+  bool wireRead_(Addr address, const std::uint8_t* index, std::size_t index_len,
+                 std::uint8_t* out, std::size_t out_len);
+  bool onWorker_() const;
+  static void workerMain_(void* arg);
+  bool runBatch_(Transaction& head);
+
   static I2CBus* active_; // used only by the static callback thunks
 };
@@ -2,6 +2,13 @@
 #include <Arduino.h>
 #include <cstdint>
 #include "../gpio.h"   // uses GpioPin
+#include "util/SpscRing.h"
+
+/** How a DebouncedButton learns about pin changes. */
+enum class ButtonMode : uint8_t {
+  Polling,    // sample the pin in update()
+  Interrupt,  // GPIO edge ISR timestamps every transition; update() debounces those
+};
 
 /**
  * DebouncedButton: software-debounced view over a GpioPin configured as an input.
@@ -9,11 +16,14 @@
  * - Debounce window (default 30 ms).
  * - update() returns true once per committed edge (press or release).
  * - pressed()/released() report the current debounced logical state (honors polarity).
+ * - Interrupt mode: an edge ISR records (µs timestamp, level) into a lock-free
+ *   queue, so presses shorter than the update() period are not lost and
+ *   edgeUs() reports when the committed transition physically started.
  */
 class DebouncedButton {
 public:
-  DebouncedButton(GpioPin pin, uint16_t debounceMs = 30)
-  : pin_(pin), debounceMs_(debounceMs) {}
+  DebouncedButton(GpioPin pin, uint16_t debounceMs = 30, ButtonMode mode = ButtonMode::Polling)
+  : pin_(pin), debounceMs_(debounceMs), mode_(mode) {}
 
   void begin() {
     pin_.begin();
@@ -21,16 +31,52 @@ public:
     stable_      = lastReading_;
     prevStable_  = stable_;
     lastChangeMs_ = millis();
+    lastChangeUs_ = micros();
+    edgeUs_       = lastChangeUs_;
+    if (mode_ == ButtonMode::Interrupt) {
+      droppedSeen_ = edges_.dropped();
+      pin_.attachIrq(&DebouncedButton::onEdge_, this, GpioEdge::Both);
+    }
   }
 
   // Call frequently (e.g., every loop). Returns true if a clean edge occurred.
   bool update() {
+    return (mode_ == ButtonMode::Interrupt) ? updateFromEdges_() : updatePolling_();
+  }
+
+  // Current debounced state
+  bool pressed()  const { return stable_; }
+  bool released() const { return !stable_; }
+
+  // Edge helpers (valid only immediately after update() returned true)
+  bool rose() const { return (prevStable_ == false && stable_ == true); }
+  bool fell() const { return (prevStable_ == true  && stable_ == false); }
+
+  /** micros() at which the last committed transition began (true press/release time). */
+  uint32_t edgeUs() const { return edgeUs_; }
+
+  /** A change is waiting out the debounce window; call update() again after it. */
+  bool settling() const { return lastReading_ != stable_ || !edges_.empty(); }
+
+  /** Optional hook invoked from the edge ISR (Interrupt mode, e.g. to wake a task). */
+  using EdgeHook = void (*)(void* arg);
+  void setEdgeHook(EdgeHook hook, void* arg) { hook_ = hook; hookArg_ = arg; }
+
+  // Config
+  void setDebounceMs(uint16_t ms) { debounceMs_ = ms; }
+  ButtonMode mode() const { return mode_; }
+
+private:
+  struct Edge { uint32_t us; bool level; };
+
+  bool updatePolling_() {
     const bool reading = pin_.read();
     const unsigned long now = millis();
 
     if (reading != lastReading_) {
       lastReading_ = reading;
       lastChangeMs_ = now;        // restart debounce window
+      if (reading != stable_) edgeUs_ = micros();
     }
 
     if ((now - lastChangeMs_) >= debounceMs_ && reading != stable_) {
@@ -41,23 +87,66 @@ public:
     return false;
   }
 
-  // Current debounced state
-  bool pressed()  const { return stable_; }
-  bool released() const { return !stable_; }
+  // Replay queued edges in order. A level that held for the debounce window
+  // before the next edge is committed, one commit per call, so a complete
+  // press+release burst still yields a press and then a release.
+  bool updateFromEdges_() {
+    const uint32_t windowUs = static_cast<uint32_t>(debounceMs_) * 1000U;
 
-  // Edge helpers (valid only immediately after update() returned true)
-  bool rose() const { return (prevStable_ == false && stable_ == true); }
-  bool fell() const { return (prevStable_ == true  && stable_ == false); }
+    while (const Edge* e = edges_.peek()) {
+      if (lastReading_ != stable_ && (e->us - lastChangeUs_) >= windowUs) {
+        return commit_();         // level settled before this edge arrived
+      }
+      apply_(e->us, e->level);
+      Edge drop;
+      edges_.pop(drop);
+    }
 
-  // Config
-  void setDebounceMs(uint16_t ms) { debounceMs_ = ms; }
+    // Lost edges (queue overflow): resynchronize from the pin itself
+    if (edges_.dropped() != droppedSeen_) {
+      droppedSeen_ = edges_.dropped();
+      apply_(micros(), pin_.read());
+    }
+
+    if (lastReading_ != stable_ && (micros() - lastChangeUs_) >= windowUs) {
+      return commit_();
+    }
+    return false;
+  }
+
+  void apply_(uint32_t us, bool level) {
+    if (level == lastReading_) return;
+    // First deviation from the stable level marks the physical edge time
+    if (lastReading_ == stable_) edgeUs_ = us;
+    lastReading_  = level;
+    lastChangeUs_ = us;
+  }
+
+  bool commit_() {
+    prevStable_ = stable_;
+    stable_     = lastReading_;
+    return true;
+  }
+
+  static void IRAM_ATTR onEdge_(void* arg) {
+    auto* self = static_cast<DebouncedButton*>(arg);
+    self->edges_.push(Edge{static_cast<uint32_t>(micros()), self->pin_.read()});
+    if (self->hook_) self->hook_(self->hookArg_);
+  }
 
-private:
   GpioPin        pin_;
   uint16_t       debounceMs_;
+  ButtonMode     mode_;
 
   bool           lastReading_  = false;  // most recent raw logical reading
   bool           stable_       = false;  // current debounced state
   bool           prevStable_   = false;  // previous debounced state (for edge helpers)
   unsigned long  lastChangeMs_ = 0;      // last time the raw reading flipped
+  uint32_t       lastChangeUs_ = 0;      // same, µs (interrupt mode)
+  uint32_t       edgeUs_       = 0;      // start of the last committed transition
+
+  util::SpscRing<Edge, 16> edges_;       // ISR -> update()
+  uint32_t       droppedSeen_  = 0;
+  EdgeHook       hook_         = nullptr;
+  void*          hookArg_      = nullptr;
 };
@@ -19,12 +19,14 @@ public:
    * @param pull        Button pull config (default internal pull-up)
    * @param polarity    Button polarity (active-low for GND-when-pressed wiring)
    * @param debounceMs  Debounce window in ms
+   * @param buttonMode  Poll the pin, or timestamp edges from a GPIO interrupt
    */
   Controller(const BoardPins& pins,
              gpio_pin_t buttonPin,
              Pull       pull      = Pull::Up,
              ActivePolarity polarity = ActivePolarity::ActiveLow,
-             uint16_t   debounceMs = 30) noexcept;
+             uint16_t   debounceMs = 30,
+             ButtonMode buttonMode = ButtonMode::Polling) noexcept;
 
   /** Initialize hardware (I2C bus + button). Safe to call once at boot. */
   void begin();
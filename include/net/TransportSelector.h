@@ -0,0 +1,209 @@
+#pragma once
+/**
+ * @file TransportSelector.h
+ * @brief INetClient that routes through the best available link (e.g. W5500
+ *        Ethernet first, WiFi as fallback), with per-transport latency stats.
+ *
+ * - No Arduino deps, no heap. Transports are added in priority order, each
+ *   with a link-up predicate; connect() uses the first one whose link is up.
+ * - poll() drops the active connection when its link goes away, or when a
+ *   preferred transport has been up for `holdMs`, so the owner's reconnect
+ *   logic moves the session over. Links that flap do not migrate.
+ * - recordLatency() attributes a sample (e.g. publish -> PUBACK) to the active
+ *   transport; writeJson() reports them per transport in the Profiler format.
+ *
+ * Not thread-safe: all calls belong to one task (the network task).
+ *
+ * Usage:
+ *   net::TransportSelector<2> links;
+ *   links.add("eth",  ethNet,  &ethUp);
+ *   links.add("wifi", wifiNet, &wifiUp);
+ *   mqtt::NativeClient<> mqtt(links, &nowMs);
+ *   if (links.poll(millis())) reconnectSoon();
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include "net/INetClient.h"
+#include "util/ByteSink.h"
+#include "util/JsonWriter.h"
+
+namespace net {
+
+template <std::size_t N = 2>
+class TransportSelector : public INetClient {
+public:
+  using LinkUpFn = bool (*)(void* ctx);
+
+  static constexpr int         kNone    = -1;
+  /** log2 ms buckets: [0,1) [1,2) [2,4) ... [512,1024) [1024,inf). */
+  static constexpr std::size_t kBuckets = 12;
+
+  struct Latency {
+    uint32_t count = 0;
+    uint32_t minMs = 0xFFFFFFFFu;
+    uint32_t maxMs = 0;
+    uint64_t sumMs = 0;
+    uint16_t hist[kBuckets] = {};
+  };
+
+  explicit TransportSelector(uint32_t holdMs = 2000) : holdMs_(holdMs) {}
+
+  /** Register a transport; earlier = preferred. Returns its index. */
+  int add(const char* name, INetClient& client, LinkUpFn up, void* ctx = nullptr) {
+    if (count_ >= N || !up) return kNone;
+    Link& l = links_[count_];
+    l.name   = name;
+    l.client = &client;
+    l.up     = up;
+    l.ctx    = ctx;
+    return static_cast<int>(count_++);
+  }
+
+  /**
+   * Watch the links. Returns true if it dropped the active connection
+   * (link lost, or a preferred transport is back); the caller reconnects.
+   */
+  bool poll(uint32_t nowMs) {
+    for (std::size_t i = 0; i < count_; ++i) {
+      Link& l = links_[i];
+      const bool up = l.up(l.ctx);
+      if (up && !l.wasUp) l.upSinceMs = nowMs;
+      l.wasUp = up;
+    }
+    if (active_ == kNone) return false;
+
+    if (!links_[active_].wasUp) {
+      dropActive_();
+      return true;
+    }
+    for (int i = 0; i < active_; ++i) {
+      if (links_[i].wasUp && nowMs - links_[i].upSinceMs >= holdMs_) {
+        dropActive_();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  int active() const { return active_; }
+  const char* activeName() const { return active_ == kNone ? "none" : links_[active_].name; }
+  const char* name(int i) const { return valid_(i) ? links_[i].name : ""; }
+  bool linkUp(int i) const { return valid_(i) && links_[i].wasUp; }
+  const Latency& latency(int i) const { return links_[valid_(i) ? i : 0].lat; }
+
+  /** Attribute one latency sample to the active transport. */
+  void recordLatency(uint32_t ms) {
+    if (active_ == kNone) return;
+    Latency& s = links_[active_].lat;
+    ++s.count;
+    if (ms < s.minMs) s.minMs = ms;
+    if (ms > s.maxMs) s.maxMs = ms;
+    s.sumMs += ms;
+    std::size_t b = 0;
+    for (uint32_t v = ms; v && b < kBuckets - 1; v >>= 1) ++b;
+    if (s.hist[b] != 0xFFFF) ++s.hist[b];
+  }
+
+  /** Start a new reporting window. */
+  void resetLatency() {
+    for (std::size_t i = 0; i < count_; ++i) links_[i].lat = Latency{};
+  }
+
+  /**
+   * {"active":"eth","eth":{"up":1,"conn":2,"n":14,"min":1,"avg":2,"max":9,"h":[...]},"wifi":{...}}
+   * Times in ms; "h" counts per log2 ms bucket. Deterministic (streamed publish).
+   */
+  bool writeJson(util::ByteSink& out) const {
+    util::JsonWriter w(out);
+    w.beginObject().key(JSON_KEY("active")).string(activeName());
+    for (std::size_t i = 0; i < count_ && !w.failed(); ++i) {
+      const Link& l = links_[i];
+      const Latency& s = l.lat;
+      w.key(l.name).beginObject()
+         .key(JSON_KEY("up")).flag(l.wasUp)
+         .key(JSON_KEY("conn")).u32(l.connects)
+         .key(JSON_KEY("n")).u32(s.count)
+         .key(JSON_KEY("min")).u32(s.count ? s.minMs : 0)
+         .key(JSON_KEY("avg")).u32(s.count ? static_cast<uint32_t>(s.sumMs / s.count) : 0)
+         .key(JSON_KEY("max")).u32(s.maxMs)
+         .key(JSON_KEY("h")).beginArray();
+      std::size_t last = kBuckets;
+      while (last > 0 && s.hist[last - 1] == 0) --last;
+      for (std::size_t b = 0; b < last; ++b) w.u32(s.hist[b]);
+      w.endArray().endObject();
+    }
+    w.endObject();
+    return w.ok();
+  }
+
+  // ----------------------------------------------------------------------
+  // INetClient: forwarded to the active transport
+  // ----------------------------------------------------------------------
+  bool connect(const char* host, uint16_t port) override {
+    if (active_ != kNone) dropActive_();
+    for (std::size_t i = 0; i < count_; ++i) {
+      Link& l = links_[i];
+      if (!l.up(l.ctx)) continue;
+      l.client->setTimeout(timeoutMs_);
+      if (l.client->connect(host, port)) {
+        active_ = static_cast<int>(i);
+        ++l.connects;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool connected() const override {
+    return active_ != kNone && links_[active_].client->connected();
+  }
+
+  void stop() override {
+    if (active_ != kNone) dropActive_();
+  }
+
+  size_t write(const uint8_t* buf, size_t len) override {
+    return active_ == kNone ? 0 : links_[active_].client->write(buf, len);
+  }
+
+  int read(uint8_t* buf, size_t len) override {
+    return active_ == kNone ? -1 : links_[active_].client->read(buf, len);
+  }
+
+  int available() const override {
+    return active_ == kNone ? 0 : links_[active_].client->available();
+  }
+
+  void setTimeout(unsigned long ms) override {
+    timeoutMs_ = ms;
+    if (active_ != kNone) links_[active_].client->setTimeout(ms);
+  }
+
+private:
+  struct Link {
+    const char* name      = "";
+    INetClient* client    = nullptr;
+    LinkUpFn    up        = nullptr;
+    void*       ctx       = nullptr;
+    bool        wasUp     = false;
+    uint32_t    upSinceMs = 0;
+    uint32_t    connects  = 0;
+    Latency     lat;
+  };
+
+  bool valid_(int i) const { return i >= 0 && static_cast<std::size_t>(i) < count_; }
+
+  void dropActive_() {
+    links_[active_].client->stop();
+    active_ = kNone;
+  }
+
+  Link          links_[N];
+  std::size_t   count_     = 0;
+  int           active_    = kNone;
+  uint32_t      holdMs_;
+  unsigned long timeoutMs_ = 3000;
+};
+
+} // namespace net
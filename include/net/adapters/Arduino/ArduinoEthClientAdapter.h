@@ -15,7 +15,11 @@ public:
   size_t write(const uint8_t* buf, size_t len) override { return c_.write(buf, len); }
   int read(uint8_t* buf, size_t len) override { return c_.read(buf, len); }
   int available() const override { return c_.available(); }
-  void setTimeout(unsigned long ms) override { c_.setTimeout(ms); }
+  // Stream timeout for reads, connection timeout for the TCP handshake
+  void setTimeout(unsigned long ms) override {
+    c_.setTimeout(ms);
+    c_.setConnectionTimeout(static_cast<uint16_t>(ms > 0xFFFF ? 0xFFFF : ms));
+  }
 
 private:
   EthernetClient& c_;
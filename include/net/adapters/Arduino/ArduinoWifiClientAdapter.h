@@ -6,13 +6,19 @@ namespace net {
 class ArduinoWiFiClientAdapter : public INetClient {
 public:
   explicit ArduinoWiFiClientAdapter(WiFiClient& c) : c_(c) {}
-  bool connect(const char* host, uint16_t port) override { return c_.connect(host, port); }
+  // WiFiClient::setTimeout() takes seconds on core 2.x; the connect bound goes explicitly
+  bool connect(const char* host, uint16_t port) override { return c_.connect(host, port, static_cast<int32_t>(timeoutMs_)); }
   bool connected() const override { return c_.connected(); }
   void stop() override { c_.stop(); }
   size_t write(const uint8_t* b, size_t n) override { return c_.write(b, n); }
   int read(uint8_t* b, size_t n) override { return c_.read(b, n); }
   int available() const override { return c_.available(); }
-  void setTimeout(unsigned long ms) override { c_.setTimeout(ms); }
-private: WiFiClient& c_;
+  void setTimeout(unsigned long ms) override {
+    timeoutMs_ = ms;
+    c_.setTimeout(static_cast<uint32_t>((ms + 999) / 1000));
+  }
+private:
+  WiFiClient&   c_;
+  unsigned long timeoutMs_ = 3000;
 };
 } // namespace net
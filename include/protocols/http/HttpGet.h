@@ -0,0 +1,268 @@
+#pragma once
+/**
+ * @file HttpGet.h
+ * @brief Minimal HTTP/1.1 GET over net::INetClient, for firmware downloads.
+ *
+ * - No Arduino deps, no heap: URL parts and the header line buffer live in
+ *   the object.
+ * - Non-blocking: poll() does one bounded step (connect, send, or read what
+ *   is available) and returns. The TCP handshake is the one blocking call,
+ *   bounded by connectTimeoutMs rather than the stall limit, so a download can run as a scheduler job
+ *   beside MQTT on the same task and socket stack.
+ * - Plain http:// only; 200 responses with Content-Length or read-to-close
+ *   bodies. Redirects and chunked transfer encoding are reported as errors.
+ *
+ * Usage:
+ *   http::Get get(&nowMs);
+ *   if (!get.begin(sock, "http://10.1.10.115:8000/firmware.bin.gz")) ...
+ *   for (;;) {
+ *     uint8_t buf[1024];
+ *     const int n = get.poll(buf, sizeof(buf));    // body bytes, 0 = none yet
+ *     if (n > 0) consume(buf, n);
+ *     if (get.done() || get.failed()) break;
+ *   }
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "net/INetClient.h"
+
+namespace http {
+
+struct Url {
+  char     host[64] = {};
+  uint16_t port     = 80;
+  char     path[128] = {};
+};
+
+/** "http://host[:port][/path]" -> parts. False for other schemes or over-long parts. */
+inline bool parseUrl(const char* url, Url& out) {
+  static constexpr char kScheme[] = "http://";
+  if (!url || std::strncmp(url, kScheme, sizeof(kScheme) - 1) != 0) return false;
+  const char* p = url + sizeof(kScheme) - 1;
+
+  const char* hostEnd = p;
+  while (*hostEnd && *hostEnd != ':' && *hostEnd != '/') ++hostEnd;
+  const std::size_t hostLen = static_cast<std::size_t>(hostEnd - p);
+  if (hostLen == 0 || hostLen >= sizeof(out.host)) return false;
+  std::memcpy(out.host, p, hostLen);
+  out.host[hostLen] = '\0';
+
+  p = hostEnd;
+  out.port = 80;
+  if (*p == ':') {
+    uint32_t port = 0;
+    for (++p; *p >= '0' && *p <= '9'; ++p) port = port * 10 + static_cast<uint32_t>(*p - '0');
+    if (port == 0 || port > 65535) return false;
+    out.port = static_cast<uint16_t>(port);
+  }
+  if (*p && *p != '/') return false;
+
+  const char* path = *p ? p : "/";
+  if (std::strlen(path) >= sizeof(out.path)) return false;
+  std::strcpy(out.path, path);
+  return true;
+}
+
+class Get {
+public:
+  using ClockMs = uint32_t (*)();
+
+  enum class Phase : uint8_t { Idle, Connect, Head, Body, Done, Failed };
+
+  explicit Get(ClockMs clock) : clock_(clock) {}
+
+  /**
+   * Start a download over `net`; the connection opens on the first poll().
+   * `timeoutMs` is the stall limit between received bytes; `connectTimeoutMs`
+   * bounds the blocking TCP handshake (and the request write).
+   */
+  bool begin(net::INetClient& net, const char* url, uint32_t timeoutMs = 10000,
+             uint32_t connectTimeoutMs = 1000) {
+    reset_();
+    net_ = &net;
+    if (!parseUrl(url, url_)) return fail_("bad url");
+    timeoutMs_ = timeoutMs;
+    connectTimeoutMs_ = connectTimeoutMs;
+    lastProgressMs_ = clock_();
+    phase_ = Phase::Connect;
+    return true;
+  }
+
+  /**
+   * One step. Returns body bytes copied to `out` (0 when none were ready);
+   * check done()/failed() afterwards.
+   */
+  int poll(uint8_t* out, std::size_t cap) {
+    switch (phase_) {
+      case Phase::Connect: connect_(); return 0;
+      case Phase::Head:    head_();    return 0;
+      case Phase::Body:    return body_(out, cap);
+      default:             return 0;
+    }
+  }
+
+  /** Stop and close the connection (also after done()/failed()). */
+  void end() {
+    if (net_) net_->stop();
+    if (phase_ != Phase::Done && phase_ != Phase::Failed) phase_ = Phase::Idle;
+  }
+
+  Phase       phase() const { return phase_; }
+  bool        done() const { return phase_ == Phase::Done; }
+  bool        failed() const { return phase_ == Phase::Failed; }
+  const char* error() const { return error_; }
+  int         status() const { return status_; }
+  /** Body size from Content-Length, or -1 if the server did not send one. */
+  int32_t     contentLength() const { return contentLength_; }
+  uint32_t    received() const { return received_; }
+
+private:
+  static constexpr std::size_t kLineCap = 128;
+
+  void reset_() {
+    if (net_) net_->stop();
+    phase_ = Phase::Idle;
+    error_ = "";
+    status_ = 0;
+    contentLength_ = -1;
+    received_ = 0;
+    lineLen_ = 0;
+    chunked_ = false;
+  }
+
+  bool fail_(const char* why) {
+    if (net_) net_->stop();
+    error_ = why;
+    phase_ = Phase::Failed;
+    return false;
+  }
+
+  bool timedOut_() { return clock_() - lastProgressMs_ >= timeoutMs_; }
+
+  void connect_() {
+    // connect() blocks up to the net client's own timeout
+    net_->setTimeout(connectTimeoutMs_);
+    if (!net_->connect(url_.host, url_.port)) { fail_("connect failed"); return; }
+
+    char req[256];
+    const int n = std::snprintf(req, sizeof(req),
+                                "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n"
+                                "Accept-Encoding: identity\r\n\r\n", url_.path, url_.host);
+    if (n <= 0 || static_cast<std::size_t>(n) >= sizeof(req) ||
+        net_->write(reinterpret_cast<const uint8_t*>(req), static_cast<std::size_t>(n)) != static_cast<std::size_t>(n)) {
+      fail_("request not sent");
+      return;
+    }
+    lastProgressMs_ = clock_();
+    phase_ = Phase::Head;
+  }
+
+  // Header lines one byte at a time; they are short and read once
+  void head_() {
+    uint8_t c;
+    while (net_->available() > 0 && net_->read(&c, 1) == 1) {
+      lastProgressMs_ = clock_();
+      if (c == '\n') {
+        while (lineLen_ && line_[lineLen_ - 1] == '\r') --lineLen_;
+        line_[lineLen_] = '\0';
+        const bool blank = lineLen_ == 0;
+        lineLen_ = 0;
+        if (blank) { startBody_(); return; }
+        if (!headerLine_()) return;
+      } else if (lineLen_ < kLineCap - 1) {
+        line_[lineLen_++] = static_cast<char>(c);
+      }                                  // longer lines: the tail is ignored
+    }
+    if (!net_->connected() && net_->available() <= 0) fail_("closed in headers");
+    else if (timedOut_()) fail_("header timeout");
+  }
+
+  bool headerLine_() {
+    if (status_ == 0) {
+      // "HTTP/1.1 200 OK"
+      const char* sp = std::strchr(line_, ' ');
+      if (std::strncmp(line_, "HTTP/1.", 7) != 0 || !sp) return fail_("not http");
+      status_ = std::atoi(sp + 1);
+      return true;
+    }
+    const char* colon = std::strchr(line_, ':');
+    if (!colon) return true;
+    const std::size_t nameLen = static_cast<std::size_t>(colon - line_);
+    const char* value = colon + 1;
+    while (*value == ' ' || *value == '\t') ++value;
+    if (nameIs_(nameLen, "content-length")) contentLength_ = std::atol(value);
+    else if (nameIs_(nameLen, "transfer-encoding") && std::strstr(value, "chunked")) chunked_ = true;
+    return true;
+  }
+
+  bool nameIs_(std::size_t len, const char* name) const {
+    if (std::strlen(name) != len) return false;
+    for (std::size_t i = 0; i < len; ++i) {
+      char c = line_[i];
+      if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+      if (c != name[i]) return false;
+    }
+    return true;
+  }
+
+  void startBody_() {
+    if (status_ != 200) {
+      std::snprintf(statusText_, sizeof(statusText_), "http status %d", status_);
+      fail_(statusText_);
+      return;
+    }
+    if (chunked_) { fail_("chunked encoding"); return; }
+    phase_ = (contentLength_ == 0) ? Phase::Done : Phase::Body;
+  }
+
+  int body_(uint8_t* out, std::size_t cap) {
+    std::size_t want = cap;
+    if (contentLength_ >= 0) {
+      const uint32_t left = static_cast<uint32_t>(contentLength_) - received_;
+      if (left < want) want = left;
+    }
+    const int avail = net_->available();
+    if (avail > 0 && want > 0) {
+      if (static_cast<std::size_t>(avail) < want) want = static_cast<std::size_t>(avail);
+      const int n = net_->read(out, want);
+      if (n < 0) { fail_("read error"); return 0; }
+      received_ += static_cast<uint32_t>(n);
+      lastProgressMs_ = clock_();
+      if (contentLength_ >= 0 && received_ >= static_cast<uint32_t>(contentLength_)) {
+        net_->stop();
+        phase_ = Phase::Done;
+      }
+      return n;
+    }
+    if (!net_->connected()) {
+      // Read-to-close body ends here; a short Content-Length body is an error
+      if (contentLength_ < 0) { phase_ = Phase::Done; net_->stop(); }
+      else fail_("connection closed early");
+    } else if (timedOut_()) {
+      fail_("body timeout");
+    }
+    return 0;
+  }
+
+  net::INetClient* net_ = nullptr;
+  ClockMs          clock_;
+  Url              url_{};
+  Phase            phase_ = Phase::Idle;
+  const char*      error_ = "";
+  char             statusText_[24] = {};
+  int              status_ = 0;
+  int32_t          contentLength_ = -1;
+  uint32_t         received_ = 0;
+  uint32_t         timeoutMs_ = 10000;
+  uint32_t         connectTimeoutMs_ = 1000;
+  uint32_t         lastProgressMs_ = 0;
+  char             line_[kLineCap] = {};
+  std::size_t      lineLen_ = 0;
+  bool             chunked_ = false;
+};
+
+} // namespace http
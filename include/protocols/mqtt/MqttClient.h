@@ -10,7 +10,7 @@
 
 #include <cstdint>
 #include <cstddef>
-#include <functional>
+#include "util/FunctionRef.h"
 
 namespace mqtt {
 
@@ -26,9 +26,13 @@ struct Config {
   bool        cleanSession = true;
 };
 
-using MessageHandler = std::function<void(const char* topic,
-                                          const uint8_t* payload,
-                                          size_t len)>;
+/**
+ * Inbound message callback. Non-owning (no heap): bind a free function or a
+ * captureless lambda, or an object that outlives the client.
+ */
+using MessageHandler = util::FunctionRef<void(const char* topic,
+                                              const uint8_t* payload,
+                                              size_t len)>;
 
 class IMqttClient {
 public:
@@ -55,9 +59,37 @@ public:
                        bool retain = false,
                        int qos = 0) = 0;
 
+  /** Publish a binary-safe payload of known length (no strlen, may contain NUL). */
+  virtual bool publish(const char* topic,
+                       const uint8_t* payload,
+                       size_t len,
+                       bool retain = false,
+                       int qos = 0) = 0;
+
+  /**
+   * Streaming publish: announce the exact payload length, write() it in
+   * pieces straight into the outgoing packet, then endPublish().
+   * The write() lengths must add up to `len`; no other publish may
+   * interleave between begin and end.
+   */
+  virtual bool   beginPublish(const char* topic, size_t len,
+                              bool retain = false, int qos = 0) = 0;
+  virtual size_t write(const uint8_t* data, size_t len) = 0;
+  virtual bool   endPublish() = 0;
+
   /** Subscribe to a topic filter (e.g., "room/+/cmd"). QoS 0/1 allowed. */
   virtual bool subscribe(const char* topicFilter, int qos = 0) = 0;
 
+  /**
+   * Subscribe to `count` filters (qos[i] each, or 0 if qos is null).
+   * Clients that can send them in one SUBSCRIBE packet override this.
+   */
+  virtual bool subscribeBatch(const char* const* filters, const uint8_t* qos, size_t count) {
+    bool ok = true;
+    for (size_t i = 0; i < count; ++i) ok &= subscribe(filters[i], qos ? qos[i] : 0);
+    return ok;
+  }
+
   /** Set inbound message callback. */
   virtual void onMessage(MessageHandler handler) = 0;
 };
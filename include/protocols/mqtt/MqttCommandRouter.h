@@ -0,0 +1,150 @@
+#pragma once
+/**
+ * @file MqttCommandRouter.h
+ * @brief Inbound command dispatch by topic filter, plus the subscription
+ *        table that feeds it, re-sent as one batch after every connect.
+ *
+ * - No Arduino deps, no heap. Filters are compiled once (mqttt::TopicFilter),
+ *   so dispatch is a level-by-level walk per route, never a string build.
+ * - Routes and subscriptions are separate tables: one handler can serve
+ *   unicast and broadcast topics ("room/+/reset" routes both "room/Dev2/reset"
+ *   and "room/All/reset"), while the broker only forwards what was subscribed.
+ * - dispatch() copies the payload into a NUL-terminated buffer (commands are
+ *   short text) and runs the first matching route, in registration order.
+ *
+ * Not thread-safe: all calls belong to one task (the network task).
+ *
+ * Usage:
+ *   mqtt::CommandRouter<> cmds;
+ *   cmds.subscribe({"room", "Dev2", "reset"});
+ *   cmds.subscribe({"room", "All", "+"});
+ *   cmds.on({"room", "+", "reset"}, &onReset);
+ *   client.onMessage([](const char* t, const uint8_t* p, size_t n) { cmds.dispatch(t, p, n); });
+ *   if (justConnected) cmds.resubscribe(client);
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include "protocols/mqtt/MqttClient.h"
+#include "protocols/mqtt/MqttTopicFilter.h"
+
+namespace mqtt {
+
+/** One inbound command, valid for the duration of the handler call. */
+struct Command {
+  const char* topic;
+  const char* text;   // payload, NUL-terminated (truncated to the router's TextCap - 1)
+  size_t      len;
+};
+
+using CommandHandler = void (*)(const Command& cmd, void* ctx);
+
+template <std::size_t MaxRoutes  = 8,
+          std::size_t MaxFilters = 8,
+          std::size_t TextCap    = 128,   // longest command payload + 1
+          std::size_t FilterCap  = 64>
+class CommandRouter {
+public:
+  using Filter = mqttt::TopicFilter<FilterCap>;
+
+  struct Stats {
+    uint32_t dispatched = 0;
+    uint32_t unmatched  = 0;   // delivered but no route (e.g. our own retained status)
+    uint32_t truncated  = 0;   // payload longer than TextCap - 1
+  };
+
+  /** Add a filter to the subscription table. Duplicates are merged (highest qos). */
+  bool subscribe(const char* filter, int qos = 0) {
+    const uint8_t q = static_cast<uint8_t>(qos > 0 ? 1 : 0);
+    for (std::size_t i = 0; i < subCount_; ++i) {
+      if (std::strcmp(subs_[i].filter.str(), filter ? filter : "") == 0) {
+        if (q > subs_[i].qos) subs_[i].qos = q;
+        return true;
+      }
+    }
+    if (subCount_ >= MaxFilters || !subs_[subCount_].filter.compile(filter)) return false;
+    subs_[subCount_++].qos = q;
+    return true;
+  }
+
+  bool subscribe(std::initializer_list<const char*> segments, int qos = 0) {
+    char buf[FilterCap];
+    return mqttt::join(buf, sizeof(buf), segments) && subscribe(buf, qos);
+  }
+
+  /** Route topics matching `filter` to `handler`. Earlier routes win. */
+  bool on(const char* filter, CommandHandler handler, void* ctx = nullptr) {
+    if (!handler || routeCount_ >= MaxRoutes) return false;
+    Route& r = routes_[routeCount_];
+    if (!r.filter.compile(filter)) return false;
+    r.handler = handler;
+    r.ctx = ctx;
+    ++routeCount_;
+    return true;
+  }
+
+  bool on(std::initializer_list<const char*> segments, CommandHandler handler, void* ctx = nullptr) {
+    char buf[FilterCap];
+    return mqttt::join(buf, sizeof(buf), segments) && on(buf, handler, ctx);
+  }
+
+  /** Run the first route matching `topic`. False if none did. */
+  bool dispatch(const char* topic, const uint8_t* payload, size_t len) {
+    for (std::size_t i = 0; i < routeCount_; ++i) {
+      const Route& r = routes_[i];
+      if (!r.filter.matches(topic)) continue;
+
+      const size_t n = len < TextCap - 1 ? len : TextCap - 1;
+      if (n < len) ++stats_.truncated;
+      if (n) std::memcpy(text_, payload, n);
+      text_[n] = '\0';
+
+      ++stats_.dispatched;
+      r.handler(Command{topic, text_, n}, r.ctx);
+      return true;
+    }
+    ++stats_.unmatched;
+    return false;
+  }
+
+  /** Send the whole subscription table (one SUBSCRIBE where the client supports it). */
+  bool resubscribe(IMqttClient& client) const {
+    if (subCount_ == 0) return true;
+    const char* filters[MaxFilters];
+    uint8_t qos[MaxFilters];
+    for (std::size_t i = 0; i < subCount_; ++i) {
+      filters[i] = subs_[i].filter.str();
+      qos[i] = subs_[i].qos;
+    }
+    return client.subscribeBatch(filters, qos, subCount_);
+  }
+
+  std::size_t subscriptions() const { return subCount_; }
+  const char* subscription(std::size_t i) const { return i < subCount_ ? subs_[i].filter.str() : ""; }
+  std::size_t routes() const { return routeCount_; }
+  const Stats& stats() const { return stats_; }
+
+private:
+  static_assert(TextCap > 1, "CommandRouter needs room for a payload");
+
+  struct Route {
+    Filter         filter;
+    CommandHandler handler = nullptr;
+    void*          ctx     = nullptr;
+  };
+  struct Sub {
+    Filter  filter;
+    uint8_t qos = 0;
+  };
+
+  Route       routes_[MaxRoutes];
+  Sub         subs_[MaxFilters];
+  std::size_t routeCount_ = 0;
+  std::size_t subCount_   = 0;
+  char        text_[TextCap] = {};
+  Stats       stats_;
+};
+
+} // namespace mqtt
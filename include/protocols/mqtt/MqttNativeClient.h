@@ -0,0 +1,585 @@
+#pragma once
+/**
+ * @file MqttNativeClient.h
+ * @brief In-tree MQTT 3.1.1 client over net::INetClient (no PubSubClient).
+ *
+ * - No Arduino deps, no heap: TX/RX buffers and the QoS1 in-flight store are
+ *   fixed arrays in the object. Runs unchanged on PosixSocketClient (host)
+ *   and the Arduino WiFi/Ethernet adapters.
+ * - connect() opens TCP and sends CONNECT, then returns; CONNACK, keepalive
+ *   and timeouts are handled by loop(). The TCP handshake is the one
+ *   blocking step (INetClient has no non-blocking connect): it is bounded by
+ *   setTcpTimeoutMs() per transport tried, which the caller keeps well under
+ *   its task watchdog. The CONNACK wait never blocks. SUBSCRIBE/PUBLISH may
+ *   be issued right behind CONNECT (allowed by 3.1.1), connected() turns
+ *   true once the broker accepts the session.
+ * - QoS1: up to Inflight publishes await PUBACK at once (pipelined). Each is
+ *   kept until acknowledged and resent with DUP after a reconnect, so an
+ *   event survives a dropped session (at-least-once). QoS2 is sent as QoS1.
+ *   A publish too large for an in-flight slot (topic + payload > InflightCap)
+ *   goes out as QoS0 and is counted: refusing it would only be retried.
+ * - Streamed publishes (beginPublish/write/endPublish) are QoS0 and spill
+ *   through the TX buffer, so payloads may exceed TxCap.
+ * - Inbound packets larger than RxCap are skipped and counted.
+ *
+ * Not thread-safe: all calls belong to one task (the network task).
+ *
+ * Usage:
+ *   PosixSocketClient sock;
+ *   mqtt::NativeClient<> mqtt(sock, &nowMs);
+ *   mqtt.begin(cfg);
+ *   mqtt.connect();                                  // returns after CONNECT is sent
+ *   for (;;) { mqtt.loop(); mqtt.publish("a/Fired", "triggered", false, 1); }
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "net/INetClient.h"
+#include "protocols/mqtt/MqttClient.h"
+#include "util/Profiler.h"
+
+namespace mqtt {
+
+template <std::size_t TxCap       = 1024,  // outgoing packet bytes buffered before a socket write
+          std::size_t RxCap       = 512,   // largest inbound packet handled
+          std::size_t Inflight    = 8,     // QoS1 publishes awaiting PUBACK
+          std::size_t InflightCap = 96>    // topic + payload bytes per in-flight publish
+class NativeClient : public IMqttClient {
+public:
+  using ClockMs = uint32_t (*)();
+  /** Called for every PUBACK with the time since the publish was (re)sent. */
+  using AckHook = void (*)(void* ctx, uint32_t rttMs);
+
+  enum class State : uint8_t { Disconnected, AwaitConnack, Connected };
+
+  struct Stats {
+    uint32_t connects      = 0;   // TCP sessions opened
+    uint32_t refused       = 0;   // CONNACK with a non-zero return code
+    uint32_t timeouts      = 0;   // CONNACK or PINGRESP not seen in time
+    uint32_t pubacks       = 0;
+    uint32_t resent        = 0;   // QoS1 publishes repeated after a reconnect
+    uint32_t inflightFull  = 0;   // QoS1 publish refused: no free slot
+    uint32_t qos1Oversize  = 0;   // QoS1 publish sent as QoS0: > InflightCap
+    uint32_t rxOversize    = 0;   // inbound packets skipped (> RxCap)
+    uint32_t subackFailed  = 0;
+  };
+
+  NativeClient(net::INetClient& net, ClockMs clock) : net_(net), clock_(clock) {}
+
+  /** How long loop() waits for CONNACK before dropping the session. */
+  void setConnectTimeoutMs(uint32_t ms) { connectTimeoutMs_ = ms; }
+  /** Blocking bound on the TCP handshake in connect() (net client timeout). */
+  void setTcpTimeoutMs(uint32_t ms) { tcpTimeoutMs_ = ms; }
+
+  void setAckHook(AckHook hook, void* ctx = nullptr) { ackHook_ = hook; ackCtx_ = ctx; }
+
+  State state() const { return state_; }
+  std::size_t inflight() const {
+    std::size_t n = 0;
+    for (const Slot& s : slots_) n += s.used;
+    return n;
+  }
+  const Stats& stats() const { return stats_; }
+  /** Return code of the last refused CONNACK (0 = none). */
+  uint8_t lastRefusal() const { return lastRefusal_; }
+
+  // ----------------------------------------------------------------------
+  // IMqttClient
+  // ----------------------------------------------------------------------
+  bool begin(const Config& cfg) override {
+    cfg_ = cfg;
+    return cfg_.brokerHost && cfg_.clientId;
+  }
+
+  bool connect() override {
+    if (state_ != State::Disconnected) {
+      if (net_.connected()) return true;
+      drop_();                                   // socket went away since the last loop()
+    }
+    if (!cfg_.brokerHost || !cfg_.clientId) return false;
+
+    net_.setTimeout(tcpTimeoutMs_);
+    if (!net_.connect(cfg_.brokerHost, cfg_.brokerPort)) return false;
+    ++stats_.connects;
+
+    txLen_ = rxLen_ = skip_ = 0;
+    streamLeft_ = 0;
+    pingOutstanding_ = false;
+    const uint32_t now = clock_();
+    stateSinceMs_ = lastTxMs_ = now;
+
+    state_ = State::AwaitConnack;
+    if (!sendConnect_() || !resendInflight_() || !flush_()) {
+      drop_();
+      return false;
+    }
+    return true;
+  }
+
+  void loop() override {
+    PROF_SCOPE("mqtt.loop");
+    if (state_ == State::Disconnected) return;
+    if (!net_.connected()) { drop_(); return; }
+
+    flush_();
+    receive_();
+    if (state_ == State::Disconnected) return;
+
+    const uint32_t now = clock_();
+    if (state_ == State::AwaitConnack && now - stateSinceMs_ > connectTimeoutMs_) {
+      ++stats_.timeouts;
+      drop_();
+      return;
+    }
+
+    const uint32_t keepAliveMs = static_cast<uint32_t>(cfg_.keepAliveS) * 1000U;
+    if (keepAliveMs && state_ == State::Connected) {
+      if (pingOutstanding_ && now - pingSentMs_ > keepAliveMs) {
+        ++stats_.timeouts;
+        drop_();
+        return;
+      }
+      if (!pingOutstanding_ && now - lastTxMs_ >= keepAliveMs) {
+        const uint8_t ping[] = {0xC0, 0x00};
+        if (!put_(ping, sizeof(ping))) { drop_(); return; }
+        pingOutstanding_ = true;
+        pingSentMs_ = now;
+      }
+    }
+    flush_();
+  }
+
+  bool connected() const override { return state_ == State::Connected && net_.connected(); }
+
+  void disconnect() override {
+    if (state_ == State::Disconnected) return;
+    const uint8_t bye[] = {0xE0, 0x00};
+    put_(bye, sizeof(bye));
+    flush_();
+    drop_();
+  }
+
+  bool publish(const char* topic, const char* payload,
+               bool retain = false, int qos = 0) override {
+    return publish(topic, reinterpret_cast<const uint8_t*>(payload ? payload : ""),
+                   payload ? std::strlen(payload) : 0, retain, qos);
+  }
+
+  bool publish(const char* topic, const uint8_t* payload, std::size_t len,
+               bool retain = false, int qos = 0) override {
+    PROF_SCOPE("mqtt.publish");
+    if (state_ == State::Disconnected || !topic || streamLeft_) return false;
+    const std::size_t topicLen = std::strlen(topic);
+    if (topicLen > 0xFFFF) return false;
+    // No slot can hold it: a false here would be retried forever by a queue
+    if (qos > 0 && topicLen + len > InflightCap) {
+      ++stats_.qos1Oversize;
+      qos = 0;
+    }
+
+    if (qos <= 0) {
+      if (!putPublishHeader_(topic, topicLen, len, retain, 0, 0, false) ||
+          !put_(payload, len)) {
+        drop_();
+        return false;
+      }
+      // Committed to tx_: a socket that takes nothing now gets it on the next
+      // flush, so false here would only make the caller send it twice
+      flush_();
+      return true;
+    }
+
+    // QoS1: keep a copy until PUBACK
+    Slot* s = freeSlot_();
+    if (!s) { ++stats_.inflightFull; return false; }
+    s->used       = true;
+    s->id         = nextId_();
+    s->seq        = nextSeq_++;
+    s->topicLen   = static_cast<uint16_t>(topicLen);
+    s->payloadLen = static_cast<uint16_t>(len);
+    s->retain     = retain;
+    std::memcpy(s->data, topic, topicLen);
+    if (len) std::memcpy(s->data + topicLen, payload, len);
+    s->sentMs     = clock_();
+
+    if (!sendSlot_(*s, false)) { drop_(); return true; }   // kept: resent on reconnect
+    flush_();
+    return true;
+  }
+
+  bool beginPublish(const char* topic, std::size_t len,
+                    bool retain = false, int /*qos*/ = 0) override {
+    if (state_ == State::Disconnected || !topic || streamLeft_) return false;
+    const std::size_t topicLen = std::strlen(topic);
+    if (topicLen > 0xFFFF) return false;
+    if (!putPublishHeader_(topic, topicLen, len, retain, 0, 0, false)) { drop_(); return false; }
+    streamLeft_ = len;
+    return true;
+  }
+
+  std::size_t write(const uint8_t* data, std::size_t len) override {
+    if (state_ == State::Disconnected || len > streamLeft_) return 0;
+    if (!put_(data, len)) { drop_(); return 0; }
+    streamLeft_ -= len;
+    return len;
+  }
+
+  bool endPublish() override {
+    if (state_ == State::Disconnected) return false;
+    if (streamLeft_) { drop_(); return false; }   // short stream: the packet is corrupt
+    flush_();                                     // committed, as for publish()
+    return true;
+  }
+
+  bool subscribe(const char* topicFilter, int qos = 0) override {
+    const uint8_t q = static_cast<uint8_t>(qos > 0 ? 1 : 0);
+    return subscribeBatch(&topicFilter, &q, 1);
+  }
+
+  /** All filters in one SUBSCRIBE packet (one broker round trip, one SUBACK). */
+  bool subscribeBatch(const char* const* filters, const uint8_t* qos, std::size_t count) override {
+    if (state_ == State::Disconnected || !filters || count == 0 || streamLeft_) return false;
+    std::size_t rem = 2;
+    for (std::size_t i = 0; i < count; ++i) {
+      if (!filters[i]) return false;
+      const std::size_t n = std::strlen(filters[i]);
+      if (n > 0xFFFF) return false;
+      rem += 2 + n + 1;
+    }
+    if (rem > 268435455u) return false;   // largest 4-byte remaining length
+
+    const uint16_t id = nextId_();
+    uint8_t hdr[1 + 4 + 2];
+    std::size_t h = 0;
+    hdr[h++] = 0x82;
+    h += encodeLength_(hdr + h, rem);
+    hdr[h++] = static_cast<uint8_t>(id >> 8);
+    hdr[h++] = static_cast<uint8_t>(id);
+    bool ok = put_(hdr, h);
+    for (std::size_t i = 0; ok && i < count; ++i) {
+      const std::size_t n = std::strlen(filters[i]);
+      const uint8_t len[2] = {static_cast<uint8_t>(n >> 8), static_cast<uint8_t>(n)};
+      const uint8_t q = static_cast<uint8_t>(qos && qos[i] > 0 ? 1 : 0);
+      ok = put_(len, 2) && put_(reinterpret_cast<const uint8_t*>(filters[i]), n) && put_(&q, 1);
+    }
+    if (!ok) {
+      drop_();
+      return false;
+    }
+    flush_();
+    return true;
+  }
+
+  void onMessage(MessageHandler handler) override { handler_ = handler; }
+
+private:
+  static_assert(TxCap >= 64 && RxCap >= 16, "NativeClient buffers too small");
+  static_assert(InflightCap <= 0xFFFF, "InflightCap must fit a uint16_t");
+
+  struct Slot {
+    bool     used       = false;
+    bool     retain     = false;
+    uint16_t id         = 0;
+    uint16_t topicLen   = 0;
+    uint16_t payloadLen = 0;
+    uint32_t seq        = 0;   // publish order, for resends
+    uint32_t sentMs     = 0;
+    uint8_t  data[InflightCap];
+  };
+
+  // ---- framing ----------------------------------------------------------
+
+  static std::size_t encodeLength_(uint8_t* out, std::size_t v) {
+    std::size_t n = 0;
+    do {
+      uint8_t b = static_cast<uint8_t>(v & 0x7F);
+      v >>= 7;
+      if (v) b |= 0x80;
+      out[n++] = b;
+    } while (v && n < 4);
+    return n;
+  }
+
+  bool putPublishHeader_(const char* topic, std::size_t topicLen, std::size_t len,
+                         bool retain, uint8_t qos, uint16_t id, bool dup) {
+    uint8_t hdr[1 + 4 + 2];
+    std::size_t h = 0;
+    hdr[h++] = static_cast<uint8_t>(0x30 | (dup ? 0x08 : 0) | (qos << 1) | (retain ? 1 : 0));
+    h += encodeLength_(hdr + h, 2 + topicLen + (qos ? 2 : 0) + len);
+    hdr[h++] = static_cast<uint8_t>(topicLen >> 8);
+    hdr[h++] = static_cast<uint8_t>(topicLen);
+    if (!put_(hdr, h) || !put_(reinterpret_cast<const uint8_t*>(topic), topicLen)) return false;
+    if (qos) {
+      const uint8_t pid[] = {static_cast<uint8_t>(id >> 8), static_cast<uint8_t>(id)};
+      if (!put_(pid, sizeof(pid))) return false;
+    }
+    return true;
+  }
+
+  bool sendSlot_(const Slot& s, bool dup) {
+    return putPublishHeader_(reinterpret_cast<const char*>(s.data), s.topicLen, s.payloadLen,
+                             s.retain, 1, s.id, dup) &&
+           put_(s.data + s.topicLen, s.payloadLen);
+  }
+
+  bool sendConnect_() {
+    const std::size_t idLen = std::strlen(cfg_.clientId);
+    const std::size_t userLen = cfg_.username ? std::strlen(cfg_.username) : 0;
+    const std::size_t passLen = (cfg_.username && cfg_.password) ? std::strlen(cfg_.password) : 0;
+
+    uint8_t flags = cfg_.cleanSession ? 0x02 : 0x00;
+    if (cfg_.username) flags |= 0x80;
+    if (cfg_.username && cfg_.password) flags |= 0x40;
+
+    std::size_t rem = 10 + 2 + idLen;
+    if (cfg_.username) rem += 2 + userLen;
+    if (flags & 0x40) rem += 2 + passLen;
+
+    uint8_t hdr[1 + 4 + 10];
+    std::size_t h = 0;
+    hdr[h++] = 0x10;
+    h += encodeLength_(hdr + h, rem);
+    const uint8_t vh[] = {0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, flags,
+                          static_cast<uint8_t>(cfg_.keepAliveS >> 8),
+                          static_cast<uint8_t>(cfg_.keepAliveS)};
+    std::memcpy(hdr + h, vh, sizeof(vh));
+    h += sizeof(vh);
+
+    return put_(hdr, h) && putString_(cfg_.clientId, idLen) &&
+           (!cfg_.username || putString_(cfg_.username, userLen)) &&
+           (!(flags & 0x40) || putString_(cfg_.password, passLen));
+  }
+
+  bool putString_(const char* s, std::size_t n) {
+    const uint8_t len[] = {static_cast<uint8_t>(n >> 8), static_cast<uint8_t>(n)};
+    return put_(len, sizeof(len)) && put_(reinterpret_cast<const uint8_t*>(s), n);
+  }
+
+  // ---- TX ---------------------------------------------------------------
+
+  // Append to the TX buffer, flushing to the socket when it fills.
+  bool put_(const uint8_t* data, std::size_t n) {
+    while (n) {
+      if (txLen_ == TxCap && (!flush_() || txLen_ == TxCap)) return false;
+      const std::size_t room = TxCap - txLen_;
+      const std::size_t k = n < room ? n : room;
+      std::memcpy(tx_ + txLen_, data, k);
+      txLen_ += k;
+      data += k;
+      n -= k;
+    }
+    return true;
+  }
+
+  // Write what the socket takes; false if it refused bytes it should have taken.
+  bool flush_() {
+    if (txLen_ == 0) return true;
+    const std::size_t n = net_.write(tx_, txLen_);
+    if (n == 0) return false;
+    if (n < txLen_) std::memmove(tx_, tx_ + n, txLen_ - n);
+    txLen_ -= n;
+    lastTxMs_ = clock_();
+    return true;
+  }
+
+  // ---- RX ---------------------------------------------------------------
+
+  void receive_() {
+    for (;;) {
+      const int avail = net_.available();
+      if (avail <= 0) return;
+
+      if (skip_) {                                  // tail of an oversize packet
+        uint8_t scratch[64];
+        std::size_t want = skip_ < sizeof(scratch) ? skip_ : sizeof(scratch);
+        if (want > static_cast<std::size_t>(avail)) want = static_cast<std::size_t>(avail);
+        const int n = net_.read(scratch, want);
+        if (n < 0) { drop_(); return; }
+        if (n == 0) return;
+        skip_ -= static_cast<std::size_t>(n);
+        continue;
+      }
+
+      std::size_t want = RxCap - rxLen_;
+      if (want > static_cast<std::size_t>(avail)) want = static_cast<std::size_t>(avail);
+      const int n = net_.read(rx_ + rxLen_, want);
+      if (n < 0) { drop_(); return; }
+      if (n == 0) return;
+      rxLen_ += static_cast<std::size_t>(n);
+
+      while (state_ != State::Disconnected && parseOne_()) {}
+      if (state_ == State::Disconnected) return;
+    }
+  }
+
+  // Handle one complete packet at the front of rx_; false when more bytes are needed.
+  bool parseOne_() {
+    if (rxLen_ < 2) return false;
+    std::size_t rem = 0, i = 1;
+    for (int shift = 0;; shift += 7, ++i) {
+      if (i >= rxLen_) return false;
+      if (i > 4) { drop_(); return false; }            // malformed length
+      rem |= static_cast<std::size_t>(rx_[i] & 0x7F) << shift;
+      if (!(rx_[i] & 0x80)) break;
+    }
+    const std::size_t hdrLen = i + 1;
+    const std::size_t total = hdrLen + rem;
+
+    if (total > RxCap) {
+      ++stats_.rxOversize;
+      skip_ = total - rxLen_;
+      rxLen_ = 0;
+      return false;
+    }
+    if (rxLen_ < total) return false;
+
+    handle_(rx_[0], rx_ + hdrLen, rem);
+
+    if (state_ == State::Disconnected) return false;
+    rxLen_ -= total;
+    if (rxLen_) std::memmove(rx_, rx_ + total, rxLen_);
+    return true;
+  }
+
+  void handle_(uint8_t type, uint8_t* body, std::size_t len) {
+    switch (type & 0xF0) {
+      case 0x20:   // CONNACK
+        if (len < 2) { drop_(); return; }
+        if (body[1] != 0) {
+          ++stats_.refused;
+          lastRefusal_ = body[1];
+          drop_();
+          return;
+        }
+        state_ = State::Connected;
+        break;
+
+      case 0x30: { // PUBLISH
+        const uint8_t qos = (type >> 1) & 0x03;
+        if (len < 2) { drop_(); return; }
+        const std::size_t topicLen = (std::size_t(body[0]) << 8) | body[1];
+        std::size_t off = 2 + topicLen;
+        uint16_t id = 0;
+        if (qos) {
+          if (off + 2 > len) { drop_(); return; }
+          id = static_cast<uint16_t>((body[off] << 8) | body[off + 1]);
+          off += 2;
+        }
+        if (off > len) { drop_(); return; }
+
+        // NUL-terminate the topic in place: slide it over its length prefix
+        std::memmove(body, body + 2, topicLen);
+        body[topicLen] = '\0';
+        if (handler_) handler_(reinterpret_cast<const char*>(body), body + off, len - off);
+
+        if (qos == 1 && state_ != State::Disconnected) {
+          const uint8_t ack[] = {0x40, 0x02, static_cast<uint8_t>(id >> 8), static_cast<uint8_t>(id)};
+          if (!put_(ack, sizeof(ack))) drop_();
+        }
+        break;
+      }
+
+      case 0x40: { // PUBACK
+        if (len < 2) return;
+        const uint16_t id = static_cast<uint16_t>((body[0] << 8) | body[1]);
+        for (Slot& s : slots_) {
+          if (s.used && s.id == id) {
+            s.used = false;
+            ++stats_.pubacks;
+            if (ackHook_) ackHook_(ackCtx_, clock_() - s.sentMs);
+            break;
+          }
+        }
+        break;
+      }
+
+      case 0x90:   // SUBACK
+        for (std::size_t k = 2; k < len; ++k) {
+          if (body[k] == 0x80) ++stats_.subackFailed;
+        }
+        break;
+
+      case 0xD0:   // PINGRESP
+        pingOutstanding_ = false;
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  // ---- session ----------------------------------------------------------
+
+  void drop_() {
+    net_.stop();
+    state_ = State::Disconnected;
+    txLen_ = rxLen_ = skip_ = 0;
+    streamLeft_ = 0;
+  }
+
+  // Unacknowledged QoS1 publishes, oldest first, marked DUP
+  bool resendInflight_() {
+    uint32_t after = 0;
+    bool first = true;
+    for (;;) {
+      Slot* next = nullptr;
+      for (Slot& s : slots_) {
+        if (!s.used || (!first && static_cast<int32_t>(s.seq - after) <= 0)) continue;
+        if (!next || static_cast<int32_t>(s.seq - next->seq) < 0) next = &s;
+      }
+      if (!next) return true;
+      if (!sendSlot_(*next, true)) return false;
+      next->sentMs = clock_();
+      ++stats_.resent;
+      after = next->seq;
+      first = false;
+    }
+  }
+
+  Slot* freeSlot_() {
+    for (Slot& s : slots_) if (!s.used) return &s;
+    return nullptr;
+  }
+
+  // 1..65535, skipping ids still awaiting PUBACK
+  uint16_t nextId_() {
+    for (;;) {
+      if (++lastId_ == 0) lastId_ = 1;
+      bool busy = false;
+      for (const Slot& s : slots_) busy |= (s.used && s.id == lastId_);
+      if (!busy) return lastId_;
+    }
+  }
+
+  net::INetClient& net_;
+  ClockMs          clock_;
+  Config           cfg_{};
+  MessageHandler   handler_{};
+  AckHook          ackHook_ = nullptr;
+  void*            ackCtx_  = nullptr;
+
+  State    state_            = State::Disconnected;
+  uint32_t connectTimeoutMs_ = 5000;
+  uint32_t tcpTimeoutMs_     = 1000;
+  uint32_t stateSinceMs_     = 0;
+  uint32_t lastTxMs_         = 0;
+  uint32_t pingSentMs_       = 0;
+  bool     pingOutstanding_  = false;
+  uint8_t  lastRefusal_      = 0;
+
+  uint8_t     tx_[TxCap];
+  std::size_t txLen_      = 0;
+  std::size_t streamLeft_ = 0;
+  uint8_t     rx_[RxCap];
+  std::size_t rxLen_      = 0;
+  std::size_t skip_       = 0;
+
+  Slot     slots_[Inflight];
+  uint16_t lastId_  = 0;
+  uint32_t nextSeq_ = 0;
+
+  Stats    stats_;
+};
+
+} // namespace mqtt
@@ -0,0 +1,301 @@
+#pragma once
+/**
+ * @file MqttOutboundQueue.h
+ * @brief Bounded, coalescing outbound queue in front of any IMqttClient.
+ *
+ * - Allocation-free: every queued payload lives in fixed slots inside the object.
+ * - Per-topic policy, registered once with route():
+ *     LatestWins      one slot; a newer value replaces the old one and moves to the back
+ *     ReplaceInPlace  one slot; a newer value replaces the old one but keeps its place
+ *                     (retained status documents)
+ *     Fifo            bounded FIFO shared by all Fifo topics, so event order is kept;
+ *                     when full the oldest entry is dropped and counted
+ *   Topics without a route go straight to the inner client (old behavior).
+ * - Streamed publishes (beginPublish/write/endPublish) are never queued: they
+ *   are for unrouted, best-effort telemetry (trace frames, reports) and are
+ *   refused for routed topics, while disconnected, and while anything is
+ *   pending, so they can neither be lost silently nor overtake the backlog.
+ *   Routed documents are serialized into a buffer and go through publish().
+ * - publish() never waits for the broker: while connected with nothing pending it
+ *   sends directly; otherwise it queues and returns true.
+ * - drain(nowMs) sends queued entries in enqueue order at a token-bucket rate,
+ *   so a reconnect does not burst the whole backlog into the socket at once.
+ *
+ * Not thread-safe: publish() and drain() belong to one task (the network task).
+ *
+ * Usage:
+ *   mqtt::OutboundQueue<> out(adapter);
+ *   out.route(topics[Hor], mqtt::QueuePolicy::LatestWins);
+ *   out.publish(topics[Hor], "pre_12");   // sent now, or coalesced until reconnect
+ *   out.drain(millis());                   // every network service pass
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "protocols/mqtt/MqttClient.h"
+
+namespace mqtt {
+
+enum class QueuePolicy : uint8_t { LatestWins, ReplaceInPlace, Fifo };
+
+template <std::size_t Routes       = 8,    // topics with a queue policy
+          std::size_t Slots        = 4,    // LatestWins/ReplaceInPlace topics (one slot each)
+          std::size_t FifoDepth    = 16,   // queued Fifo messages (all Fifo topics)
+          std::size_t SlotCap      = 512,  // payload bytes per LatestWins/ReplaceInPlace slot
+          std::size_t FifoCap      = 32>   // payload bytes per Fifo entry
+class OutboundQueue : public IMqttClient {
+public:
+  struct Stats {
+    uint32_t sent      = 0;   // delivered to the inner client (direct or drained)
+    uint32_t queued    = 0;   // accepted into the queue
+    uint32_t coalesced = 0;   // replaced an undelivered value of the same topic
+    uint32_t dropped   = 0;   // lost: FIFO overflow or payload too large
+    uint32_t refused   = 0;   // streamed publish not started (see beginPublish)
+  };
+
+  explicit OutboundQueue(IMqttClient& inner) : inner_(inner) {}
+
+  /**
+   * Give `topic` a queue policy. The string must outlive the queue
+   * (e.g. a cannon::Topics entry). Returns false when the route table, or
+   * the slot table for a keyed policy, is full.
+   */
+  bool route(const char* topic, QueuePolicy policy) {
+    if (!topic || routeCount_ >= Routes) return false;
+    if (findRoute_(topic) >= 0) return true;
+    uint8_t slot = kNoSlot;
+    if (policy != QueuePolicy::Fifo) {
+      if (slotCount_ >= Slots) return false;
+      slot = static_cast<uint8_t>(slotCount_++);
+    }
+    routes_[routeCount_++] = Route{topic, policy, slot};
+    return true;
+  }
+
+  /** Drain budget: `perSecond` messages sustained, up to `burst` back to back. */
+  void setDrainRate(uint16_t perSecond, uint16_t burst) {
+    ratePerSec_ = perSecond ? perSecond : 1;
+    burstMilli_ = static_cast<uint32_t>(burst ? burst : 1) * 1000U;
+    if (tokensMilli_ > burstMilli_) tokensMilli_ = burstMilli_;
+  }
+
+  /**
+   * Send queued messages in enqueue order while the session is up and the
+   * rate budget allows. Stops at the first send failure (entry is kept).
+   * Returns the number of messages sent.
+   */
+  std::size_t drain(uint32_t nowMs) {
+    refill_(nowMs);
+    std::size_t n = 0;
+    while (pending_ && tokensMilli_ >= 1000U && inner_.connected()) {
+      if (!sendOldest_()) break;
+      tokensMilli_ -= 1000U;
+      ++n;
+    }
+    return n;
+  }
+
+  std::size_t pending() const { return pending_; }
+  const Stats& stats() const { return stats_; }
+
+  // ----------------------------------------------------------------------
+  // IMqttClient
+  // ----------------------------------------------------------------------
+  bool begin(const Config& cfg) override { return inner_.begin(cfg); }
+  bool connect() override { return inner_.connect(); }
+  void loop() override { inner_.loop(); }
+  bool connected() const override { return inner_.connected(); }
+  void disconnect() override { inner_.disconnect(); }
+
+  bool publish(const char* topic, const char* payload,
+               bool retain = false, int qos = 0) override {
+    return publish(topic, reinterpret_cast<const uint8_t*>(payload ? payload : ""),
+                   payload ? std::strlen(payload) : 0, retain, qos);
+  }
+
+  bool publish(const char* topic, const uint8_t* payload, std::size_t len,
+               bool retain = false, int qos = 0) override {
+    const int r = findRoute_(topic);
+    if (r < 0) return inner_.publish(topic, payload, len, retain, qos);
+
+    // Fast path keeps latency flat when nothing is waiting ahead of us
+    if (pending_ == 0 && inner_.connected() &&
+        inner_.publish(topic, payload, len, retain, qos)) {
+      ++stats_.sent;
+      return true;
+    }
+    return enqueue_(static_cast<uint8_t>(r), payload, len, retain, qos);
+  }
+
+  // Streamed publishes bypass the queue, so only when it could not matter:
+  // unrouted topic, session up, nothing waiting ahead (and no token spent,
+  // like the direct path of publish()).
+  bool beginPublish(const char* topic, std::size_t len,
+                    bool retain = false, int qos = 0) override {
+    streaming_ = false;
+    if (findRoute_(topic) >= 0 || pending_ != 0 || !inner_.connected()) {
+      ++stats_.refused;
+      return false;
+    }
+    streaming_ = inner_.beginPublish(topic, len, retain, qos);
+    return streaming_;
+  }
+  std::size_t write(const uint8_t* data, std::size_t len) override {
+    return streaming_ ? inner_.write(data, len) : 0;
+  }
+  bool endPublish() override {
+    if (!streaming_) return false;
+    streaming_ = false;
+    if (!inner_.endPublish()) return false;
+    ++stats_.sent;
+    return true;
+  }
+
+  bool subscribe(const char* topicFilter, int qos = 0) override {
+    return inner_.subscribe(topicFilter, qos);
+  }
+  void onMessage(MessageHandler handler) override { inner_.onMessage(handler); }
+
+private:
+  static_assert(Routes > 0 && Routes < 255, "OutboundQueue holds 1..254 routes");
+  static_assert(Slots > 0 && Slots < 255, "OutboundQueue holds 1..254 slots");
+  static_assert(FifoDepth > 0, "OutboundQueue needs a FIFO");
+
+  static constexpr uint8_t kNoSlot = 0xFF;
+
+  struct Route {
+    const char* topic  = nullptr;
+    QueuePolicy policy = QueuePolicy::LatestWins;
+    uint8_t     slot   = kNoSlot;   // keyed policies only
+  };
+
+  struct Header {
+    uint32_t    seq    = 0;     // enqueue order across slots and FIFO
+    uint16_t    len    = 0;
+    uint8_t     route  = 0;
+    uint8_t     qos    = 0;
+    bool        retain = false;
+  };
+
+  struct Slot  { bool full = false; Header h; uint8_t data[SlotCap]; };
+  struct Entry { Header h; uint8_t data[FifoCap]; };
+
+  int findRoute_(const char* topic) const {
+    if (!topic) return -1;
+    for (std::size_t i = 0; i < routeCount_; ++i) {     // pointer match first: Topics entries
+      if (routes_[i].topic == topic) return static_cast<int>(i);
+    }
+    for (std::size_t i = 0; i < routeCount_; ++i) {
+      if (std::strcmp(routes_[i].topic, topic) == 0) return static_cast<int>(i);
+    }
+    return -1;
+  }
+
+  static void fill_(Header& h, uint8_t data[], uint32_t seq, uint8_t route,
+                    const uint8_t* payload, std::size_t len, bool retain, int qos) {
+    h.seq    = seq;
+    h.len    = static_cast<uint16_t>(len);
+    h.route  = route;
+    h.qos    = static_cast<uint8_t>(qos);
+    h.retain = retain;
+    if (len) std::memcpy(data, payload, len);
+  }
+
+  bool enqueue_(uint8_t r, const uint8_t* payload, std::size_t len, bool retain, int qos) {
+    const QueuePolicy policy = routes_[r].policy;
+
+    if (policy == QueuePolicy::Fifo) {
+      if (len > FifoCap) { ++stats_.dropped; return false; }
+      if (fifoCount_ == FifoDepth) {                      // keep the newest events
+        fifoHead_ = (fifoHead_ + 1) % FifoDepth;
+        --fifoCount_;
+        --pending_;
+        ++stats_.dropped;
+      }
+      Entry& e = fifo_[(fifoHead_ + fifoCount_) % FifoDepth];
+      fill_(e.h, e.data, nextSeq_++, r, payload, len, retain, qos);
+      ++fifoCount_;
+      ++pending_;
+      ++stats_.queued;
+      return true;
+    }
+
+    if (len > SlotCap) { ++stats_.dropped; return false; }
+    Slot& s = slots_[routes_[r].slot];
+    uint32_t seq = nextSeq_++;
+    if (s.full) {
+      ++stats_.coalesced;
+      if (policy == QueuePolicy::ReplaceInPlace) seq = s.h.seq;
+    } else {
+      s.full = true;
+      ++pending_;
+    }
+    fill_(s.h, s.data, seq, r, payload, len, retain, qos);
+    ++stats_.queued;
+    return true;
+  }
+
+  // Oldest of: the FIFO head and every full slot
+  bool sendOldest_() {
+    int slot = -1;
+    uint32_t best = 0;
+    bool haveBest = false;
+    if (fifoCount_) { best = fifo_[fifoHead_].h.seq; haveBest = true; }
+    for (std::size_t i = 0; i < slotCount_; ++i) {
+      if (!slots_[i].full) continue;
+      // Wrap-safe "older than"
+      if (!haveBest || static_cast<int32_t>(slots_[i].h.seq - best) < 0) {
+        best = slots_[i].h.seq;
+        slot = static_cast<int>(i);
+        haveBest = true;
+      }
+    }
+    if (!haveBest) return false;
+
+    if (slot >= 0) {
+      Slot& s = slots_[slot];
+      if (!inner_.publish(routes_[s.h.route].topic, s.data, s.h.len, s.h.retain, s.h.qos)) return false;
+      s.full = false;
+    } else {
+      Entry& e = fifo_[fifoHead_];
+      if (!inner_.publish(routes_[e.h.route].topic, e.data, e.h.len, e.h.retain, e.h.qos)) return false;
+      fifoHead_ = (fifoHead_ + 1) % FifoDepth;
+      --fifoCount_;
+    }
+    --pending_;
+    ++stats_.sent;
+    return true;
+  }
+
+  void refill_(uint32_t nowMs) {
+    if (!clockStarted_) { lastRefillMs_ = nowMs; clockStarted_ = true; }
+    const uint32_t add = (nowMs - lastRefillMs_) * ratePerSec_;   // ms * msg/s = milli-messages
+    lastRefillMs_ = nowMs;
+    tokensMilli_ = (add >= burstMilli_ - tokensMilli_) ? burstMilli_ : tokensMilli_ + add;
+  }
+
+  IMqttClient& inner_;
+
+  Route       routes_[Routes];
+  std::size_t routeCount_ = 0;
+
+  Slot        slots_[Slots];
+  std::size_t slotCount_ = 0;
+  Entry       fifo_[FifoDepth];
+  std::size_t fifoHead_  = 0;
+  std::size_t fifoCount_ = 0;
+  std::size_t pending_   = 0;
+  uint32_t    nextSeq_   = 0;
+
+  uint32_t    ratePerSec_   = 20;
+  uint32_t    burstMilli_   = 5000;
+  uint32_t    tokensMilli_  = 5000;
+  uint32_t    lastRefillMs_ = 0;
+  bool        clockStarted_ = false;
+  bool        streaming_    = false;   // beginPublish() went through to inner_
+
+  Stats       stats_;
+};
+
+} // namespace mqtt
@@ -0,0 +1,52 @@
+#pragma once
+/**
+ * @file MqttPublishStream.h
+ * @brief Stream a serializer straight into an MQTT PUBLISH (no payload buffer).
+ *
+ * MQTT needs the payload length before the payload, so the serializer runs
+ * twice: once into a CountingSink, then into a PublishSink that forwards to
+ * IMqttClient::write(). The serializer must be deterministic across passes.
+ *
+ * Usage:
+ *   mqtt::publishStreamed(client, topic, [&](util::ByteSink& s) {
+ *     return state.writeJson(s);
+ *   });
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include "protocols/mqtt/MqttClient.h"
+#include "util/ByteSink.h"
+
+namespace mqtt {
+
+/** ByteSink over a streaming publish started with beginPublish(). */
+class PublishSink : public util::ByteSink {
+public:
+  explicit PublishSink(IMqttClient& c) : c_(c) {}
+  bool put(const char* data, std::size_t n) override {
+    return c_.write(reinterpret_cast<const uint8_t*>(data), n) == n;
+  }
+  using util::ByteSink::put;
+
+private:
+  IMqttClient& c_;
+};
+
+/**
+ * Measure with `fn`, then publish its output directly into the packet.
+ * `fn(util::ByteSink&)` returns false to skip the publish (e.g. nothing changed).
+ */
+template <typename Fn>
+bool publishStreamed(IMqttClient& client, const char* topic, Fn&& fn,
+                     bool retain = false, int qos = 0) {
+  util::CountingSink count;
+  if (!fn(count)) return false;
+
+  if (!client.beginPublish(topic, count.size(), retain, qos)) return false;
+  PublishSink sink(client);
+  const bool wrote = fn(sink);
+  return client.endPublish() && wrote;
+}
+
+} // namespace mqtt
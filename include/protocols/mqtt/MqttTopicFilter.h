@@ -0,0 +1,129 @@
+#pragma once
+/**
+ * @file MqttTopicFilter.h
+ * @brief Subscribe filter compiled once into levels, then matched against
+ *        inbound topics without rescanning the filter string.
+ *
+ * - Allocation-free: the filter text and its level table live in the object.
+ * - compile() validates with validateSubscribeFilter() and records each level
+ *   as literal (offset + length), '+' or '#'.
+ * - matches() walks the topic once, level by level: a literal costs a length
+ *   check and one memcmp, '+' skips a level, '#' accepts the rest.
+ * - MQTT rules: '+' matches an empty level, "a/#" also matches "a", and a
+ *   leading wildcard never matches a "$SYS"-style topic.
+ *
+ * Usage:
+ *   mqttt::TopicFilter<> f;
+ *   f.compile({"MermaidsTale", "+", "reset"});
+ *   f.matches("MermaidsTale/Cannon2/reset");   // true
+ *   f.matches("MermaidsTale/Cannons/reset");   // true
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include "protocols/mqtt/MqttTopic.h"
+
+namespace mqttt {
+
+template <std::size_t Cap = 64, std::size_t MaxLevels = 8>
+class TopicFilter {
+  static_assert(Cap > 1 && Cap <= 256, "TopicFilter level offsets are 8-bit");
+  static_assert(MaxLevels > 0 && MaxLevels < 256, "TopicFilter holds 1..255 levels");
+
+public:
+  /** Compile a filter string. False (and empty) if invalid or too long/deep. */
+  bool compile(const char* filter, char sep = '/') {
+    clear();
+    if (!validateSubscribeFilter(filter, sep)) return false;
+    const std::size_t n = std::strlen(filter);
+    if (n >= Cap) return false;
+    std::memcpy(text_, filter, n + 1);
+    sep_ = sep;
+    if (!split_(n)) {
+      clear();
+      return false;
+    }
+    return true;
+  }
+
+  /** Compile from levels, joined like mqttt::join (e.g. {"room", "+", "cmd"}). */
+  bool compile(std::initializer_list<const char*> segments, const BuildOptions& opt = {}) {
+    char buf[Cap];
+    if (!join(buf, sizeof(buf), segments, opt)) {
+      clear();
+      return false;
+    }
+    return compile(buf, opt.separator);
+  }
+
+  void clear() {
+    text_[0] = '\0';
+    count_ = 0;
+    wildcard_ = false;
+  }
+
+  /** True if `topic` is delivered by this filter. */
+  bool matches(const char* topic) const {
+    if (!topic || count_ == 0) return false;
+    if (*topic == '$' && levels_[0].kind != Literal) return false;
+
+    const char* p = topic;
+    for (std::size_t i = 0; i < count_; ++i) {
+      const Level& l = levels_[i];
+      if (l.kind == Hash) return true;
+
+      const char* e = p;
+      while (*e && *e != sep_) ++e;
+      if (l.kind == Literal &&
+          (static_cast<std::size_t>(e - p) != l.len || std::memcmp(p, text_ + l.off, l.len) != 0)) {
+        return false;
+      }
+      if (*e == '\0') {
+        // Topic ends here: so must the filter, unless only "/#" is left
+        return i + 1 == count_ || (i + 2 == count_ && levels_[i + 1].kind == Hash);
+      }
+      p = e + 1;
+    }
+    return false;   // topic has more levels than the filter
+  }
+
+  bool valid() const { return count_ != 0; }
+  bool hasWildcard() const { return wildcard_; }
+  std::size_t levels() const { return count_; }
+  const char* str() const { return text_; }
+
+private:
+  enum Kind : uint8_t { Literal, Plus, Hash };
+  struct Level {
+    uint8_t off  = 0;
+    uint8_t len  = 0;
+    Kind    kind = Literal;
+  };
+
+  bool split_(std::size_t n) {
+    std::size_t start = 0;
+    for (std::size_t i = 0; i <= n; ++i) {
+      if (i < n && text_[i] != sep_) continue;
+      if (count_ == MaxLevels) return false;
+      Level& l = levels_[count_++];
+      l.off = static_cast<uint8_t>(start);
+      l.len = static_cast<uint8_t>(i - start);
+      l.kind = Literal;
+      if (l.len == 1 && text_[start] == '+') l.kind = Plus;
+      if (l.len == 1 && text_[start] == '#') l.kind = Hash;
+      wildcard_ |= (l.kind != Literal);
+      start = i + 1;
+    }
+    return true;
+  }
+
+  char    text_[Cap] = {};
+  Level   levels_[MaxLevels];
+  uint8_t count_     = 0;
+  bool    wildcard_  = false;
+  char    sep_       = '/';
+};
+
+} // namespace mqttt
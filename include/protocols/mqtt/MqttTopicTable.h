@@ -0,0 +1,99 @@
+#pragma once
+/**
+ * @file MqttTopicTable.h
+ * @brief Fixed set of topics built once, plus hashed lookup for inbound dispatch.
+ *
+ * - Allocation-free: all topic strings live in the table object.
+ * - Build each entry once (boot) with the same segment joining as mqttt::join.
+ * - find(topic) hashes the incoming topic (FNV-1a) into a small open-addressed
+ *   index and confirms with one strcmp, so dispatch never builds strings.
+ *
+ * Usage:
+ *   enum Id : uint8_t { Reset, Status, kCount };
+ *   mqttt::TopicTable<kCount> t;
+ *   t.set(Reset, {"room", "dev1", "reset"});
+ *   switch (t.find(topic)) { case Reset: ...; }
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include "protocols/mqtt/MqttTopic.h"
+
+namespace mqttt {
+
+/** FNV-1a over a NUL-terminated string. */
+constexpr uint32_t fnv1a(const char* s) {
+  uint32_t h = 2166136261u;
+  while (*s) { h ^= static_cast<uint8_t>(*s++); h *= 16777619u; }
+  return h;
+}
+
+template <std::size_t N, std::size_t TopicCap = 64>
+class TopicTable {
+  static_assert(N > 0 && N < 255, "TopicTable holds 1..254 entries");
+
+public:
+  static constexpr int kNotFound = -1;
+
+  TopicTable() { std::memset(index_, kEmpty, sizeof(index_)); }
+
+  /** Build entry `id` from segments (e.g. {"MermaidsTale", "Cannon2", "Hor"}). */
+  bool set(std::size_t id, std::initializer_list<const char*> segments,
+           const BuildOptions& opt = {}) {
+    if (id >= N) return false;
+    if (!join(topics_[id], TopicCap, segments, opt)) {
+      topics_[id][0] = '\0';
+      return false;
+    }
+    rebuildIndex_();
+    return true;
+  }
+
+  /** Topic string for `id` ("" if unset). Stable for the table's lifetime. */
+  const char* operator[](std::size_t id) const { return id < N ? topics_[id] : ""; }
+  const char* get(std::size_t id) const { return (*this)[id]; }
+
+  /** Id of an exact topic match, or kNotFound. */
+  int find(const char* topic) const {
+    if (!topic) return kNotFound;
+    const uint32_t h = fnv1a(topic);
+    for (std::size_t i = 0, slot = h & kMask; i < kSlots; ++i, slot = (slot + 1) & kMask) {
+      const uint8_t e = index_[slot];
+      if (e == kEmpty) return kNotFound;
+      if (hashes_[e] == h && std::strcmp(topics_[e], topic) == 0) return e;
+    }
+    return kNotFound;
+  }
+
+  static constexpr std::size_t size() { return N; }
+
+private:
+  // Power-of-two slot count at least 2N keeps probe chains short
+  static constexpr std::size_t slotsFor(std::size_t n) {
+    std::size_t s = 1;
+    while (s < 2 * n) s <<= 1;
+    return s;
+  }
+  static constexpr std::size_t kSlots = slotsFor(N);
+  static constexpr std::size_t kMask  = kSlots - 1;
+  static constexpr uint8_t     kEmpty = 0xFF;
+
+  void rebuildIndex_() {
+    std::memset(index_, kEmpty, sizeof(index_));
+    for (std::size_t id = 0; id < N; ++id) {
+      if (topics_[id][0] == '\0') continue;
+      hashes_[id] = fnv1a(topics_[id]);
+      std::size_t slot = hashes_[id] & kMask;
+      while (index_[slot] != kEmpty) slot = (slot + 1) & kMask;
+      index_[slot] = static_cast<uint8_t>(id);
+    }
+  }
+
+  char     topics_[N][TopicCap] = {};
+  uint32_t hashes_[N] = {};
+  uint8_t  index_[kSlots] = {};
+};
+
+} // namespace mqttt
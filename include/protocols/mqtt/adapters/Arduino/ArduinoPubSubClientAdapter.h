@@ -13,8 +13,8 @@
 
 #include <Arduino.h>
 #include <PubSubClient.h>
-#include <functional>
 #include "protocols/mqtt/MqttClient.h"
+#include "util/Profiler.h"
 
 class ArduinoPubSubClientAdapter : public mqtt::IMqttClient {
 public:
@@ -26,10 +26,10 @@ public:
   bool begin(const mqtt::Config& cfg) override {
     cfg_ = cfg;
     client_.setServer(cfg_.brokerHost, cfg_.brokerPort);
-    // Bridge PubSubClient callback to our std::function
-    client_.setCallback([this](char* topic, byte* payload, unsigned int length){
-      if (onMessage_) onMessage_(topic, payload, static_cast<size_t>(length));
-    });
+    // PubSubClient stores a std::function; a plain function pointer fits
+    // its small-object buffer, where a capturing lambda may not
+    active_ = this;
+    client_.setCallback(&ArduinoPubSubClientAdapter::dispatch_);
     client_.setKeepAlive(cfg_.keepAliveS);
     return true;
   }
@@ -47,6 +47,7 @@ public:
   }
 
   void loop() override {
+    PROF_SCOPE("mqtt.loop");
     client_.loop();
   }
 
@@ -60,22 +61,50 @@ public:
 
   bool publish(const char* topic, const char* payload, bool retain, int /*qos*/) override {
     // PubSubClient supports QoS 0 only; qos is ignored here.
+    PROF_SCOPE("mqtt.publish");
     return client_.publish(topic, payload, retain);
   }
 
+  bool publish(const char* topic, const uint8_t* payload, size_t len,
+               bool retain, int /*qos*/) override {
+    PROF_SCOPE("mqtt.publish");
+    return client_.publish(topic, payload, static_cast<unsigned int>(len), retain);
+  }
+
+  // PubSubClient writes the header on beginPublish() and streams write()
+  // straight to the socket, so payloads need no intermediate buffer.
+  bool beginPublish(const char* topic, size_t len, bool retain, int /*qos*/) override {
+    return client_.beginPublish(topic, static_cast<unsigned int>(len), retain);
+  }
+
+  size_t write(const uint8_t* data, size_t len) override {
+    return client_.write(data, len);
+  }
+
+  bool endPublish() override {
+    return client_.endPublish() == 1;
+  }
+
   bool subscribe(const char* topicFilter, int /*qos*/) override {
     // PubSubClient supports QoS 0 only; qos is ignored here.
     return client_.subscribe(topicFilter);
   }
 
   void onMessage(mqtt::MessageHandler handler) override {
-    onMessage_ = std::move(handler);
+    onMessage_ = handler;
   }
 
 private:
   mqtt::Config cfg_{};
   PubSubClient& client_;
   mqtt::MessageHandler onMessage_{};
+
+  static ArduinoPubSubClientAdapter* active_;   // the adapter begin() ran on
+  static void dispatch_(char* topic, byte* payload, unsigned int length) {
+    if (active_ && active_->onMessage_) active_->onMessage_(topic, payload, static_cast<size_t>(length));
+  }
 };
 
+inline ArduinoPubSubClientAdapter* ArduinoPubSubClientAdapter::active_ = nullptr;
+
 #endif // ARDUINO
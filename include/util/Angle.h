@@ -0,0 +1,123 @@
+#pragma once
+/**
+ * @file Angle.h
+ * @brief Integer angle type (centi-degrees) and a table-driven atan2.
+ *
+ * - No Arduino deps, no floats on the hot path.
+ * - util::Angle is always normalized to [0, 36000) centi-degrees, so every
+ *   consumer (state, view, telemetry) can compare and format it directly.
+ * - util::atan2Cdeg() uses a constexpr-generated 257-entry atan table over
+ *   one octant with linear interpolation (error well below 0.01 deg).
+ */
+
+#include <array>
+#include <cstdint>
+
+namespace util {
+
+class Angle {
+public:
+  static constexpr int32_t kFull = 36000;  // centi-degrees per turn
+  static constexpr int32_t kHalf = 18000;
+
+  constexpr Angle() = default;
+
+  /** Any integer centi-degree value; wrapped into [0, 36000). */
+  static constexpr Angle fromCdeg(int32_t cdeg) {
+    int32_t m = cdeg % kFull;
+    if (m < 0) m += kFull;
+    return Angle(static_cast<uint16_t>(m));
+  }
+  static constexpr Angle fromDeg(int32_t deg) { return fromCdeg(deg * 100); }
+
+  constexpr uint16_t cdeg() const { return cdeg_; }
+
+  /** Whole degrees, rounded half-up and wrapped (359.5 -> 0). Range 0..359. */
+  constexpr uint16_t deg() const {
+    const uint16_t d = static_cast<uint16_t>((cdeg_ + 50) / 100);
+    return d >= 360 ? 0 : d;
+  }
+
+  /** Signed shortest rotation from `from` to this angle, in (-18000, 18000]. */
+  constexpr int32_t deltaFrom(Angle from) const {
+    int32_t d = static_cast<int32_t>(cdeg_) - static_cast<int32_t>(from.cdeg_);
+    if (d > kHalf)   d -= kFull;
+    if (d <= -kHalf) d += kFull;
+    return d;
+  }
+
+  /** Absolute shortest distance between two angles, 0..18000. */
+  constexpr uint16_t distanceTo(Angle other) const {
+    const int32_t d = deltaFrom(other);
+    return static_cast<uint16_t>(d < 0 ? -d : d);
+  }
+
+  constexpr bool operator==(Angle o) const { return cdeg_ == o.cdeg_; }
+  constexpr bool operator!=(Angle o) const { return cdeg_ != o.cdeg_; }
+
+private:
+  constexpr explicit Angle(uint16_t c) : cdeg_(c) {}
+  uint16_t cdeg_ = 0;
+};
+
+namespace detail {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// atan(t) for t in [0, 1] by reduction around 1 and a Taylor series.
+constexpr double atanUnit(double t) {
+  double base = 0.0;
+  if (t > 0.41421356237) {            // tan(pi/8)
+    base = kPi / 4.0;
+    t = (t - 1.0) / (1.0 + t);        // |t| <= tan(pi/8)
+  }
+  double term = t, sum = 0.0;
+  const double t2 = t * t;
+  for (int n = 0; n < 40; ++n) {
+    sum += term / (2 * n + 1);
+    term *= -t2;
+  }
+  return base + sum;
+}
+
+constexpr std::size_t kAtanSteps = 256;
+
+constexpr std::array<uint16_t, kAtanSteps + 1> makeAtanTable() {
+  std::array<uint16_t, kAtanSteps + 1> t{};
+  for (std::size_t i = 0; i <= kAtanSteps; ++i) {
+    const double rad = atanUnit(static_cast<double>(i) / kAtanSteps);
+    t[i] = static_cast<uint16_t>(rad * 18000.0 / kPi + 0.5);
+  }
+  return t;
+}
+
+inline constexpr std::array<uint16_t, kAtanSteps + 1> kAtanCdeg = makeAtanTable();
+
+// atan(num/den) in centi-degrees for 0 <= num <= den, den > 0.
+constexpr int32_t atanOctant(uint32_t num, uint32_t den) {
+  // Q16 ratio; keep the shift in 64 bits for large accumulators
+  const uint32_t q = static_cast<uint32_t>((static_cast<uint64_t>(num) << 16) / den);
+  const uint32_t idx  = q >> 8;          // 0..256
+  const uint32_t frac = q & 0xFF;
+  if (idx >= kAtanSteps) return kAtanCdeg[kAtanSteps];
+  const int32_t a = kAtanCdeg[idx];
+  const int32_t b = kAtanCdeg[idx + 1];
+  return a + (((b - a) * static_cast<int32_t>(frac) + 128) >> 8);
+}
+
+} // namespace detail
+
+/** atan2(y, x) as a normalized Angle (0 for the origin). */
+constexpr Angle atan2Cdeg(int32_t y, int32_t x) {
+  const uint32_t ax = static_cast<uint32_t>(x < 0 ? -static_cast<int64_t>(x) : x);
+  const uint32_t ay = static_cast<uint32_t>(y < 0 ? -static_cast<int64_t>(y) : y);
+  if (ax == 0 && ay == 0) return Angle{};
+
+  int32_t a = (ay <= ax) ? detail::atanOctant(ay, ax)
+                         : 9000 - detail::atanOctant(ax, ay);
+  if (x < 0) a = Angle::kHalf - a;
+  if (y < 0) a = Angle::kFull - a;
+  return Angle::fromCdeg(a);
+}
+
+} // namespace util
@@ -0,0 +1,148 @@
+#pragma once
+/**
+ * @file AngleTracker.h
+ * @brief Alpha-beta heading tracker: smoothing with a velocity term, so a
+ *        steady swing is followed without the lag of a plain low-pass.
+ *
+ * - No Arduino deps. State is integer (Q8 centi-degrees, Q8 centi-degrees/s);
+ *   float is only used to derive the gains, which happens again only when
+ *   the sample interval changes by more than a quarter.
+ * - Wrap-aware: residuals use the shortest rotation, so 359 -> 1 deg is +2.
+ * - Gains are the steady-state Kalman (Kalata) alpha/beta for measurement
+ *   noise sigma_v and swing acceleration sigma_a: as much smoothing as that
+ *   noise model allows, and no steady-state lag on a constant-rate swing.
+ * - Outliers: a measurement further than maxJumpCdeg from the prediction is
+ *   ignored; after reseedAfter rejections in a row the tracker restarts from
+ *   the sensor (the cannon really did move that fast).
+ *
+ * Usage:
+ *   util::AngleTracker tracker({25, 20000, 1000});
+ *   tracker.update(als.angle(), micros());
+ *   publish(tracker.angle());
+ */
+
+#include <cmath>
+#include <cstdint>
+#include "util/Angle.h"
+
+namespace util {
+
+class AngleTracker {
+public:
+  struct Config {
+    uint16_t noiseCdeg      = 25;       // measurement noise sigma (centi-degrees)
+    uint32_t accelCdegPerS2 = 20000;    // swing acceleration sigma (centi-degrees/s^2)
+    uint16_t maxJumpCdeg    = 1000;     // outlier gate around the prediction
+    uint8_t  reseedAfter    = 3;        // consecutive rejections before trusting the sensor
+    uint32_t maxGapUs       = 250000;   // a longer gap restarts from the measurement
+  };
+
+  AngleTracker() = default;
+  explicit AngleTracker(const Config& cfg) : cfg_(cfg) {}
+
+  void configure(const Config& cfg) { cfg_ = cfg; gainDtUs_ = 0; }
+  const Config& config() const { return cfg_; }
+
+  /** Forget the track; the next update() seeds position from the measurement. */
+  void reset() { primed_ = false; }
+
+  /** Feed one measurement taken at nowUs (micros()). False if it was rejected. */
+  bool update(Angle meas, uint32_t nowUs) {
+    const uint32_t dtUs = nowUs - lastUs_;
+    if (!primed_ || dtUs == 0 || dtUs > cfg_.maxGapUs) {
+      seed_(meas, nowUs);
+      return true;
+    }
+    lastUs_ = nowUs;
+    if (dtUs > gainDtUs_ + gainDtUs_ / 4 || dtUs + dtUs / 4 < gainDtUs_) deriveGains_(dtUs);
+
+    // Predict
+    const int32_t predicted = wrap_(pos_ + static_cast<int32_t>(
+        static_cast<int64_t>(vel_) * dtUs / 1000000));
+    const int32_t residual = shortest_(static_cast<int32_t>(meas.cdeg()) * kOne - predicted);
+
+    // Gate
+    const int32_t mag = residual < 0 ? -residual : residual;
+    if (mag > static_cast<int32_t>(cfg_.maxJumpCdeg) * kOne) {
+      pos_ = predicted;
+      ++rejected_;
+      if (++rejectRun_ >= cfg_.reseedAfter) seed_(meas, nowUs);
+      return false;
+    }
+    rejectRun_ = 0;
+
+    // Correct
+    pos_ = wrap_(predicted + static_cast<int32_t>((static_cast<int64_t>(alphaQ12_) * residual) >> 12));
+    vel_ += static_cast<int32_t>(static_cast<int64_t>(betaQ12_) * residual * 1000000 /
+                                 (static_cast<int64_t>(dtUs) << 12));
+    return true;
+  }
+
+  /** Filtered heading. */
+  Angle angle() const { return Angle::fromCdeg((pos_ + kOne / 2) / kOne); }
+
+  /** Heading extrapolated `aheadUs` past the last measurement (lag compensation). */
+  Angle predict(uint32_t aheadUs) const {
+    const int32_t p = wrap_(pos_ + static_cast<int32_t>(static_cast<int64_t>(vel_) * aheadUs / 1000000));
+    return Angle::fromCdeg((p + kOne / 2) / kOne);
+  }
+
+  /** Estimated angular rate, centi-degrees per second (signed). */
+  int32_t velocityCdegPerS() const { return vel_ / kOne; }
+
+  /** Measurements dropped by the outlier gate since boot. */
+  uint32_t rejected() const { return rejected_; }
+
+  /** Current gains, Q12 (4096 == 1.0). */
+  uint16_t alphaQ12() const { return alphaQ12_; }
+  uint16_t betaQ12() const { return betaQ12_; }
+
+private:
+  static constexpr int32_t kOne  = 256;                   // Q8
+  static constexpr int32_t kFull = Angle::kFull * kOne;
+  static constexpr int32_t kHalf = Angle::kHalf * kOne;
+
+  static int32_t wrap_(int32_t p) {
+    p %= kFull;
+    return p < 0 ? p + kFull : p;
+  }
+  static int32_t shortest_(int32_t d) {
+    d = wrap_(d);
+    return d > kHalf ? d - kFull : d;
+  }
+
+  void seed_(Angle meas, uint32_t nowUs) {
+    pos_       = static_cast<int32_t>(meas.cdeg()) * kOne;
+    vel_       = 0;
+    lastUs_    = nowUs;
+    rejectRun_ = 0;
+    primed_    = true;
+  }
+
+  // Kalata: lambda = sigma_a * T^2 / sigma_v; the steady-state Kalman gains of
+  // a constant-velocity model with that tracking index.
+  void deriveGains_(uint32_t dtUs) {
+    gainDtUs_ = dtUs;
+    const float t      = static_cast<float>(dtUs) * 1e-6f;
+    const float noise  = cfg_.noiseCdeg ? static_cast<float>(cfg_.noiseCdeg) : 1.0f;
+    const float lambda = static_cast<float>(cfg_.accelCdegPerS2) * t * t / noise;
+    const float r      = (4.0f + lambda - std::sqrt(8.0f * lambda + lambda * lambda)) / 4.0f;
+    const float alpha  = 1.0f - r * r;
+    const float beta   = 2.0f * (2.0f - alpha) - 4.0f * std::sqrt(1.0f - alpha);
+    alphaQ12_ = static_cast<uint16_t>(alpha * 4096.0f + 0.5f);
+    betaQ12_  = static_cast<uint16_t>(beta * 4096.0f + 0.5f);
+  }
+
+  Config   cfg_{};
+  int32_t  pos_       = 0;   // Q8 centi-degrees, [0, kFull)
+  int32_t  vel_       = 0;   // Q8 centi-degrees per second
+  uint32_t lastUs_    = 0;
+  uint32_t gainDtUs_  = 0;
+  uint16_t alphaQ12_  = 4096;
+  uint16_t betaQ12_   = 0;
+  uint32_t rejected_  = 0;
+  uint8_t  rejectRun_ = 0;
+  bool     primed_    = false;
+};
+
+} // namespace util
@@ -0,0 +1,66 @@
+#pragma once
+/**
+ * @file ByteSink.h
+ * @brief Minimal byte-sink interface for serializers (no Arduino deps, no heap).
+ *
+ * Serializers write through a ByteSink so the same code can:
+ *   - measure a payload (CountingSink),
+ *   - fill a caller buffer (BufferSink),
+ *   - or stream straight into an outgoing MQTT packet (mqtt::PublishSink).
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace util {
+
+class ByteSink {
+public:
+  virtual ~ByteSink() = default;
+
+  /** Append n bytes. Returns false if the sink rejected (part of) them. */
+  virtual bool put(const char* data, std::size_t n) = 0;
+
+  bool put(const char* cstr) { return put(cstr, std::strlen(cstr)); }
+  bool put(char c) { return put(&c, 1); }
+};
+
+/** Counts bytes only; the measuring pass of a streamed publish. */
+class CountingSink : public ByteSink {
+public:
+  bool put(const char*, std::size_t n) override { n_ += n; return true; }
+  using ByteSink::put;
+  std::size_t size() const { return n_; }
+
+private:
+  std::size_t n_ = 0;
+};
+
+/** Bounds-checked writes into a caller buffer; always NUL-terminates. */
+class BufferSink : public ByteSink {
+public:
+  BufferSink(char* out, std::size_t cap) : out_(out), cap_(cap) {
+    if (out_ && cap_) out_[0] = '\0';
+  }
+
+  bool put(const char* data, std::size_t n) override {
+    if (!out_ || cap_ == 0 || len_ + n >= cap_) { ok_ = false; return false; }
+    std::memcpy(out_ + len_, data, n);
+    len_ += n;
+    out_[len_] = '\0';
+    return true;
+  }
+  using ByteSink::put;
+
+  std::size_t size() const { return len_; }
+  bool ok() const { return ok_; }   // false once anything was truncated
+
+private:
+  char*       out_;
+  std::size_t cap_;
+  std::size_t len_ = 0;
+  bool        ok_  = true;
+};
+
+} // namespace util
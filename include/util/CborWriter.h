@@ -0,0 +1,82 @@
+#pragma once
+/**
+ * @file CborWriter.h
+ * @brief Minimal RFC 8949 CBOR encoder into a caller buffer (no heap).
+ *
+ * Covers what telemetry needs: definite-length maps/arrays, unsigned and
+ * negative integers, booleans, null and short text strings. Integers always
+ * use the shortest head, so small values cost a single byte.
+ * Sticky failure: once the buffer is full every call is a no-op, ok() is false.
+ *
+ * Usage:
+ *   uint8_t buf[32];
+ *   util::CborWriter c(buf, sizeof(buf));
+ *   c.map(2).uint(0).uint(12345).uint(1).boolean(true);
+ *   sink.put(reinterpret_cast<const char*>(buf), c.size());
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace util {
+
+class CborWriter {
+public:
+  CborWriter(uint8_t* out, std::size_t cap) : out_(out), cap_(out ? cap : 0) {}
+
+  CborWriter& uint(uint64_t v)       { head_(kUnsigned, v); return *this; }
+  CborWriter& sint(int64_t v) {
+    if (v >= 0) head_(kUnsigned, static_cast<uint64_t>(v));
+    else        head_(kNegative, static_cast<uint64_t>(-(v + 1)));
+    return *this;
+  }
+  CborWriter& boolean(bool b)        { byte_(b ? 0xF5 : 0xF4); return *this; }
+  CborWriter& null()                 { byte_(0xF6); return *this; }
+  CborWriter& map(std::size_t pairs) { head_(kMap, pairs); return *this; }
+  CborWriter& array(std::size_t n)   { head_(kArray, n); return *this; }
+
+  CborWriter& text(const char* s) {
+    const std::size_t n = s ? std::strlen(s) : 0;
+    head_(kText, n);
+    if (ok_ && n) {
+      if (len_ + n > cap_) { ok_ = false; return *this; }
+      std::memcpy(out_ + len_, s, n);
+      len_ += n;
+    }
+    return *this;
+  }
+
+  std::size_t size() const { return len_; }
+  bool ok() const { return ok_; }
+
+private:
+  enum Major : uint8_t {
+    kUnsigned = 0 << 5, kNegative = 1 << 5, kText = 3 << 5, kArray = 4 << 5, kMap = 5 << 5
+  };
+
+  void byte_(uint8_t b) {
+    if (!ok_ || len_ >= cap_) { ok_ = false; return; }
+    out_[len_++] = b;
+  }
+
+  // Major type + argument, shortest form, big-endian payload
+  void head_(uint8_t major, uint64_t v) {
+    if (v < 24)               { byte_(major | static_cast<uint8_t>(v)); return; }
+    unsigned n;
+    uint8_t  ai;
+    if (v <= 0xFF)            { n = 1; ai = 24; }
+    else if (v <= 0xFFFF)     { n = 2; ai = 25; }
+    else if (v <= 0xFFFFFFFF) { n = 4; ai = 26; }
+    else                      { n = 8; ai = 27; }
+    byte_(major | ai);
+    for (unsigned i = n; i-- > 0;) byte_(static_cast<uint8_t>(v >> (8 * i)));
+  }
+
+  uint8_t*    out_;
+  std::size_t cap_;
+  std::size_t len_ = 0;
+  bool        ok_  = true;
+};
+
+} // namespace util
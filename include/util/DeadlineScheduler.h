@@ -0,0 +1,169 @@
+#pragma once
+/**
+ * @file DeadlineScheduler.h
+ * @brief Cooperative per-task job table: periodic deadlines plus ISR triggers.
+ *
+ * - No Arduino deps, no heap: up to N jobs (N <= 32) in the object.
+ * - A job runs when its deadline passes, when trigger() was called (ISR-safe),
+ *   or when defer() armed a one-shot deadline. Period 0 = trigger-only.
+ * - Periodic deadlines advance by whole periods from the previous deadline,
+ *   so rates do not drift with job runtime; a job that fell more than one
+ *   period behind skips the missed runs instead of bursting.
+ * - setPeriod() may be called from any task and takes effect at once.
+ * - The owner task sleeps for untilNext() between passes (e.g. in
+ *   ulTaskNotifyTake), and ISRs pair trigger() with a task notification,
+ *   so an idle system wakes only at the next deadline or interrupt.
+ *
+ * Times are wrap-safe 32-bit µs (micros()).
+ *
+ * Usage:
+ *   util::DeadlineScheduler<4> jobs;
+ *   const int angle = jobs.add("angle", 5000, &readAngle);   // 200 Hz
+ *   for (;;) {
+ *     jobs.runDue(micros());
+ *     ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((jobs.untilNext(micros()) + 999) / 1000));
+ *   }
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace util {
+
+template <std::size_t N>
+class DeadlineScheduler {
+  static_assert(N > 0 && N <= 32, "DeadlineScheduler holds 1..32 jobs");
+
+public:
+  using JobFn = void (*)(void* arg);
+
+  static constexpr int      kInvalid     = -1;
+  static constexpr uint32_t kTriggerOnly = 0;            // period: run on trigger()/defer() only
+  static constexpr uint32_t kNever       = 0xFFFFFFFFu;  // untilNext(): nothing armed
+
+  /** Register a job (owner task, before the loop starts). Returns its id. */
+  int add(const char* name, uint32_t periodUs, JobFn fn, void* arg = nullptr) {
+    if (!fn || count_ >= N) return kInvalid;
+    Job& j = jobs_[count_];
+    j.name = name;
+    j.fn   = fn;
+    j.arg  = arg;
+    j.periodUs.store(periodUs, std::memory_order_relaxed);
+    j.armed = false;                 // first runDue() arms periodic jobs at once
+    pending_.fetch_or(bit_(count_), std::memory_order_relaxed);
+    return static_cast<int>(count_++);
+  }
+
+  /** Id of the job called `name`, or kInvalid. */
+  int find(const char* name) const {
+    if (!name) return kInvalid;
+    for (std::size_t i = 0; i < count_; ++i) {
+      if (std::strcmp(jobs_[i].name, name) == 0) return static_cast<int>(i);
+    }
+    return kInvalid;
+  }
+
+  /** Any task. Runs the job on the next pass and re-phases it to the new period. */
+  bool setPeriod(int id, uint32_t periodUs) {
+    if (!valid_(id)) return false;
+    jobs_[id].periodUs.store(periodUs, std::memory_order_relaxed);
+    rephase_.fetch_or(bit_(id), std::memory_order_relaxed);
+    pending_.fetch_or(bit_(id), std::memory_order_release);
+    return true;
+  }
+
+  /** ISR- and task-safe: run job `id` on the next pass. Does not wake the owner. */
+  void trigger(int id) {
+    if (valid_(id)) pending_.fetch_or(bit_(id), std::memory_order_release);
+  }
+
+  /** Owner task only: run `id` once after `delayUs` (an earlier deadline wins). */
+  void defer(int id, uint32_t delayUs, uint32_t nowUs) {
+    if (!valid_(id)) return;
+    Job& j = jobs_[id];
+    const uint32_t due = nowUs + delayUs;
+    if (!j.armed || static_cast<int32_t>(due - j.dueUs) < 0) {
+      j.dueUs = due;
+      j.armed = true;
+    }
+  }
+
+  /**
+   * Owner task: run every triggered or due job, in id order.
+   * Returns a bitmask of the jobs that ran.
+   */
+  uint32_t runDue(uint32_t nowUs) {
+    const uint32_t trig    = pending_.exchange(0, std::memory_order_acquire);
+    const uint32_t rephase = rephase_.exchange(0, std::memory_order_relaxed);
+    uint32_t ran = 0;
+
+    for (std::size_t i = 0; i < count_; ++i) {
+      Job& j = jobs_[i];
+      const bool triggered = (trig & bit_(i)) != 0;
+      const bool expired   = j.armed && static_cast<int32_t>(nowUs - j.dueUs) >= 0;
+      if (!triggered && !expired) continue;
+
+      // Re-arm before running so the job itself may defer() an earlier run
+      const uint32_t p = j.periodUs.load(std::memory_order_relaxed);
+      if (p == kTriggerOnly) {
+        j.armed = false;
+      } else if (!j.armed || (rephase & bit_(i))) {
+        j.dueUs = nowUs + p;
+        j.armed = true;
+      } else if (expired) {
+        j.dueUs += p;
+        if (static_cast<int32_t>(nowUs - j.dueUs) >= 0) j.dueUs = nowUs + p;  // fell behind
+      }                                // triggered early: keep the periodic phase
+
+      ++j.runs;
+      j.fn(j.arg);
+      ran |= bit_(i);
+    }
+    return ran;
+  }
+
+  /** µs until the next deadline (0: something is due or triggered; kNever: idle). */
+  uint32_t untilNext(uint32_t nowUs) const {
+    if (pending_.load(std::memory_order_acquire)) return 0;
+    uint32_t best = kNever;
+    for (std::size_t i = 0; i < count_; ++i) {
+      const Job& j = jobs_[i];
+      if (!j.armed) continue;
+      const int32_t d = static_cast<int32_t>(j.dueUs - nowUs);
+      if (d <= 0) return 0;
+      if (static_cast<uint32_t>(d) < best) best = static_cast<uint32_t>(d);
+    }
+    return best;
+  }
+
+  std::size_t size() const { return count_; }
+  const char* name(int id) const { return valid_(id) ? jobs_[id].name : ""; }
+  uint32_t periodUs(int id) const {
+    return valid_(id) ? jobs_[id].periodUs.load(std::memory_order_relaxed) : 0;
+  }
+  /** Times job `id` has run (owner task; diagnostic). */
+  uint32_t runs(int id) const { return valid_(id) ? jobs_[id].runs : 0; }
+
+private:
+  struct Job {
+    const char*           name  = "";
+    JobFn                 fn    = nullptr;
+    void*                 arg   = nullptr;
+    std::atomic<uint32_t> periodUs{0};
+    uint32_t              dueUs = 0;
+    bool                  armed = false;
+    uint32_t              runs  = 0;
+  };
+
+  static constexpr uint32_t bit_(std::size_t i) { return 1u << i; }
+  bool valid_(int id) const { return id >= 0 && static_cast<std::size_t>(id) < count_; }
+
+  Job                   jobs_[N];
+  std::size_t           count_ = 0;
+  std::atomic<uint32_t> pending_{0};   // trigger()/setPeriod(), any context
+  std::atomic<uint32_t> rephase_{0};   // setPeriod(), any task
+};
+
+} // namespace util
@@ -0,0 +1,202 @@
+#pragma once
+/**
+ * @file DeferredLog.h
+ * @brief Binary log records in a static ring; formatting happens later, on
+ *        whichever task drains it (low priority), never in the caller.
+ *
+ * - DLOG_E/W/I/D/V(fmt, args...) store the format pointer plus up to kArgs
+ *   machine-word arguments: a few stores and one compare-exchange, no
+ *   vsnprintf and no UART wait in the calling task.
+ * - Levels follow CORE_DEBUG_LEVEL (1 error .. 5 verbose) unless DLOG_LEVEL
+ *   is defined; calls above the level expand to nothing.
+ * - Any task or ISR may log (MpscRing). A full ring drops the record and
+ *   counts it; the drainer reports the count.
+ * - `fmt` and every "%s" argument must outlive the record: string literals,
+ *   or names that live as long as the program. Integer formats only
+ *   (%d %i %u %x %X %o %c %s %p, with h/l/ll/z/j/t); floats are rejected at
+ *   compile time. Arguments are stored as machine words and converted back
+ *   to the type each conversion names when formatted, so varargs types
+ *   match on 32- and 64-bit targets alike.
+ *
+ * Usage:
+ *   DLOG_I("Angle changed: %d°", deg);          // newline added on output
+ *   while (util::dlog::next(line, sizeof(line))) Serial.print(line);
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include "util/MpscRing.h"
+
+#ifndef DLOG_LEVEL
+  #if defined(CORE_DEBUG_LEVEL)
+    #define DLOG_LEVEL CORE_DEBUG_LEVEL
+  #else
+    #define DLOG_LEVEL 3
+  #endif
+#endif
+
+#ifndef DLOG_RING_RECORDS
+#define DLOG_RING_RECORDS 64
+#endif
+
+namespace util {
+namespace dlog {
+
+enum Level : uint8_t { Error = 1, Warn, Info, Debug, Verbose };
+
+/** Most arguments one record carries. */
+constexpr std::size_t kArgs = 6;
+
+struct Record {
+  const char* fmt   = nullptr;
+  uint8_t     level = 0;
+  uintptr_t   args[kArgs] = {};
+};
+
+using Ring = MpscRing<Record, DLOG_RING_RECORDS>;
+
+inline Ring& ring() {
+  static Ring r;
+  return r;
+}
+
+template <typename T>
+inline uintptr_t toArg(T v) {
+  static_assert(!std::is_floating_point<T>::value, "DeferredLog: no float arguments");
+  if constexpr (std::is_pointer<T>::value) {
+    return reinterpret_cast<uintptr_t>(v);
+  } else {
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                  "DeferredLog: integer, enum or pointer arguments only");
+    static_assert(sizeof(T) <= sizeof(uintptr_t), "DeferredLog: argument wider than a machine word");
+    return static_cast<uintptr_t>(static_cast<intptr_t>(v));
+  }
+}
+
+/** Queue one record. False if the ring was full (counted in dropped()). */
+template <typename... A>
+inline bool write(Level level, const char* fmt, A... args) {
+  static_assert(sizeof...(A) <= kArgs, "DeferredLog: too many arguments");
+  Record r;
+  r.fmt = fmt;
+  r.level = level;
+  std::size_t i = 0;
+  ((r.args[i++] = toArg(args)), ...);
+  (void)i;
+  return ring().push(r);
+}
+
+namespace detail {
+
+// One conversion spec ("%-08lx"), its argument cast to the type it names
+inline int formatOne(char* out, std::size_t cap, const char* spec, char conv, int longs, char size,
+                     uintptr_t v) {
+  const intptr_t sv = static_cast<intptr_t>(v);
+  switch (conv) {
+    case 's': return std::snprintf(out, cap, spec, v ? reinterpret_cast<const char*>(v) : "(null)");
+    case 'p': return std::snprintf(out, cap, spec, reinterpret_cast<void*>(v));
+    case 'c': return std::snprintf(out, cap, spec, static_cast<int>(sv));
+    case 'd':
+    case 'i':
+      if (size == 'z' || size == 't') return std::snprintf(out, cap, spec, static_cast<std::ptrdiff_t>(sv));
+      if (size == 'j') return std::snprintf(out, cap, spec, static_cast<intmax_t>(sv));
+      if (longs >= 2) return std::snprintf(out, cap, spec, static_cast<long long>(sv));
+      if (longs == 1) return std::snprintf(out, cap, spec, static_cast<long>(sv));
+      return std::snprintf(out, cap, spec, static_cast<int>(sv));
+    default:   // u x X o
+      if (size == 'z' || size == 't') return std::snprintf(out, cap, spec, static_cast<std::size_t>(v));
+      if (size == 'j') return std::snprintf(out, cap, spec, static_cast<uintmax_t>(v));
+      if (longs >= 2) return std::snprintf(out, cap, spec, static_cast<unsigned long long>(v));
+      if (longs == 1) return std::snprintf(out, cap, spec, static_cast<unsigned long>(v));
+      return std::snprintf(out, cap, spec, static_cast<unsigned>(v));
+  }
+}
+
+// Walks fmt so every argument reaches snprintf as the type its conversion
+// expects. Returns the length written to out (< cap, NUL-terminated).
+inline std::size_t format(char* out, std::size_t cap, const char* fmt, const uintptr_t* args) {
+  std::size_t len = 0;
+  std::size_t arg = 0;
+  const char* p = fmt;
+  while (*p && len + 1 < cap) {
+    if (*p != '%') { out[len++] = *p++; continue; }
+    if (p[1] == '%') { out[len++] = '%'; p += 2; continue; }
+
+    const char* start = p++;
+    while (*p && std::strchr("-+ #0", *p)) ++p;
+    while (*p >= '0' && *p <= '9') ++p;
+    if (*p == '.') { ++p; while (*p >= '0' && *p <= '9') ++p; }
+    int longs = 0;
+    char size = 0;
+    for (; *p && std::strchr("hlzjt", *p); ++p) {
+      if (*p == 'l') ++longs;
+      else if (*p != 'h') size = *p;
+    }
+    const char conv = *p;
+    if (!conv || !std::strchr("diuxXocsp", conv)) break;   // unsupported: stop here
+    ++p;
+
+    char spec[16];
+    const std::size_t specLen = static_cast<std::size_t>(p - start);
+    if (specLen >= sizeof(spec)) break;
+    std::memcpy(spec, start, specLen);
+    spec[specLen] = '\0';
+
+    const uintptr_t v = arg < kArgs ? args[arg++] : 0;
+    const int n = formatOne(out + len, cap - len, spec, conv, longs, size, v);
+    if (n < 0) break;
+    len += static_cast<std::size_t>(n) < cap - len ? static_cast<std::size_t>(n) : cap - len - 1;
+  }
+  out[len] = '\0';
+  return len;
+}
+
+} // namespace detail
+
+/**
+ * Consumer side: format the oldest record into `out` with a trailing newline
+ * (truncated to fit). False if nothing is queued.
+ */
+inline bool next(char* out, std::size_t cap) {
+  Record r;
+  if (cap < 2 || !ring().pop(r)) return false;
+  std::size_t len = detail::format(out, cap - 1, r.fmt, r.args);
+  out[len++] = '\n';
+  out[len] = '\0';
+  return true;
+}
+
+/** Records rejected because the ring was full, since boot. */
+inline uint32_t dropped() { return ring().dropped(); }
+
+} // namespace dlog
+} // namespace util
+
+#if DLOG_LEVEL >= 1
+#define DLOG_E(...) ::util::dlog::write(::util::dlog::Error, __VA_ARGS__)
+#else
+#define DLOG_E(...) do {} while (0)
+#endif
+#if DLOG_LEVEL >= 2
+#define DLOG_W(...) ::util::dlog::write(::util::dlog::Warn, __VA_ARGS__)
+#else
+#define DLOG_W(...) do {} while (0)
+#endif
+#if DLOG_LEVEL >= 3
+#define DLOG_I(...) ::util::dlog::write(::util::dlog::Info, __VA_ARGS__)
+#else
+#define DLOG_I(...) do {} while (0)
+#endif
+#if DLOG_LEVEL >= 4
+#define DLOG_D(...) ::util::dlog::write(::util::dlog::Debug, __VA_ARGS__)
+#else
+#define DLOG_D(...) do {} while (0)
+#endif
+#if DLOG_LEVEL >= 5
+#define DLOG_V(...) ::util::dlog::write(::util::dlog::Verbose, __VA_ARGS__)
+#else
+#define DLOG_V(...) do {} while (0)
+#endif
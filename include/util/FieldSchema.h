@@ -0,0 +1,202 @@
+#pragma once
+/**
+ * @file FieldSchema.h
+ * @brief constexpr field descriptors for a plain struct, and the encoders /
+ *        change detection generated from a tuple of them.
+ *
+ * - One Field per struct member: JSON key, CBOR key, change bit, member
+ *   pointer, deadband, quantum and packed-record slot. The tuple of fields
+ *   is the single list a snapshot type's serializers are built from.
+ * - Every loop is a fold over a constexpr tuple, so each access is a direct
+ *   member load: no function pointers, no virtual calls, no runtime table.
+ * - Value types plug in through Codec<T> (bool, unsigned integers and
+ *   util::Angle here). A new member needs one Field line; a new value type
+ *   needs one Codec.
+ * - A field with flag 0 is always written (e.g. the timestamp) and never
+ *   reported as a change.
+ *
+ * Usage:
+ *   struct S { uint32_t t; uint16_t mm; };
+ *   constexpr auto kFields = std::make_tuple(
+ *       util::schema::field(JSON_KEY("t"),  0, 0, &S::t,  0, 1, 0),
+ *       util::schema::field(JSON_KEY("mm"), 1, 1, &S::mm, 2, 1, 4));
+ *   static const auto db = util::schema::deadbands(kFields);
+ *   util::schema::changeMask(kFields, now, last, db);   // bit 1 if |mm delta| > 2
+ *   util::schema::writeJson(kFields, w, now, mask);
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "util/Angle.h"
+#include "util/CborWriter.h"
+#include "util/JsonWriter.h"
+
+namespace util {
+namespace schema {
+
+/** packAt value for a field left out of the packed record. */
+constexpr uint8_t kNotPacked = 0xFF;
+
+// ---------------------------------------------------------------------------
+// Codecs: compare, quantize and encode one value type
+// ---------------------------------------------------------------------------
+template <typename T, typename = void>
+struct Codec;
+
+template <>
+struct Codec<bool> {
+  static constexpr std::size_t kPackedBytes = 0;   // one bit at packBit
+  static constexpr std::size_t kCborMax     = 1;
+  static constexpr uint32_t distance(bool a, bool b) { return a != b; }
+  static constexpr int32_t  quantize(bool v, uint16_t) { return v; }
+  static constexpr uint32_t raw(bool v) { return v; }
+  static void json(JsonWriter& w, bool v) { w.flag(v); }
+  static void cbor(CborWriter& c, bool v) { c.boolean(v); }
+};
+
+template <typename T>
+struct Codec<T, std::enable_if_t<std::is_integral<T>::value && std::is_unsigned<T>::value &&
+                                 !std::is_same<T, bool>::value>> {
+  static_assert(sizeof(T) == 2 || sizeof(T) == 4, "Codec: 16- or 32-bit integers");
+  static constexpr std::size_t kPackedBytes = sizeof(T);
+  static constexpr std::size_t kCborMax     = 1 + sizeof(T);
+  static constexpr uint32_t distance(T a, T b) { return a > b ? a - b : b - a; }
+  static constexpr int32_t  quantize(T v, uint16_t q) { return static_cast<int32_t>(v / q); }
+  static constexpr uint32_t raw(T v) { return v; }
+  static void json(JsonWriter& w, T v) { w.u32(v); }
+  static void cbor(CborWriter& c, T v) { c.uint(v); }
+};
+
+/** Angles travel as centi-degrees; distance is the shortest rotation. */
+template <>
+struct Codec<Angle> {
+  static constexpr std::size_t kPackedBytes = 2;
+  static constexpr std::size_t kCborMax     = 3;
+  static constexpr uint32_t distance(Angle a, Angle b) { return a.distanceTo(b); }
+  /** Rounded half-up and wrapped, like Angle::deg() for q = 100. */
+  static constexpr int32_t quantize(Angle v, uint16_t q) {
+    return static_cast<int32_t>(((v.cdeg() + q / 2) / q) % (Angle::kFull / q));
+  }
+  static constexpr uint32_t raw(Angle v) { return v.cdeg(); }
+  static void json(JsonWriter& w, Angle v) { w.fixed(v.cdeg(), 2); }
+  static void cbor(CborWriter& c, Angle v) { c.uint(v.cdeg()); }
+};
+
+// ---------------------------------------------------------------------------
+// Field descriptor
+// ---------------------------------------------------------------------------
+template <typename S, typename T>
+struct Field {
+  using Owner = S;
+  using Value = T;
+  using Codec = schema::Codec<T>;
+
+  JsonKey  json;
+  uint8_t  wireKey;   // CBOR map key
+  uint32_t flag;      // change bit; 0 = always written, never a change
+  T S::*   member;
+  uint16_t deadband;  // changed only if the codec distance exceeds this
+  uint16_t quantum;   // views compare value / quantum (e.g. whole degrees)
+  uint8_t  packAt;    // byte offset in the packed record (kNotPacked: absent)
+  uint8_t  packBit;   // bools: bit within byte packAt
+
+  constexpr const T& get(const S& s) const { return s.*member; }
+  constexpr bool in(uint32_t mask) const { return flag == 0 || (mask & flag) != 0; }
+};
+
+template <typename S, typename T>
+constexpr Field<S, T> field(JsonKey json, uint8_t wireKey, uint32_t flag, T S::*member,
+                            uint16_t deadband, uint16_t quantum, uint8_t packAt,
+                            uint8_t packBit = 0) {
+  return Field<S, T>{json, wireKey, flag, member, deadband, quantum, packAt, packBit};
+}
+
+// ---------------------------------------------------------------------------
+// Generated operations over a tuple of fields
+// ---------------------------------------------------------------------------
+/** f(field, index) for every field, in order. */
+template <typename Tuple, typename Fn, std::size_t... I>
+constexpr void forEachIndexed_(const Tuple& t, Fn&& fn, std::index_sequence<I...>) {
+  (fn(std::get<I>(t), std::integral_constant<std::size_t, I>{}), ...);
+}
+template <typename... F, typename Fn>
+constexpr void forEach(const std::tuple<F...>& t, Fn&& fn) {
+  forEachIndexed_(t, fn, std::index_sequence_for<F...>{});
+}
+
+/** OR of every change bit. */
+template <typename... F>
+constexpr uint32_t allFlags(const std::tuple<F...>& t) {
+  return std::apply([](const auto&... f) { return (f.flag | ... | 0u); }, t);
+}
+
+/** Change bits of the fields that moved past their deadband (`deadband[i]` per field). */
+template <typename... F, typename S>
+inline uint32_t changeMask(const std::tuple<F...>& t, const S& now, const S& last,
+                           const std::array<uint16_t, sizeof...(F)>& deadband) {
+  uint32_t mask = 0;
+  forEach(t, [&](const auto& f, auto i) {
+    using C = typename std::decay_t<decltype(f)>::Codec;
+    if (f.flag && C::distance(f.get(now), f.get(last)) > deadband[i]) mask |= f.flag;
+  });
+  return mask;
+}
+
+/** The deadbands as declared, for initialising a runtime-tunable copy. */
+template <typename... F>
+constexpr std::array<uint16_t, sizeof...(F)> deadbands(const std::tuple<F...>& t) {
+  return std::apply([](const auto&... f) { return std::array<uint16_t, sizeof...(F)>{f.deadband...}; }, t);
+}
+
+/** Object members for the fields in `mask` (flag-0 fields always). */
+template <typename... F, typename S>
+inline void writeJson(const std::tuple<F...>& t, JsonWriter& w, const S& s, uint32_t mask) {
+  forEach(t, [&](const auto& f, auto) {
+    using C = typename std::decay_t<decltype(f)>::Codec;
+    if (f.in(mask)) C::json(w.key(f.json), f.get(s));
+  });
+}
+
+/** Largest CBOR map body the fields can produce (keys < 24 are one byte). */
+template <typename... F>
+constexpr std::size_t cborMaxBytes(const std::tuple<F...>&) {
+  return 1 + ((1 + F::Codec::kCborMax) + ... + 0);
+}
+
+/** CBOR map keyed by wireKey, holding the fields in `mask`. */
+template <typename... F, typename S>
+inline void writeCbor(const std::tuple<F...>& t, CborWriter& c, const S& s, uint32_t mask) {
+  c.map(std::apply([mask](const auto&... f) { return (std::size_t(f.in(mask)) + ... + 0); }, t));
+  forEach(t, [&](const auto& f, auto) {
+    using C = typename std::decay_t<decltype(f)>::Codec;
+    if (f.in(mask)) C::cbor(c.uint(f.wireKey), f.get(s));
+  });
+}
+
+/** Every packed field into `out` (little-endian); bools OR their bit in. */
+template <typename... F, typename S>
+inline void pack(const std::tuple<F...>& t, uint8_t* out, const S& s) {
+  forEach(t, [&](const auto& f, auto) {
+    using C = typename std::decay_t<decltype(f)>::Codec;
+    if (f.packAt == kNotPacked) return;
+    const uint32_t v = C::raw(f.get(s));
+    if constexpr (C::kPackedBytes == 0) {
+      if (v) out[f.packAt] |= static_cast<uint8_t>(1u << f.packBit);
+    } else {
+      uint8_t* p = out + f.packAt;
+      p[0] = static_cast<uint8_t>(v);
+      p[1] = static_cast<uint8_t>(v >> 8);
+      if constexpr (C::kPackedBytes == 4) {
+        p[2] = static_cast<uint8_t>(v >> 16);
+        p[3] = static_cast<uint8_t>(v >> 24);
+      }
+    }
+  });
+}
+
+} // namespace schema
+} // namespace util
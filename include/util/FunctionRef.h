@@ -0,0 +1,86 @@
+#pragma once
+/**
+ * @file FunctionRef.h
+ * @brief Non-owning, allocation-free reference to a callable.
+ *
+ * - Two pointers wide; never copies or owns the target, so it never
+ *   allocates (std::function may, and owns what it wraps).
+ * - Binds free functions and captureless lambdas by value (as a function
+ *   pointer), and any other callable by reference: that object must outlive
+ *   the FunctionRef. Temporaries with state are rejected at compile time.
+ * - Empty by default; test with operator bool before calling.
+ *
+ * Usage:
+ *   void onMsg(const char* t, const uint8_t* p, size_t n);
+ *   util::FunctionRef<void(const char*, const uint8_t*, size_t)> cb = &onMsg;
+ *   if (cb) cb(topic, payload, len);
+ *
+ *   Dispatcher d;                                   // has operator()(...)
+ *   cb = d;                                         // d must stay alive
+ */
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace util {
+
+template <typename Signature>
+class FunctionRef;
+
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+public:
+  using FnPtr = R (*)(Args...);
+
+  constexpr FunctionRef() = default;
+  constexpr FunctionRef(std::nullptr_t) {}
+
+  /** Free function (or nullptr). */
+  FunctionRef(FnPtr fn) : thunk_(fn ? &callFn_ : nullptr) { target_.fn = fn; }
+
+  /** Captureless lambda, temporary or not: kept as its function pointer. */
+  template <typename F,
+            typename D = std::decay_t<F>,
+            std::enable_if_t<!std::is_same<D, FunctionRef>::value &&
+                             std::is_convertible<D, FnPtr>::value, int> = 0>
+  FunctionRef(F&& f) : FunctionRef(static_cast<FnPtr>(f)) {}
+
+  /** Any other callable, by reference: `f` must outlive this FunctionRef. */
+  template <typename F,
+            std::enable_if_t<!std::is_same<std::remove_const_t<F>, FunctionRef>::value &&
+                             !std::is_convertible<F, FnPtr>::value, int> = 0>
+  FunctionRef(F& f) : thunk_(&callObj_<F>) { target_.obj = const_cast<void*>(static_cast<const void*>(&f)); }
+
+  /** Stateful temporaries would dangle. */
+  template <typename F,
+            std::enable_if_t<!std::is_lvalue_reference<F>::value &&
+                             !std::is_same<std::decay_t<F>, FunctionRef>::value &&
+                             !std::is_convertible<std::decay_t<F>, FnPtr>::value, int> = 0>
+  FunctionRef(F&&) = delete;
+
+  explicit operator bool() const { return thunk_ != nullptr; }
+
+  R operator()(Args... args) const { return thunk_(*this, std::forward<Args>(args)...); }
+
+private:
+  using Thunk = R (*)(const FunctionRef&, Args...);
+
+  static R callFn_(const FunctionRef& self, Args... args) {
+    return self.target_.fn(std::forward<Args>(args)...);
+  }
+
+  template <typename F>
+  static R callObj_(const FunctionRef& self, Args... args) {
+    return (*static_cast<F*>(self.target_.obj))(std::forward<Args>(args)...);
+  }
+
+  union Target {
+    void* obj;
+    FnPtr fn;
+  };
+  Target target_{nullptr};   // which member is live: thunk_ knows
+  Thunk  thunk_ = nullptr;
+};
+
+} // namespace util
@@ -0,0 +1,194 @@
+#pragma once
+/**
+ * @file JsonWriter.h
+ * @brief Streaming, allocation-free JSON writer over a util::ByteSink.
+ *
+ * - Commas are tracked per nesting level (up to 32), so callers only say
+ *   what to write, never where separators go.
+ * - Keys are precomputed fragments: JSON_KEY("ang") is the literal ",\"ang\":"
+ *   with its length; separator and key are one memcpy, no runtime escaping.
+ * - Numbers use util::fmt raw writers (no printf, no float): integers, and
+ *   fixed-point values given as scaled integers.
+ * - Tokens are assembled in a 64-byte internal buffer and handed to the sink
+ *   in chunks: a streaming sink (MQTT packet, socket) sees a few writes per
+ *   message instead of one per token. The buffer is flushed when the
+ *   top-level value closes, by flush(), and on destruction.
+ * - Sticky failure: once the sink rejects a write, everything after is
+ *   skipped and ok() stays false.
+ *
+ * Usage:
+ *   static constexpr util::JsonKey kAng = JSON_KEY("ang");
+ *   util::JsonWriter w(sink);
+ *   w.beginObject().key(kAng).fixed(cdeg, 2).endObject();
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "util/ByteSink.h"
+#include "util/TextFormat.h"
+
+namespace util {
+
+struct JsonKey {
+  const char* text;   // ",\"name\":" (leading comma skipped for the first member)
+  uint8_t     len;
+};
+
+} // namespace util
+
+/** Compile-time key fragment for a plain (escape-free) literal key. */
+#define JSON_KEY(name) ::util::JsonKey{ ",\"" name "\":", sizeof(",\"" name "\":") - 1 }
+
+namespace util {
+
+class JsonWriter {
+public:
+  explicit JsonWriter(ByteSink& out) : out_(out) {}
+  ~JsonWriter() { flush(); }
+  JsonWriter(const JsonWriter&) = delete;
+  JsonWriter& operator=(const JsonWriter&) = delete;
+
+  JsonWriter& beginObject() { value_(); open_('{'); return *this; }
+  JsonWriter& endObject()   { close_('}'); return *this; }
+  JsonWriter& beginArray()  { value_(); open_('['); return *this; }
+  JsonWriter& endArray()    { close_(']'); return *this; }
+
+  /** Member key; the next value call completes the member. */
+  JsonWriter& key(const JsonKey& k) {
+    if (markFirst_()) raw_(k.text + 1, k.len - 1u);
+    else              raw_(k.text, k.len);
+    afterKey_ = true;
+    return *this;
+  }
+
+  /** Runtime key (escaped). Prefer JSON_KEY on hot paths. */
+  JsonWriter& key(const char* k) {
+    if (!markFirst_()) ch_(',');
+    quoted_(k);
+    ch_(':');
+    afterKey_ = true;
+    return *this;
+  }
+
+  JsonWriter& u32(uint32_t v) {
+    value_();
+    if (room_(10)) len_ += fmt::u32To(buf_ + len_, v);
+    return *this;
+  }
+  JsonWriter& i32(int32_t v) {
+    value_();
+    if (room_(11)) len_ += fmt::i32To(buf_ + len_, v);
+    return *this;
+  }
+  JsonWriter& fixed(int32_t v, uint8_t decimals) {
+    value_();
+    if (room_(22)) len_ += fmt::fixedTo(buf_ + len_, v, decimals);
+    return *this;
+  }
+  JsonWriter& boolean(bool b) { value_(); b ? raw_("true", 4) : raw_("false", 5); return *this; }
+  /** Boolean as 0/1 (compact payloads consumed as numbers). */
+  JsonWriter& flag(bool b)    { value_(); ch_(b ? '1' : '0'); return *this; }
+  JsonWriter& string(const char* s) { value_(); quoted_(s); return *this; }
+  JsonWriter& null()          { value_(); raw_("null", 4); return *this; }
+
+  /** Hand buffered bytes to the sink (also done when the top-level value closes). */
+  bool flush() {
+    if (ok_ && len_) ok_ = out_.put(buf_, len_);
+    len_ = 0;
+    return ok_;
+  }
+
+  /** True if everything reached the sink and all containers are closed. */
+  bool ok() const { return ok_ && len_ == 0 && depth_ == 0; }
+  bool failed() const { return !ok_; }
+
+private:
+  static constexpr std::size_t kCap      = 64;
+  static constexpr uint8_t     kMaxDepth = 32;
+
+  // Ensure n contiguous bytes in buf_ (n <= kCap)
+  bool room_(std::size_t n) {
+    if (!ok_) return false;
+    if (kCap - len_ < n) flush();
+    return ok_;
+  }
+
+  void raw_(const char* p, std::size_t n) {
+    if (!ok_) return;
+    if (kCap - len_ < n) {
+      flush();
+      if (n > kCap) { ok_ = ok_ && out_.put(p, n); return; }
+    }
+    std::memcpy(buf_ + len_, p, n);
+    len_ += n;
+  }
+
+  void ch_(char c) {
+    if (room_(1)) buf_[len_++] = c;
+  }
+
+  // True if this is the first element at the current level (or top level)
+  bool markFirst_() {
+    if (!depth_) return true;
+    const uint32_t bit = 1u << (depth_ - 1);
+    const bool first = !(nonEmpty_ & bit);
+    nonEmpty_ |= bit;
+    return first;
+  }
+
+  void value_() {
+    if (afterKey_) { afterKey_ = false; return; }
+    if (!markFirst_()) ch_(',');
+  }
+
+  void open_(char c) {
+    if (depth_ >= kMaxDepth) { ok_ = false; return; }
+    ch_(c);
+    ++depth_;
+    nonEmpty_ &= ~(1u << (depth_ - 1));
+  }
+
+  void close_(char c) {
+    if (depth_ == 0) { ok_ = false; return; }
+    ch_(c);
+    if (--depth_ == 0) flush();
+  }
+
+  void quoted_(const char* s) {
+    if (!s) s = "";
+    ch_('"');
+    const char* run = s;
+    for (; *s; ++s) {
+      const unsigned char c = static_cast<unsigned char>(*s);
+      if (c >= 0x20 && c != '"' && c != '\\') continue;
+      raw_(run, static_cast<std::size_t>(s - run));
+      run = s + 1;
+      switch (c) {
+        case '"':  raw_("\\\"", 2); break;
+        case '\\': raw_("\\\\", 2); break;
+        case '\n': raw_("\\n", 2);  break;
+        case '\r': raw_("\\r", 2);  break;
+        case '\t': raw_("\\t", 2);  break;
+        default: {
+          static constexpr char kHex[] = "0123456789ABCDEF";
+          const char esc[6] = { '\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF] };
+          raw_(esc, sizeof(esc));
+          break;
+        }
+      }
+    }
+    raw_(run, static_cast<std::size_t>(s - run));
+    ch_('"');
+  }
+
+  ByteSink&   out_;
+  char        buf_[kCap];
+  std::size_t len_      = 0;
+  uint32_t    nonEmpty_ = 0;    // bit d-1: level d already has an element
+  uint8_t     depth_    = 0;
+  bool        afterKey_ = false;
+  bool        ok_       = true;
+};
+
+} // namespace util
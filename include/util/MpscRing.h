@@ -0,0 +1,97 @@
+#pragma once
+/**
+ * @file MpscRing.h
+ * @brief Lock-free multi-producer / single-consumer bounded ring buffer.
+ *
+ * - No Arduino deps, no heap: storage is an in-object array.
+ * - Any number of tasks (or an ISR) may push(); producers claim a cell with
+ *   one compare-exchange on the head and publish it through the cell's
+ *   sequence number, so a producer never waits on another producer or on
+ *   the consumer.
+ * - Exactly one context may pop(). A cell that is claimed but not yet
+ *   written ends the pop() until its producer finishes.
+ * - A full ring rejects the new element and counts it in dropped().
+ *
+ * Usage:
+ *   static util::MpscRing<Record, 64> ring;
+ *   ring.push(r);            // any task / ISR
+ *   while (ring.pop(r)) {}   // one consumer task
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace util {
+
+template <typename T, std::size_t N>
+class MpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscRing capacity must be a power of two");
+
+public:
+  static constexpr std::size_t kCapacity = N;
+
+  MpscRing() {
+    for (uint32_t i = 0; i < N; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  MpscRing(const MpscRing&) = delete;
+  MpscRing& operator=(const MpscRing&) = delete;
+
+  /** Any producer. Returns false (and counts a drop) if the ring is full. */
+  bool push(const T& v) {
+    uint32_t pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& c = cells_[pos & kMask];
+      const uint32_t seq = c.seq.load(std::memory_order_acquire);
+      const int32_t dif = static_cast<int32_t>(seq - pos);
+      if (dif == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          c.value = v;
+          c.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (dif < 0) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /** Consumer side. Returns false if the ring is empty. */
+  bool pop(T& out) {
+    const uint32_t pos = tail_.load(std::memory_order_relaxed);
+    Cell& c = cells_[pos & kMask];
+    if (c.seq.load(std::memory_order_acquire) != pos + 1) return false;
+    out = c.value;
+    c.seq.store(pos + N, std::memory_order_release);
+    tail_.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Approximate: claimed cells count even before their producer finishes.
+  std::size_t size() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+
+  /** Number of pushes rejected because the ring was full. */
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+  static constexpr uint32_t kMask = static_cast<uint32_t>(N - 1);
+
+  struct Cell {
+    std::atomic<uint32_t> seq{0};   // == position: free; position + 1: written
+    T                     value{};
+  };
+
+  Cell                  cells_[N];
+  std::atomic<uint32_t> head_{0};    // next position to claim (producers)
+  std::atomic<uint32_t> tail_{0};    // written by consumer only
+  std::atomic<uint32_t> dropped_{0};
+};
+
+} // namespace util
@@ -0,0 +1,234 @@
+#pragma once
+/**
+ * @file Profiler.h
+ * @brief Scoped cycle-counter timers with static min/max/mean + log2 histograms.
+ *
+ * - Enabled with -DPROF_ENABLED=1; otherwise every PROF_* macro expands to
+ *   nothing and no Stage objects exist.
+ * - PROF_SCOPE("name") times the rest of the enclosing block. Each call site
+ *   owns one function-local Stage, linked into a global list on first use,
+ *   so header-only code (inline functions) can be profiled too.
+ * - ESP32: Xtensa CCOUNT (esp_cpu_get_cycle_count / esp_cpu_get_ccount);
+ *   host: steady_clock nanoseconds. Durations are converted to µs only when
+ *   the summary is written.
+ * - A stage is expected to be recorded from one task at a time; summaries
+ *   read it unlocked (diagnostic figures, a torn sample is harmless).
+ *
+ * Usage:
+ *   void sample() { PROF_SCOPE("sensor.als"); als.update(); }
+ *   ...
+ *   util::prof::Report r; r.capture();   // snapshot + reset all stages
+ *   mqtt::publishStreamed(client, topic, [&](util::ByteSink& s){ return r.writeJson(s); });
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include "util/ByteSink.h"
+#include "util/JsonWriter.h"
+
+#ifndef PROF_ENABLED
+#define PROF_ENABLED 0
+#endif
+
+#if PROF_ENABLED
+  #include <atomic>
+  #if defined(ESP_PLATFORM)
+    #include <esp_idf_version.h>
+    #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+      #include <esp_cpu.h>
+    #else
+      #include <soc/cpu.h>
+    #endif
+    #if defined(ARDUINO)
+      #include <Arduino.h>   // getCpuFrequencyMhz()
+    #endif
+  #else
+    #include <chrono>
+  #endif
+#endif
+
+namespace util {
+namespace prof {
+
+/** log2 µs buckets: [0,1) [1,2) [2,4) ... [8192,16384) [16384,inf). */
+constexpr std::size_t kBuckets   = 16;
+/** Most stages a Report can hold; later stages are left out of the summary. */
+constexpr std::size_t kMaxStages = 16;
+
+#if PROF_ENABLED
+
+inline uint32_t now() {
+#if defined(ESP_PLATFORM)
+  #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  return static_cast<uint32_t>(esp_cpu_get_cycle_count());
+  #else
+  return static_cast<uint32_t>(esp_cpu_get_ccount());
+  #endif
+#else
+  using namespace std::chrono;
+  return static_cast<uint32_t>(
+      duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/** Counter ticks per µs (CPU MHz on target, 1000 on host). */
+inline uint32_t ticksPerUs() {
+#if defined(ESP_PLATFORM) && defined(ARDUINO)
+  return getCpuFrequencyMhz();
+#elif defined(ESP_PLATFORM)
+  return 240;
+#else
+  return 1000;
+#endif
+}
+
+struct Stats {
+  uint32_t count  = 0;
+  uint32_t minT   = 0xFFFFFFFFu;   // ticks
+  uint32_t maxT   = 0;
+  uint64_t sumT   = 0;
+  uint16_t hist[kBuckets] = {};
+};
+
+class Stage {
+public:
+  // Lock-free push: call sites on different tasks may register concurrently
+  explicit Stage(const char* name) : name_(name), next_(head().load(std::memory_order_relaxed)) {
+    while (!head().compare_exchange_weak(next_, this, std::memory_order_release,
+                                         std::memory_order_relaxed)) {}
+  }
+
+  void record(uint32_t ticks) {
+    Stats& s = stats_;
+    ++s.count;
+    if (ticks < s.minT) s.minT = ticks;
+    if (ticks > s.maxT) s.maxT = ticks;
+    s.sumT += ticks;
+    std::size_t b = bucketFor(ticks / ticksPerUs_());
+    if (s.hist[b] != 0xFFFF) ++s.hist[b];
+  }
+
+  const char* name() const { return name_; }
+  Stage* next() const { return next_; }
+
+  /** Copy the stats out and start a new window. */
+  Stats take() {
+    Stats s = stats_;
+    stats_ = Stats{};
+    return s;
+  }
+
+  static std::atomic<Stage*>& head() {
+    static std::atomic<Stage*> h{nullptr};
+    return h;
+  }
+
+  static std::size_t bucketFor(uint32_t us) {
+    std::size_t b = 0;
+    while (us && b < kBuckets - 1) { us >>= 1; ++b; }
+    return b;
+  }
+
+private:
+  // Cached: getCpuFrequencyMhz() is not free and the clock is fixed at runtime
+  static uint32_t ticksPerUs_() {
+    static const uint32_t t = ticksPerUs();
+    return t;
+  }
+
+  const char* name_;
+  Stage*      next_;
+  Stats       stats_;
+};
+
+/** RAII timer; records into its Stage on destruction. */
+class Scope {
+public:
+  explicit Scope(Stage& s) : s_(s), t0_(now()) {}
+  ~Scope() { s_.record(now() - t0_); }
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+private:
+  Stage&   s_;
+  uint32_t t0_;
+};
+
+#endif // PROF_ENABLED
+
+/**
+ * Snapshot of every stage (µs), for a periodic summary.
+ * Capturing resets the stages, so each report covers one interval.
+ * writeJson() is deterministic, so it can feed a measured streaming publish.
+ */
+class Report {
+public:
+  void capture() {
+    count_ = 0;
+#if PROF_ENABLED
+    for (Stage* st = Stage::head().load(std::memory_order_acquire);
+         st && count_ < kMaxStages; st = st->next()) {
+      names_[count_] = st->name();
+      stats_[count_] = st->take();
+      ++count_;
+    }
+    tpu_ = ticksPerUs();
+#endif
+  }
+
+  std::size_t size() const { return count_; }
+
+  /**
+   * {"<stage>":{"n":120,"min":12,"avg":25,"max":340,"h":[0,0,3,...]},...}
+   * Times in µs; "h" counts per log2 µs bucket. Returns false when empty.
+   */
+  bool writeJson(util::ByteSink& out) const {
+#if PROF_ENABLED
+    if (count_ == 0) return false;
+    util::JsonWriter w(out);
+    w.beginObject();
+    for (std::size_t i = 0; i < count_ && !w.failed(); ++i) {
+      const Stats& s = stats_[i];
+      w.key(names_[i]).beginObject()
+         .key(JSON_KEY("n")).u32(s.count)
+         .key(JSON_KEY("min")).u32(s.count ? s.minT / tpu_ : 0)
+         .key(JSON_KEY("avg")).u32(s.count ? static_cast<uint32_t>(s.sumT / s.count / tpu_) : 0)
+         .key(JSON_KEY("max")).u32(s.maxT / tpu_)
+         .key(JSON_KEY("h")).beginArray();
+      // Trailing empty buckets are implied
+      std::size_t last = kBuckets;
+      while (last > 0 && s.hist[last - 1] == 0) --last;
+      for (std::size_t b = 0; b < last; ++b) w.u32(s.hist[b]);
+      w.endArray().endObject();
+    }
+    w.endObject();
+    return w.ok();
+#else
+    (void)out;
+    return false;
+#endif
+  }
+
+private:
+  std::size_t count_ = 0;
+#if PROF_ENABLED
+  const char* names_[kMaxStages] = {};
+  Stats       stats_[kMaxStages];
+  uint32_t    tpu_ = 1;
+#endif
+};
+
+} // namespace prof
+} // namespace util
+
+#define PROF_CAT2_(a, b) a##b
+#define PROF_CAT_(a, b)  PROF_CAT2_(a, b)
+
+#if PROF_ENABLED
+/** Time the rest of the enclosing block under `name` (a string literal). */
+#define PROF_SCOPE(name)                                                     \
+  static ::util::prof::Stage PROF_CAT_(profStage_, __LINE__){name};          \
+  ::util::prof::Scope PROF_CAT_(profScope_, __LINE__){PROF_CAT_(profStage_, __LINE__)}
+#else
+#define PROF_SCOPE(name) do {} while (0)
+#endif
@@ -0,0 +1,188 @@
+#pragma once
+/**
+ * @file PublishGovernor.h
+ * @brief Per-topic publish policy: deadband, minimum interval and a token
+ *        bucket, plus a final "settled" value once the input stops moving.
+ *
+ * - offer() on every new value; true means publish value() now. A value
+ *   goes out only if it moved past the deadband from the last one sent, the
+ *   minimum interval has passed, and the bucket holds a token.
+ * - poll() from the publishing loop sends what offer() held back: the
+ *   newest value as soon as the limits allow, and, settleMs after the last
+ *   change, the exact final value even if it is within the deadband or the
+ *   bucket is empty. A swing so ends on where the input actually stopped.
+ * - Times are taken as monotonic: one older than the last call counts as
+ *   that call's time.
+ * - Values are integers; a non-zero modulus makes them wrap (360 for whole
+ *   degrees), so deadbands measure the shortest way round.
+ * - No Arduino deps, no heap. Not thread-safe: one publishing task.
+ *
+ * Usage:
+ *   util::PublishGovernor hor(360);
+ *   hor.setLimits({1, 50, 20, 10, 150});   // deadband, interval, rate, burst, settle
+ *   if (hor.offer(deg, millis())) publish(hor.value());
+ *   if (hor.poll(millis()))       publish(hor.value());
+ */
+
+#include <cstdint>
+#include <cstring>
+#include "util/JsonWriter.h"
+
+namespace util {
+
+struct GovernorLimits {
+  uint16_t deadband      = 0;   // a change must exceed this (value units)
+  uint16_t minIntervalMs = 0;   // between any two publishes
+  uint16_t ratePerSec    = 0;   // token refill; 0 = no rate limit
+  uint16_t burst         = 1;   // bucket depth: publishes allowed back to back
+  uint16_t settleMs      = 0;   // quiet this long -> exact final value; 0 = off
+};
+
+/**
+ * Set one limit by name ("deadband", "interval", "rate", "burst", "settle").
+ * False for an unknown name. Values are clamped to the field's range.
+ */
+inline bool setGovernorLimit(GovernorLimits& l, const char* name, uint32_t v) {
+  const uint16_t c = v > 0xFFFFu ? 0xFFFFu : static_cast<uint16_t>(v);
+  if      (std::strcmp(name, "deadband") == 0) l.deadband = c;
+  else if (std::strcmp(name, "interval") == 0) l.minIntervalMs = c;
+  else if (std::strcmp(name, "rate") == 0)     l.ratePerSec = c;
+  else if (std::strcmp(name, "burst") == 0)    l.burst = c ? c : 1;
+  else if (std::strcmp(name, "settle") == 0)   l.settleMs = c;
+  else return false;
+  return true;
+}
+
+/** {"deadband":1,"interval":50,"rate":20,"burst":10,"settle":150}, same names as setGovernorLimit. */
+inline void writeGovernorLimits(JsonWriter& w, const GovernorLimits& l) {
+  w.beginObject()
+   .key(JSON_KEY("deadband")).u32(l.deadband)
+   .key(JSON_KEY("interval")).u32(l.minIntervalMs)
+   .key(JSON_KEY("rate")).u32(l.ratePerSec)
+   .key(JSON_KEY("burst")).u32(l.burst)
+   .key(JSON_KEY("settle")).u32(l.settleMs)
+   .endObject();
+}
+
+class PublishGovernor {
+public:
+  explicit PublishGovernor(uint32_t modulus = 0) : modulus_(modulus) {}
+
+  /** New limits apply from the next offer()/poll(); the bucket starts full. */
+  void setLimits(const GovernorLimits& l) {
+    limits_ = l;
+    if (limits_.burst == 0) limits_.burst = 1;
+    tokens_ = capacity_();
+  }
+  const GovernorLimits& limits() const { return limits_; }
+
+  /** The next offer() publishes whatever it gets (e.g. a new session). */
+  void reset() { sentAny_ = false; }
+
+  /** A new input value. True: publish value() now. */
+  bool offer(int32_t v, uint32_t nowMs) {
+    nowMs = clock_(nowMs);
+    refill_(nowMs);
+    if (v != latest_ || !seen_) {
+      latest_ = v;
+      changedMs_ = nowMs;
+      seen_ = true;
+    }
+    if (!sentAny_) return send_(nowMs);
+    if (!movedPastDeadband_() || !intervalOk_(nowMs) || !hasToken_()) {
+      if (latest_ != sent_) ++held_;
+      return false;
+    }
+    return send_(nowMs);
+  }
+
+  /** Held-back value due? True: publish value() now. */
+  bool poll(uint32_t nowMs) {
+    nowMs = clock_(nowMs);
+    if (!seen_ || (sentAny_ && latest_ == sent_)) return false;
+    refill_(nowMs);
+    if (!intervalOk_(nowMs)) return false;
+    if (!sentAny_ || (movedPastDeadband_() && hasToken_())) return send_(nowMs);
+    if (limits_.settleMs && nowMs - changedMs_ >= limits_.settleMs) {
+      ++settled_;
+      return send_(nowMs);   // settles even with an empty bucket
+    }
+    return false;
+  }
+
+  /** Last value handed out by offer()/poll(). */
+  int32_t value() const { return sent_; }
+
+  uint32_t published() const { return published_; }
+  uint32_t held() const { return held_; }         // offers not sent at once
+  uint32_t settled() const { return settled_; }   // final values sent by poll()
+
+private:
+  static constexpr uint32_t kMilli = 1000;   // tokens kept in thousandths
+
+  uint32_t capacity_() const { return uint32_t(limits_.burst) * kMilli; }
+
+  uint32_t distance_(int32_t a, int32_t b) const {
+    int32_t d = a - b;
+    if (modulus_) {
+      const int32_t m = static_cast<int32_t>(modulus_);
+      d %= m;
+      if (d < 0) d += m;
+      if (d > m / 2) d = m - d;
+    }
+    return static_cast<uint32_t>(d < 0 ? -d : d);
+  }
+
+  // Time never runs backwards here: a stamp older than the last call (a
+  // sample time after a millis() poll) would otherwise underflow the refill
+  // and interval checks into "long ago"
+  uint32_t clock_(uint32_t nowMs) {
+    if (!clocked_ || int32_t(nowMs - lastMs_) > 0) {
+      lastMs_ = nowMs;
+      clocked_ = true;
+    }
+    return lastMs_;
+  }
+
+  bool movedPastDeadband_() const { return distance_(latest_, sent_) > limits_.deadband; }
+  bool intervalOk_(uint32_t nowMs) const {
+    return !sentAny_ || nowMs - sentMs_ >= limits_.minIntervalMs;
+  }
+  bool hasToken_() const { return limits_.ratePerSec == 0 || tokens_ >= kMilli; }
+
+  void refill_(uint32_t nowMs) {
+    const uint32_t dt = nowMs - refillMs_;
+    refillMs_ = nowMs;
+    if (limits_.ratePerSec == 0) return;
+    // rate/s over dt ms = rate * dt thousandths
+    const uint64_t t = uint64_t(tokens_) + uint64_t(dt) * limits_.ratePerSec;
+    tokens_ = t >= capacity_() ? capacity_() : static_cast<uint32_t>(t);
+  }
+
+  bool send_(uint32_t nowMs) {
+    sent_ = latest_;
+    sentMs_ = nowMs;
+    sentAny_ = true;
+    tokens_ = tokens_ >= kMilli ? tokens_ - kMilli : 0;
+    ++published_;
+    return true;
+  }
+
+  GovernorLimits limits_{};
+  uint32_t modulus_   = 0;
+  int32_t  latest_    = 0;
+  int32_t  sent_      = 0;
+  uint32_t changedMs_ = 0;   // when latest_ last changed
+  uint32_t sentMs_    = 0;
+  uint32_t refillMs_  = 0;
+  uint32_t lastMs_    = 0;   // newest time seen by offer()/poll()
+  bool     clocked_   = false;
+  uint32_t tokens_    = kMilli;
+  bool     seen_      = false;
+  bool     sentAny_   = false;
+  uint32_t published_ = 0;
+  uint32_t held_      = 0;
+  uint32_t settled_   = 0;
+};
+
+} // namespace util
@@ -0,0 +1,79 @@
+#pragma once
+/**
+ * @file SpscRing.h
+ * @brief Lock-free single-producer / single-consumer ring buffer.
+ *
+ * - No Arduino deps, no heap: storage is an in-object array.
+ * - Exactly one context may push() and exactly one may pop(); each side only
+ *   writes its own index, so neither ever blocks or spins on the other.
+ * - Safe to push from an ISR as long as the ISR is the only producer.
+ * - A full ring rejects the new element and counts it in dropped().
+ *
+ * Usage:
+ *   static util::SpscRing<Sample, 64> ring;
+ *   ring.push(s);            // producer task / ISR
+ *   while (ring.pop(s)) {}   // consumer task
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace util {
+
+template <typename T, std::size_t N>
+class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+  static constexpr std::size_t kCapacity = N;
+
+  /** Producer side. Returns false (and counts a drop) if the ring is full. */
+  bool push(const T& v) {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    const uint32_t tail = tail_.load(std::memory_order_acquire);
+    if (head - tail >= N) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    buf_[head & kMask] = v;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** Consumer side. Returns false if the ring is empty. */
+  bool pop(T& out) {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    const uint32_t head = head_.load(std::memory_order_acquire);
+    if (head == tail) return false;
+    out = buf_[tail & kMask];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** Consumer side: look at the oldest element without removing it. */
+  const T* peek() const {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    const uint32_t head = head_.load(std::memory_order_acquire);
+    return (head == tail) ? nullptr : &buf_[tail & kMask];
+  }
+
+  // Approximate when read from the "other" side; exact from either owner.
+  std::size_t size() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+
+  /** Number of pushes rejected because the ring was full. */
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+  static constexpr uint32_t kMask = static_cast<uint32_t>(N - 1);
+
+  T                     buf_[N]{};
+  std::atomic<uint32_t> head_{0};    // written by producer only
+  std::atomic<uint32_t> tail_{0};    // written by consumer only
+  std::atomic<uint32_t> dropped_{0}; // written by producer only
+};
+
+} // namespace util
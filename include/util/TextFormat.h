@@ -0,0 +1,155 @@
+#pragma once
+/**
+ * @file TextFormat.h
+ * @brief Allocation-free number/text formatting onto a util::ByteSink.
+ *
+ * - No printf: integers go out two digits per divide via a digit-pair table,
+ *   fixed-point values are scaled integers (1205 with 2 decimals -> "12.05").
+ * - Two layers: raw *To(char*) writers for callers that manage their own
+ *   buffer (JsonWriter), and ByteSink wrappers for everything else.
+ * - TextWriter chains appends and remembers the first failure, so a builder
+ *   can write a whole message and check ok() once.
+ *
+ * Usage:
+ *   util::BufferSink sink(buf, sizeof(buf));
+ *   util::TextWriter w(sink);
+ *   w.str("Found ").u32(n).str(" device(s) at 0x").hex(addr, 2);
+ *   if (!w.ok()) ...   // truncated
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include "util/ByteSink.h"
+
+namespace util {
+namespace fmt {
+
+namespace detail {
+// "00" "01" ... "99"
+inline constexpr char kDigitPairs[201] =
+  "00010203040506070809" "10111213141516171819" "20212223242526272829"
+  "30313233343536373839" "40414243444546474849" "50515253545556575859"
+  "60616263646566676869" "70717273747576777879" "80818283848586878889"
+  "90919293949596979899";
+
+inline constexpr uint32_t kPow10[10] = {
+  1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u
+};
+} // namespace detail
+
+/** Decimal digits of v, right-aligned into end[-n..-1]; returns n (1..10). */
+inline std::size_t u32Digits(char* end, uint32_t v) {
+  char* p = end;
+  while (v >= 100) {
+    const uint32_t q = v / 100;
+    const uint32_t r = (v - q * 100) * 2;
+    *--p = detail::kDigitPairs[r + 1];
+    *--p = detail::kDigitPairs[r];
+    v = q;
+  }
+  if (v >= 10) {
+    *--p = detail::kDigitPairs[v * 2 + 1];
+    *--p = detail::kDigitPairs[v * 2];
+  } else {
+    *--p = char('0' + v);
+  }
+  return static_cast<std::size_t>(end - p);
+}
+
+/** Number of decimal digits in v (1..10). */
+inline std::size_t u32Len(uint32_t v) {
+  std::size_t n = 1;
+  while (v >= 100) { v /= 100; n += 2; }
+  return n + (v >= 10);
+}
+
+// Raw writers: format into out[], which must have room (u32: 10, i32: 11,
+// fixed: 22 bytes). Return the number of chars written. No NUL.
+inline std::size_t u32To(char* out, uint32_t v) {
+  const std::size_t n = u32Len(v);
+  u32Digits(out + n, v);
+  return n;
+}
+
+inline std::size_t i32To(char* out, int32_t v) {
+  if (v >= 0) return u32To(out, static_cast<uint32_t>(v));
+  *out = '-';
+  return 1 + u32To(out + 1, 0u - static_cast<uint32_t>(v));
+}
+
+/** Scaled integer as a fixed-point decimal: fixedTo(p, -1205, 2) -> "-12.05". */
+inline std::size_t fixedTo(char* out, int32_t scaled, uint8_t decimals) {
+  if (decimals == 0) return i32To(out, scaled);
+  if (decimals > 9) decimals = 9;
+  const uint32_t mag = scaled < 0 ? 0u - static_cast<uint32_t>(scaled) : static_cast<uint32_t>(scaled);
+  // Constant divisors for the common scales (centi-degrees, 0.1 units)
+  uint32_t whole, frac;
+  switch (decimals) {
+    case 1:  whole = mag / 10;  frac = mag % 10;  break;
+    case 2:  whole = mag / 100; frac = mag % 100; break;
+    default: whole = mag / detail::kPow10[decimals]; frac = mag % detail::kPow10[decimals]; break;
+  }
+
+  std::size_t n = (scaled < 0);
+  if (n) out[0] = '-';
+  n += u32To(out + n, whole);
+  out[n++] = '.';
+  char* end = out + n + decimals;
+  char* p = end - u32Digits(end, frac);
+  while (p > out + n) *--p = '0';
+  return n + decimals;
+}
+
+inline bool u32(ByteSink& out, uint32_t v) {
+  char buf[10];
+  const std::size_t n = u32Digits(buf + sizeof(buf), v);
+  return out.put(buf + sizeof(buf) - n, n);
+}
+
+inline bool i32(ByteSink& out, int32_t v) {
+  if (v < 0) {
+    return out.put('-') && u32(out, 0u - static_cast<uint32_t>(v));
+  }
+  return u32(out, static_cast<uint32_t>(v));
+}
+
+/** Scaled integer as a fixed-point decimal: fixed(out, -1205, 2) -> "-12.05". */
+inline bool fixed(ByteSink& out, int32_t scaled, uint8_t decimals) {
+  char buf[22];
+  return out.put(buf, fixedTo(buf, scaled, decimals));
+}
+
+/** Upper-case hex, zero-padded to at least `minDigits` (max 8). */
+inline bool hex(ByteSink& out, uint32_t v, uint8_t minDigits = 1) {
+  static constexpr char kHex[] = "0123456789ABCDEF";
+  char buf[8];
+  std::size_t n = 0;
+  do { buf[7 - n++] = kHex[v & 0xF]; v >>= 4; } while (v && n < 8);
+  while (n < minDigits && n < 8) buf[7 - n++] = '0';
+  return out.put(buf + 8 - n, n);
+}
+
+} // namespace fmt
+
+/** Fluent, sticky-failure text builder over a ByteSink. */
+class TextWriter {
+public:
+  explicit TextWriter(ByteSink& out) : out_(out) {}
+
+  TextWriter& str(const char* s)                 { ok_ = ok_ && s && out_.put(s); return *this; }
+  TextWriter& str(const char* s, std::size_t n)  { ok_ = ok_ && out_.put(s, n); return *this; }
+  TextWriter& ch(char c)                         { ok_ = ok_ && out_.put(c); return *this; }
+  TextWriter& u32(uint32_t v)                    { ok_ = ok_ && fmt::u32(out_, v); return *this; }
+  TextWriter& i32(int32_t v)                     { ok_ = ok_ && fmt::i32(out_, v); return *this; }
+  TextWriter& fixed(int32_t v, uint8_t dec)      { ok_ = ok_ && fmt::fixed(out_, v, dec); return *this; }
+  TextWriter& hex(uint32_t v, uint8_t digits = 1){ ok_ = ok_ && fmt::hex(out_, v, digits); return *this; }
+
+  bool ok() const { return ok_; }
+  ByteSink& sink() { return out_; }
+
+private:
+  ByteSink& out_;
+  bool      ok_ = true;
+};
+
+} // namespace util
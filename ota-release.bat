@@ -0,0 +1,79 @@
+@echo off
+echo ==========================================
+echo Fleet OTA Release for ESP32 Cannons
+echo ==========================================
+echo.
+REM Usage: ota-release.bat ^<this PC's IP^> [port]
+REM Builds the latest code once, serves firmware.bin.gz over HTTP and tells
+REM every cannon (MermaidsTale/Cannons/ota) to pull it. Each cannon keeps its
+REM own id (NVS) and reports progress on MermaidsTale/CannonN/ota/status.
+REM Needs python and mosquitto_pub on PATH.
+
+if "%~1"=="" (
+    echo ERROR: give this PC's IP address, e.g. ota-release.bat 10.1.10.50
+    pause
+    exit /b 1
+)
+set OTA_HOST=%~1
+set OTA_PORT=%~2
+if "%OTA_PORT%"=="" set OTA_PORT=8000
+set MQTT_HOST=10.1.10.115
+set OTA_DIR=.pio\ota
+
+REM Get current branch name
+for /f "tokens=*" %%a in ('git rev-parse --abbrev-ref HEAD') do set CURRENT_BRANCH=%%a
+echo Current branch: %CURRENT_BRANCH%
+echo.
+
+echo [1/5] Fetching latest code from GitHub...
+git fetch origin
+if errorlevel 1 (
+    echo ERROR: Failed to fetch from remote!
+    pause
+    exit /b 1
+)
+
+echo [2/5] Resetting local files to match remote...
+git reset --hard origin/%CURRENT_BRANCH%
+if errorlevel 1 (
+    echo ERROR: Failed to reset to remote branch!
+    pause
+    exit /b 1
+)
+
+echo [3/5] Building firmware...
+platformio run -e esp32-s3-devkitc-1
+if errorlevel 1 (
+    echo ERROR: Build failed!
+    pause
+    exit /b 1
+)
+
+echo [4/5] Compressing image...
+if not exist %OTA_DIR% mkdir %OTA_DIR%
+python -c "import gzip,shutil; shutil.copyfileobj(open(r'.pio\build\esp32-s3-devkitc-1\firmware.bin','rb'), gzip.open(r'%OTA_DIR%\firmware.bin.gz','wb',9))"
+if errorlevel 1 (
+    echo ERROR: Compression failed!
+    pause
+    exit /b 1
+)
+
+echo [5/5] Serving on port %OTA_PORT% and triggering the fleet...
+start "ota-http" /b python -m http.server %OTA_PORT% --directory %OTA_DIR%
+timeout /t 2 /nobreak >nul
+mosquitto_pub -h %MQTT_HOST% -t MermaidsTale/Cannons/ota -m "http://%OTA_HOST%:%OTA_PORT%/firmware.bin.gz"
+if errorlevel 1 (
+    echo ERROR: Could not reach the MQTT broker at %MQTT_HOST%!
+    pause
+    exit /b 1
+)
+
+echo.
+echo ==========================================
+echo Update sent. Watch progress with:
+echo   mosquitto_sub -h %MQTT_HOST% -t "MermaidsTale/+/ota/status" -v
+echo Press a key once every cannon reports "confirmed" to stop the server.
+echo ==========================================
+pause
+taskkill /fi "WINDOWTITLE eq ota-http" /f >nul 2>&1
+for /f "tokens=5" %%p in ('netstat -ano ^| findstr ":%OTA_PORT% " ^| findstr LISTENING') do taskkill /pid %%p /f >nul 2>&1
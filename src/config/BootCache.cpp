@@ -0,0 +1,55 @@
+#include "BootCache.h"
+
+namespace {
+constexpr const char* kNamespace = "boot";
+constexpr const char* kKey = "cache";
+}
+
+// ============================================================================
+// Load the cached entry from NVS
+// ============================================================================
+bool BootCache::load() {
+  Preferences prefs;
+  loaded_ = false;
+  data_ = Data{};
+  stored_ = Data{};
+  if (!prefs.begin(kNamespace, /*readOnly=*/true)) return false;
+
+  Data d;
+  const size_t n = (prefs.getBytesLength(kKey) == sizeof(Data))
+                       ? prefs.getBytes(kKey, &d, sizeof(Data)) : 0;
+  prefs.end();
+  if (n != sizeof(Data) || d.version != kVersion) return false;
+
+  data_ = stored_ = d;
+  loaded_ = true;
+  return true;
+}
+
+// ============================================================================
+// Write back only when the entry changed
+// ============================================================================
+bool BootCache::save() {
+  data_.version = kVersion;
+  if (memcmp(&data_, &stored_, sizeof(Data)) == 0) return true;
+
+  Preferences prefs;
+  if (!prefs.begin(kNamespace, /*readOnly=*/false)) return false;
+  const bool ok = prefs.putBytes(kKey, &data_, sizeof(Data)) == sizeof(Data);
+  prefs.end();
+  if (ok) stored_ = data_;
+  return ok;
+}
+
+// ============================================================================
+// Drop the entry (full discovery on the next boot)
+// ============================================================================
+void BootCache::clear() {
+  Preferences prefs;
+  if (prefs.begin(kNamespace, /*readOnly=*/false)) {
+    prefs.remove(kKey);
+    prefs.end();
+  }
+  data_ = stored_ = Data{};
+  loaded_ = false;
+}
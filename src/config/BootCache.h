@@ -0,0 +1,49 @@
+#pragma once
+/**
+ * BootCache
+ * - What the last good boot learned, kept in NVS (Preferences "boot"):
+ *   sensor I2C addresses, and the WiFi BSSID/channel/IPv4 lease.
+ * - With it, setup() probes only the known addresses instead of scanning
+ *   1..126, and WiFi joins the cached AP on its channel without a scan.
+ * - One fixed-layout blob; a size or version mismatch reads as a miss.
+ *   save() writes only when something changed (NVS wear).
+ *
+ * This file is framework-specific (Arduino).
+ */
+#include <Arduino.h>
+#include <Preferences.h>
+
+class BootCache {
+public:
+  struct Data {
+    uint8_t  version     = 0;
+    uint8_t  alsAddr     = 0;       // 0 = not found
+    uint8_t  vlPresent   = 0;       // VL6180X answered at 0x29
+    uint8_t  channel     = 0;       // 0 = no WiFi entry
+    uint8_t  bssid[6]    = {};
+    uint8_t  reserved[2] = {};
+    uint32_t ip = 0, gateway = 0, mask = 0, dns = 0;   // 0 = use DHCP
+  };
+
+  /** Read the cached entry. False on a miss (nothing stored, or stale layout). */
+  bool load();
+
+  /** Persist the current entry if it differs from what is stored. */
+  bool save();
+
+  /** Forget everything; the next boot does a full scan and WiFi search. */
+  void clear();
+
+  bool sensorsKnown() const { return loaded_ && data_.alsAddr != 0; }
+  bool wifiKnown() const { return loaded_ && data_.channel != 0; }
+
+  Data& data() { return data_; }
+  const Data& data() const { return data_; }
+
+private:
+  static constexpr uint8_t kVersion = 1;
+
+  Data data_{};
+  Data stored_{};
+  bool loaded_ = false;
+};
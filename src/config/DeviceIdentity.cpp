@@ -0,0 +1,29 @@
+#include "DeviceIdentity.h"
+
+namespace {
+constexpr const char* kNamespace = "device";
+constexpr const char* kIdKey = "id";
+}
+
+// ============================================================================
+// Load the stored id (or fall back to the compiled-in one)
+// ============================================================================
+uint8_t DeviceIdentity::load(uint8_t fallback) {
+  Preferences prefs;
+  if (!prefs.begin(kNamespace, /*readOnly=*/true)) return fallback;
+  const uint8_t id = prefs.getUChar(kIdKey, 0);
+  prefs.end();
+  return (id >= 1 && id <= kMaxId) ? id : fallback;
+}
+
+// ============================================================================
+// Write back only when the id changed
+// ============================================================================
+bool DeviceIdentity::save(uint8_t id) {
+  if (id < 1 || id > kMaxId) return false;
+  Preferences prefs;
+  if (!prefs.begin(kNamespace, /*readOnly=*/false)) return false;
+  const bool ok = prefs.getUChar(kIdKey, 0) == id || prefs.putUChar(kIdKey, id) == 1;
+  prefs.end();
+  return ok;
+}
@@ -0,0 +1,24 @@
+#pragma once
+/**
+ * DeviceIdentity
+ * - Which cannon this board is, kept in NVS (Preferences "device") so one
+ *   firmware image serves the whole fleet; OTA updates leave it alone.
+ * - Set once per board over MQTT (CannonN/config "id=<n>"); until then
+ *   load() returns the compiled-in fallback.
+ * - Its own namespace: a boot cache "rescan" or "defaults" does not touch it.
+ *
+ * This file is framework-specific (Arduino).
+ */
+#include <Arduino.h>
+#include <Preferences.h>
+
+class DeviceIdentity {
+public:
+  /** Stored cannon id, or `fallback` if none (or an invalid one) is stored. */
+  uint8_t load(uint8_t fallback);
+
+  /** Persist `id` (1..kMaxId); writes only when it changed. */
+  bool save(uint8_t id);
+
+  static constexpr uint8_t kMaxId = 99;
+};
@@ -18,7 +18,7 @@ namespace cfg {
   inline constexpr char MQTT_USER[]   = "";
   inline constexpr char MQTT_PASSW[]  = "";
   
-  // NOTE: The CLIENT_ID is now dynamically set in main.cpp based on config::CANNON_ID
+  // NOTE: The CLIENT_ID is now dynamically set in main.cpp from the cannon id in NVS
   // It will be: "cannon-{id}" (e.g., "cannon-1", "cannon-2", etc.)
   // If you need a different format, modify the mqtt::Config in main.cpp setup()
   
@@ -0,0 +1,67 @@
+#include "PublishConfig.h"
+
+namespace {
+constexpr const char* kNamespace = "publish";
+constexpr const char* kKey = "limits";
+constexpr size_t kMaxLanes = 8;
+
+struct Blob {
+  uint8_t              version = 0;
+  uint8_t              count   = 0;
+  uint8_t              reserved[2] = {};
+  util::GovernorLimits lanes[kMaxLanes] = {};
+};
+}
+
+// ============================================================================
+// Load stored limits (or leave the defaults)
+// ============================================================================
+bool PublishConfig::load(util::GovernorLimits* lanes, size_t n) {
+  if (n > kMaxLanes) return false;
+  Preferences prefs;
+  if (!prefs.begin(kNamespace, /*readOnly=*/true)) return false;
+
+  Blob b;
+  const size_t got = (prefs.getBytesLength(kKey) == sizeof(Blob))
+                         ? prefs.getBytes(kKey, &b, sizeof(Blob)) : 0;
+  prefs.end();
+  if (got != sizeof(Blob) || b.version != kVersion || b.count != n) return false;
+
+  memcpy(lanes, b.lanes, n * sizeof(util::GovernorLimits));
+  return true;
+}
+
+// ============================================================================
+// Write back only when the limits changed
+// ============================================================================
+bool PublishConfig::save(const util::GovernorLimits* lanes, size_t n) {
+  if (n > kMaxLanes) return false;
+  Blob b;
+  b.version = kVersion;
+  b.count = static_cast<uint8_t>(n);
+  memcpy(b.lanes, lanes, n * sizeof(util::GovernorLimits));
+
+  Preferences prefs;
+  if (!prefs.begin(kNamespace, /*readOnly=*/false)) return false;
+  Blob stored;
+  if (prefs.getBytesLength(kKey) == sizeof(Blob) &&
+      prefs.getBytes(kKey, &stored, sizeof(Blob)) == sizeof(Blob) &&
+      memcmp(&stored, &b, sizeof(Blob)) == 0) {
+    prefs.end();
+    return true;
+  }
+  const bool ok = prefs.putBytes(kKey, &b, sizeof(Blob)) == sizeof(Blob);
+  prefs.end();
+  return ok;
+}
+
+// ============================================================================
+// Drop the stored limits (compiled-in defaults on the next boot)
+// ============================================================================
+void PublishConfig::clear() {
+  Preferences prefs;
+  if (prefs.begin(kNamespace, /*readOnly=*/false)) {
+    prefs.remove(kKey);
+    prefs.end();
+  }
+}
@@ -0,0 +1,31 @@
+#pragma once
+/**
+ * PublishConfig
+ * - Publish governor limits set over MQTT (CannonN/config), kept in NVS
+ *   (Preferences "publish") so a room's tuning survives reboots and
+ *   reflashing.
+ * - One fixed-layout blob of util::GovernorLimits, one entry per governed
+ *   topic; a size or version mismatch reads as "nothing stored" and the
+ *   compiled-in defaults stay.
+ * - save() writes only when the limits changed (NVS wear).
+ *
+ * This file is framework-specific (Arduino).
+ */
+#include <Arduino.h>
+#include <Preferences.h>
+#include "util/PublishGovernor.h"
+
+class PublishConfig {
+public:
+  /** Fill `lanes[0..n)` from NVS. False (lanes untouched) if nothing matching is stored. */
+  bool load(util::GovernorLimits* lanes, size_t n);
+
+  /** Persist `lanes[0..n)` if they differ from what is stored. */
+  bool save(const util::GovernorLimits* lanes, size_t n);
+
+  /** Forget the stored limits; the next boot uses the compiled-in defaults. */
+  void clear();
+
+private:
+  static constexpr uint8_t kVersion = 1;
+};
@@ -1,4 +1,6 @@
 #include "EthernetManager.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 // ============================================================================
 // Constructor from BoardPins structures
@@ -17,75 +19,174 @@ EthernetManager::EthernetManager(const BoardPins::SPI& spi,
 }
 
 // ============================================================================
-// Private helper: Reset W5500 chip via RST pin
+// Private helper: Start with static configuration
 // ============================================================================
-void EthernetManager::resetChip_() {
-  if (pins_.rst < 0) return;
-  pinMode(pins_.rst, OUTPUT);
-  digitalWrite(pins_.rst, LOW);
-  delay(5);
-  digitalWrite(pins_.rst, HIGH);
-  delay(50);
+bool EthernetManager::startStatic_() {
+  if (!staticCfg_.isValid()) return false;
+  Ethernet.begin(mac_, staticCfg_.ip, staticCfg_.dns, staticCfg_.gw, staticCfg_.mask);
+  return Ethernet.localIP() == staticCfg_.ip;
 }
 
 // ============================================================================
-// Private helper: Start DHCP with timeout
+// DHCP worker: one blocking Ethernet.begin() per hand-over from poll()
 // ============================================================================
-bool EthernetManager::startDhcp_(unsigned long timeoutMs) {
-  const unsigned long start = millis();
-  while ((millis() - start) < timeoutMs) {
-    if (Ethernet.begin(mac_) != 0) return true; // got a lease
-    delay(250);
+bool EthernetManager::startDhcpWorker(unsigned priority, int core) {
+  if (dhcpWorker_) return true;
+  TaskHandle_t task = nullptr;
+  if (xTaskCreatePinnedToCore(&EthernetManager::dhcpWorkerMain_, "eth-dhcp", kDhcpWorkerStack, this,
+                              priority, &task, core) != pdPASS) {
+    return false;
   }
-  return false;
+  dhcpWorker_ = task;
+  return true;
 }
 
-// ============================================================================
-// Private helper: Start with static configuration
-// ============================================================================
-bool EthernetManager::startStatic_() {
-  if (!staticCfg_.isValid()) return false;
-  Ethernet.begin(mac_, staticCfg_.ip, staticCfg_.dns, staticCfg_.gw, staticCfg_.mask);
-  return Ethernet.localIP() == staticCfg_.ip;
+void EthernetManager::dhcpWorkerMain_(void* arg) {
+  auto* self = static_cast<EthernetManager*>(arg);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    const bool leased = Ethernet.begin(self->mac_, self->dhcpAttemptMs_, self->dhcpResponseMs_) != 0;
+    self->dhcpResult_.store(leased ? DhcpLeased : DhcpFailed, std::memory_order_release);
+  }
+}
+
+// Inline without a worker; otherwise hand the exchange over, then wait for its result
+bool EthernetManager::dhcpStep_() {
+  if (!dhcpWorker_) {
+    dhcpResult_ = Ethernet.begin(mac_, dhcpAttemptMs_, dhcpResponseMs_) != 0 ? DhcpLeased : DhcpFailed;
+    return true;
+  }
+  switch (dhcpResult_.load(std::memory_order_acquire)) {
+    case DhcpIdle:
+      dhcpResult_ = DhcpRunning;
+      xTaskNotifyGive(static_cast<TaskHandle_t>(dhcpWorker_));
+      return false;
+    case DhcpRunning:
+      return false;
+    default:
+      return true;
+  }
 }
 
 // ============================================================================
-// Initialize Ethernet with DHCP (fallback to static if provided)
+// Bind SPI and start the W5500 reset pulse (non-blocking)
 // ============================================================================
-bool EthernetManager::begin(unsigned long dhcpTimeoutMs) {
+void EthernetManager::start() {
   // Bind SPI to your pins and tell Ethernet which CS to use
   SPI.begin(pins_.sclk, pins_.miso, pins_.mosi, pins_.cs);
   Ethernet.init(pins_.cs);
-  resetChip_();
-
-  bool ok = startDhcp_(dhcpTimeoutMs);
-  if (!ok) ok = startStatic_();
+  failures_ = 0;
+  static_ = false;
 
-  if (ok) {
-    Serial.print(F("[ETH] IP: ")); Serial.println(Ethernet.localIP());
+  const uint32_t now = millis();
+  if (pins_.rst >= 0) {
+    pinMode(pins_.rst, OUTPUT);
+    digitalWrite(pins_.rst, LOW);
+    enter_(State::Reset, now);
   } else {
-    Serial.println(F("[ETH] Failed to obtain IP (DHCP + static fallback)."));
+    enter_(State::Settle, now);
   }
-  lastLinkUp_ = (Ethernet.linkStatus() == LinkON);
-  return ok;
 }
 
 // ============================================================================
-// Maintain DHCP lease and monitor link status
+// Bring-up state machine; lease maintenance and link monitoring once up
 // ============================================================================
-void EthernetManager::loop() {
-  // Maintain DHCP lease (1=renewed, 2=rebound)
-  const int m = Ethernet.maintain();
-  if (m == 1) {
-    Serial.print(F("[ETH] DHCP renewed: ")); Serial.println(Ethernet.localIP());
-  } else if (m == 2) {
-    Serial.print(F("[ETH] DHCP rebound: ")); Serial.println(Ethernet.localIP());
+void EthernetManager::poll(uint32_t nowMs) {
+  const uint32_t inState = nowMs - sinceMs_;
+
+  switch (state_) {
+    case State::Off:
+    case State::NoHardware:
+      return;
+
+    case State::Reset:                       // RST held low >= 5 ms
+      if (inState < 5) return;
+      digitalWrite(pins_.rst, HIGH);
+      enter_(State::Settle, nowMs);
+      return;
+
+    case State::Settle:                      // PLL lock after reset
+      if (inState < 50) return;
+      linkUp_();                             // first register access detects the chip
+      if (Ethernet.hardwareStatus() == EthernetNoHardware) {
+        Serial.println(F("[ETH] No W5500 detected"));
+        enter_(State::NoHardware, nowMs);
+      } else {
+        enter_(State::WaitLink, nowMs);
+      }
+      return;
+
+    case State::WaitLink:
+      if (!linkUp_()) return;
+      Serial.println(F("[ETH] Link UP"));
+      enter_(State::Dhcp, nowMs);
+      return;
+
+    case State::Dhcp: {
+      // The lease is only requested with a cable in; no chip access while the worker runs
+      if (dhcpResult_ != DhcpRunning && !linkUp_()) {
+        dhcpResult_ = DhcpIdle;
+        enter_(State::WaitLink, nowMs);
+        return;
+      }
+      if (!dhcpStep_()) return;
+      const bool leased = dhcpResult_ == DhcpLeased;
+      dhcpResult_ = DhcpIdle;
+      if (leased) {
+        static_ = false;
+      } else if (++failures_ >= 3 && startStatic_()) {
+        static_ = true;
+        Serial.println(F("[ETH] DHCP failed, using static configuration"));
+      } else {
+        enter_(State::Backoff, nowMs);
+        return;
+      }
+      failures_ = 0;
+      Serial.print(F("[ETH] IP: ")); Serial.println(Ethernet.localIP());
+      enter_(State::Up, nowMs);
+      return;
+    }
+
+    case State::Backoff: {
+      if (!linkUp_()) { enter_(State::WaitLink, nowMs); return; }
+      const uint8_t shift = failures_ < 5 ? failures_ : 5;
+      const uint32_t wait = (1000UL << shift) < 30000UL ? (1000UL << shift) : 30000UL;
+      if (inState >= wait) enter_(State::Dhcp, nowMs);
+      return;
+    }
+
+    case State::Up:
+      if (!linkUp_()) {
+        Serial.println(F("[ETH] Link DOWN"));
+        enter_(State::WaitLink, nowMs);        // fresh lease when the cable returns
+        return;
+      }
+      if (!static_) {
+        // Maintain DHCP lease (1=renewed, 2=rebound)
+        const int m = Ethernet.maintain();
+        if (m == 1) {
+          Serial.print(F("[ETH] DHCP renewed: ")); Serial.println(Ethernet.localIP());
+        } else if (m == 2) {
+          Serial.print(F("[ETH] DHCP rebound: ")); Serial.println(Ethernet.localIP());
+        }
+      }
+      return;
   }
+}
 
-  // Edge-detect link changes
-  const bool linkUp = (Ethernet.linkStatus() == LinkON);
-  if (linkUp != lastLinkUp_) {
-    lastLinkUp_ = linkUp;
-    Serial.println(linkUp ? F("[ETH] Link UP") : F("[ETH] Link DOWN"));
+// ============================================================================
+// Blocking bring-up (DHCP, fallback to static if provided)
+// ============================================================================
+bool EthernetManager::begin(unsigned long dhcpTimeoutMs) {
+  start();
+  const unsigned long t0 = millis();
+  while (state_ != State::Up && state_ != State::NoHardware &&
+         (millis() - t0) < dhcpTimeoutMs) {
+    poll(millis());
+    delay(10);
+  }
+  if (state_ != State::Up) {
+    Serial.println(F("[ETH] Failed to obtain IP (DHCP + static fallback)."));
   }
+  return isUp();
 }
@@ -4,12 +4,22 @@
  * - W5500 bring-up for Arduino framework (SPI pins, CS, optional RST)
  * - DHCP with optional static fallback
  * - Link-state logging + DHCP lease maintenance
+ * - Non-blocking: start() returns at once and poll() walks reset -> chip
+ *   detect -> link -> DHCP -> up. The DHCP exchange (Ethernet.begin(),
+ *   a blocking call bounded by setDhcpTiming()) runs on a small worker task
+ *   once startDhcpWorker() was called; poll() only hands it over and picks
+ *   up the result, and leaves the chip alone meanwhile. Without the worker
+ *   poll() makes the exchange itself. Attempted only while the cable link is
+ *   up; failures back off (1 s doubling to 30 s).
+ * - Lease renewal (Ethernet.maintain()) stays in poll(): it only talks to
+ *   the server once per half lease, bounded by the same timing.
  *
  * This file is framework-specific (Arduino). Keep your portable headers in /include.
  */
 #include <Arduino.h>
 #include <SPI.h>
 #include <Ethernet.h>
+#include <atomic>
 #include "board/pins.h"
 
 struct EthPins {
@@ -27,9 +37,6 @@ struct EthStaticCfg {
   }
 };
 
-// help me write
-
-
 class EthernetManager {
 public:
   EthernetManager(const EthPins& pins,
@@ -45,29 +52,63 @@ public:
                   const byte mac[6],
                   EthStaticCfg staticCfg = {});
 
+  enum class State : uint8_t { Off, Reset, Settle, NoHardware, WaitLink, Dhcp, Backoff, Up };
+
+  /** One DHCP exchange: whole attempt / per-response bounds (ms). */
+  void setDhcpTiming(unsigned long attemptMs, unsigned long responseMs) {
+    dhcpAttemptMs_ = attemptMs;
+    dhcpResponseMs_ = responseMs;
+  }
+
+  /** MAC used for DHCP/static bring-up (before start()). */
+  void setMac(const byte mac[6]) { memcpy(mac_, mac, 6); }
+
   /**
-   * Initialize SPI + W5500, then start DHCP (fallback to static if provided).
+   * Run DHCP exchanges on their own task (before start()), so the caller of
+   * poll() never waits on the server. False if the task could not be created.
+   */
+  bool startDhcpWorker(unsigned priority, int core);
+
+  /** Bind SPI, select CS and begin the chip reset; poll() does the rest. */
+  void start();
+
+  /** Advance bring-up; once up, maintain the lease and watch the link. */
+  void poll(uint32_t nowMs);
+
+  /**
+   * Blocking convenience: start() and poll() until up or timeout.
    * @return true if an IP was obtained.
    */
   bool begin(unsigned long dhcpTimeoutMs = 8000UL);
 
-  /** Call periodically: maintains DHCP lease, logs link up/down. */
-  void loop();
+  /** Same as poll(millis()). */
+  void loop() { poll(millis()); }
 
   /** True if link is up and local IP is valid. */
-  bool isUp() const {
-    return (Ethernet.linkStatus() == LinkON) && (Ethernet.localIP() != INADDR_NONE);
-  }
+  bool isUp() const { return state_ == State::Up; }
 
+  State state() const { return state_; }
   IPAddress localIP() const { return Ethernet.localIP(); }
 
 private:
-  void resetChip_();
-  bool startDhcp_(unsigned long timeoutMs);
+  void enter_(State s, uint32_t nowMs) { state_ = s; sinceMs_ = nowMs; }
+  static bool linkUp_() { return Ethernet.linkStatus() == LinkON; }
   bool startStatic_();
+  bool dhcpStep_();                     // true once the exchange has a result
+  static void dhcpWorkerMain_(void* arg);
+
+  static constexpr uint32_t kDhcpWorkerStack = 4096;
+  enum DhcpResult : uint8_t { DhcpIdle, DhcpRunning, DhcpFailed, DhcpLeased };
 
   EthPins pins_;
   byte mac_[6];
   EthStaticCfg staticCfg_;
-  bool lastLinkUp_ = false;
+  State state_ = State::Off;
+  uint32_t sinceMs_ = 0;
+  uint8_t failures_ = 0;
+  bool static_ = false;                 // running on staticCfg_ (no lease to maintain)
+  unsigned long dhcpAttemptMs_ = 1500;
+  unsigned long dhcpResponseMs_ = 500;
+  void* dhcpWorker_ = nullptr;          // TaskHandle_t
+  std::atomic<uint8_t> dhcpResult_{DhcpIdle};   // DhcpResult, worker -> poll()
 };
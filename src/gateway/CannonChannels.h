@@ -0,0 +1,201 @@
+#pragma once
+/**
+ * @file CannonChannels.h
+ * @brief Gateway mode: the angle sensors and fire buttons of several cannons
+ *        served by one MCU, held as struct-of-arrays channel state.
+ *
+ * - One channel per extra cannon: an ALS31300 at its own address (0x60-0x6F)
+ *   on the shared bus, plus an optional fire button.
+ * - Each field is its own array indexed by channel, so the round-robin pass
+ *   touches only the few words a sample needs.
+ * - sample() folds one 8-byte 0x28/0x29 burst (nullptr = bus error) and the
+ *   button level into channel i and returns its Channel* change bits: angle
+ *   in whole degrees, Fired on the debounced press, Health when the channel
+ *   goes on- or offline.
+ * - Written by the sampling task only. Health counters are relaxed atomics,
+ *   so another task may read them for diagnostics at any time.
+ *
+ * Usage:
+ *   gateway::CannonChannels<4> ch;
+ *   ch.add(3, 0x61);
+ *   const std::size_t i = ch.next();
+ *   uint32_t changes = ch.sample(i, micros(), ok ? block : nullptr, down);
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "drivers/allegro/als31300Registers.h"
+#include "util/Angle.h"
+#include "util/TextFormat.h"
+
+namespace gateway {
+
+enum : uint32_t {
+  ChannelNone   = 0,
+  ChannelAngle  = 1u << 0,
+  ChannelFired  = 1u << 1,
+  ChannelHealth = 1u << 2,
+};
+
+template <std::size_t N>
+class CannonChannels {
+  static_assert(N > 0, "CannonChannels: at least one channel");
+
+public:
+  static constexpr std::size_t kCapacity = N;
+  static constexpr std::size_t kBurstBytes = 8;   // registers 0x28 and 0x29
+  static constexpr uint8_t kOfflineAfter = 5;     // consecutive failed reads
+
+  CannonChannels() {
+    for (std::size_t i = 0; i < N; ++i) {
+      online_[i].store(false, std::memory_order_relaxed);
+      samples_[i].store(0, std::memory_order_relaxed);
+      errors_[i].store(0, std::memory_order_relaxed);
+      lastOkUs_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  /** Register a cannon; returns its channel index, or -1 when full. */
+  int add(uint8_t cannonId, uint8_t alsAddr, uint8_t filterShift = 1, uint32_t debounceUs = 20000) {
+    if (count_ >= N) return -1;
+    const std::size_t i = count_++;
+    id_[i] = cannonId;
+    addr_[i] = alsAddr;
+    shift_[i] = filterShift;
+    debounceUs_[i] = debounceUs;
+    lastDeg_[i] = -1;
+    return static_cast<int>(i);
+  }
+
+  std::size_t size() const { return count_; }
+
+  /** Round-robin cursor: the channel to sample on this pass. */
+  std::size_t next() {
+    const std::size_t i = cursor_;
+    if (++cursor_ >= count_) cursor_ = 0;
+    return i;
+  }
+
+  uint32_t sample(std::size_t i, uint32_t nowUs, const uint8_t* block, bool buttonDown) {
+    uint32_t changed = ChannelNone;
+    samples_[i].fetch_add(1, std::memory_order_relaxed);
+
+    if (!block) {
+      errors_[i].fetch_add(1, std::memory_order_relaxed);
+      if (errRun_[i] < kOfflineAfter && ++errRun_[i] == kOfflineAfter &&
+          online_[i].load(std::memory_order_relaxed)) {
+        online_[i].store(false, std::memory_order_relaxed);
+        primed_[i] = false;
+        lastDeg_[i] = -1;     // republish the angle once it is back
+        changed |= ChannelHealth;
+      }
+    } else {
+      errRun_[i] = 0;
+      lastOkUs_[i].store(nowUs, std::memory_order_relaxed);
+      if (!online_[i].load(std::memory_order_relaxed)) {
+        online_[i].store(true, std::memory_order_relaxed);
+        changed |= ChannelHealth;
+      }
+      changed |= fold_(i, block);
+    }
+
+    // Debounce: a level must hold debounceUs before it counts
+    if (buttonDown != rawDown_[i]) {
+      rawDown_[i] = buttonDown;
+      rawSinceUs_[i] = nowUs;
+    } else if (buttonDown != pressed_[i] && nowUs - rawSinceUs_[i] >= debounceUs_[i]) {
+      pressed_[i] = buttonDown;
+      if (buttonDown) {
+        firedUs_[i] = rawSinceUs_[i];   // when the press physically began
+        changed |= ChannelFired;
+      }
+    }
+    return changed;
+  }
+
+  uint8_t     cannonId(std::size_t i) const { return id_[i]; }
+  uint8_t     address(std::size_t i) const { return addr_[i]; }
+  util::Angle angle(std::size_t i) const { return angle_[i]; }
+  bool        pressed(std::size_t i) const { return pressed_[i]; }
+  uint32_t    firedUs(std::size_t i) const { return firedUs_[i]; }
+
+  bool     online(std::size_t i) const { return online_[i].load(std::memory_order_relaxed); }
+  uint32_t samples(std::size_t i) const { return samples_[i].load(std::memory_order_relaxed); }
+  uint32_t errors(std::size_t i) const { return errors_[i].load(std::memory_order_relaxed); }
+  uint32_t lastOkUs(std::size_t i) const { return lastOkUs_[i].load(std::memory_order_relaxed); }
+
+  /** "Cannon3 0x61 OK n=1200 err=0 age=20ms, ..." for the diagnostics document. */
+  void writeHealth(util::TextWriter& w, uint32_t nowUs) const {
+    for (std::size_t i = 0; i < count_; ++i) {
+      if (i) w.str(", ");
+      w.str("Cannon").u32(id_[i]).str(" 0x").hex(addr_[i], 2)
+       .str(online(i) ? " OK" : " offline")
+       .str(" n=").u32(samples(i)).str(" err=").u32(errors(i));
+      if (lastOkUs(i)) w.str(" age=").u32((nowUs - lastOkUs(i)) / 1000U).str("ms");
+    }
+  }
+
+private:
+  // Same decode and shift filter as ALS31300::Sensor, on this channel's slots
+  uint32_t fold_(std::size_t i, const uint8_t* b) {
+    auto word = [](const uint8_t* p) -> uint32_t {
+      return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | uint32_t(p[3]);
+    };
+    const ALS31300::Register0x28 reg28{word(b)};
+    const ALS31300::Register0x29 reg29{word(b + 4)};
+    if (!reg28.newData) return ChannelNone;
+
+    const uint16_t ux = uint16_t(reg28.xAxisMsbs << 4 | reg29.xAxisLsbs);
+    const uint16_t uy = uint16_t(reg28.yAxisMsbs << 4 | reg29.yAxisLsbs);
+    const int32_t sx = int32_t(int16_t(uint16_t(ux << 4))) >> 4;
+    const int32_t sy = int32_t(int16_t(uint16_t(uy << 4))) >> 4;
+
+    const uint8_t s = shift_[i];
+    if (!primed_[i]) {
+      xAcc_[i] = sx << s;
+      yAcc_[i] = sy << s;
+      primed_[i] = true;
+    } else {
+      xAcc_[i] += sx - (xAcc_[i] >> s);
+      yAcc_[i] += sy - (yAcc_[i] >> s);
+    }
+    angle_[i] = util::atan2Cdeg(yAcc_[i], xAcc_[i]);
+
+    const int16_t deg = static_cast<int16_t>(angle_[i].deg());
+    if (deg == lastDeg_[i]) return ChannelNone;
+    lastDeg_[i] = deg;
+    return ChannelAngle;
+  }
+
+  std::size_t count_  = 0;
+  std::size_t cursor_ = 0;
+
+  // Identity
+  uint8_t  id_[N]         = {};
+  uint8_t  addr_[N]       = {};
+  uint8_t  shift_[N]      = {};
+  uint32_t debounceUs_[N] = {};
+
+  // Angle
+  int32_t     xAcc_[N]    = {};
+  int32_t     yAcc_[N]    = {};
+  bool        primed_[N]  = {};
+  util::Angle angle_[N]   = {};
+  int16_t     lastDeg_[N] = {};   // last reported whole degrees; -1 = none yet
+
+  // Button
+  bool     rawDown_[N]    = {};
+  bool     pressed_[N]    = {};
+  uint32_t rawSinceUs_[N] = {};
+  uint32_t firedUs_[N]    = {};
+
+  // Health
+  uint8_t               errRun_[N] = {};
+  std::atomic<bool>     online_[N];
+  std::atomic<uint32_t> samples_[N];
+  std::atomic<uint32_t> errors_[N];
+  std::atomic<uint32_t> lastOkUs_[N];
+};
+
+} // namespace gateway
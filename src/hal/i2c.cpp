@@ -1,6 +1,8 @@
 // src/peripherals/i2c.cpp
 #include "boardkit.hpp"
 #include <Wire.h>
+#include <soc/soc_caps.h>
+#include "util/Profiler.h"
 
 // Fallback for platforms without explicit open-drain mode
 #ifndef OUTPUT_OPEN_DRAIN
@@ -9,50 +11,106 @@
 
 I2CBus* I2CBus::active_ = nullptr;
 
+TwoWire& I2CBus::wire() const {
+#if SOC_I2C_NUM > 1
+  if (port_ == 1) return Wire1;
+#endif
+  return Wire;
+}
+
 void I2CBus::begin() {
   if (inited_) return;
-  Wire.begin(static_cast<int>(sda_), static_cast<int>(scl_), hz_);
-  Wire.setTimeOut(timeout_ms_);
+  wire().begin(static_cast<int>(sda_), static_cast<int>(scl_), hz_);
+  wire().setTimeOut(timeout_ms_);
   inited_ = true;
 }
 
-bool I2CBus::devicePresent(Addr address) {
+std::uint8_t I2CBus::probe(Addr address) {
   begin();
-  Wire.beginTransmission(address);
-  return Wire.endTransmission() == 0;
+  TwoWire& w = wire();
+  w.beginTransmission(address);
+  return w.endTransmission();
 }
 
 bool I2CBus::write(Addr address, const std::uint8_t* payload, std::size_t n) {
-  begin();
-  Wire.beginTransmission(address);
-  if (n) Wire.write(payload, n);
-  return Wire.endTransmission(true) == 0; // send STOP
+  PROF_SCOPE("i2c.write");
+  if (asyncRunning() && !onWorker_()) {
+    Transaction t;
+    t.address = address;
+    t.tx = payload;
+    t.txLen = n;
+    return transact(t, timeout_ms_);
+  }
+  return wireWrite_(address, payload, n);
 }
 
 bool I2CBus::read(Addr address,
                   const std::uint8_t* index, std::size_t index_len,
                   std::uint8_t* out, std::size_t out_len) {
+  PROF_SCOPE("i2c.read");
+  if (asyncRunning() && !onWorker_()) {
+    Transaction t;
+    t.address = address;
+    t.tx = index;
+    t.txLen = index_len;
+    t.rx = out;
+    t.rxLen = out_len;
+    return transact(t, timeout_ms_);
+  }
+  return wireRead_(address, index, index_len, out, out_len);
+}
+
+bool I2CBus::wireWrite_(Addr address, const std::uint8_t* payload, std::size_t n) {
+  begin();
+  TwoWire& w = wire();
+  w.beginTransmission(address);
+  if (n) w.write(payload, n);
+  return w.endTransmission(true) == 0; // send STOP
+}
+
+bool I2CBus::wireRead_(Addr address,
+                       const std::uint8_t* index, std::size_t index_len,
+                       std::uint8_t* out, std::size_t out_len) {
   begin();
+  TwoWire& w = wire();
 
   // Stage 1: write index/register (no STOP → keep bus for repeated START)
-  Wire.beginTransmission(address);
-  if (index_len) Wire.write(index, index_len);
-  if (Wire.endTransmission(false) != 0) return false; // no STOP
+  if (index_len) {
+    w.beginTransmission(address);
+    w.write(index, index_len);
+    if (w.endTransmission(false) != 0) return false; // no STOP
+  }
 
   // Stage 2: read bytes
-  std::size_t got = Wire.requestFrom(static_cast<int>(address),
+  std::size_t got = w.requestFrom(static_cast<int>(address),
                                      static_cast<int>(out_len));
   if (got != out_len) return false;
 
   for (std::size_t i = 0; i < out_len; ++i) {
-    int b = Wire.read();
+    int b = w.read();
     if (b < 0) return false;
     out[i] = static_cast<std::uint8_t>(b);
   }
   return true;
 }
 
-// ---- "active" routing for driver callbacks ----
+void I2CBus::setFrequency(BoardPins::I2CFreqHz hz) {
+  hz_ = hz;
+  if (inited_) wire().setClock(hz_);
+}
+
+// ---- per-instance thunks ----
+bool I2CBus::ctxWrite(void* bus, std::uint8_t addr, std::uint8_t* payload, std::size_t n) {
+  return bus ? static_cast<I2CBus*>(bus)->write(addr, payload, n) : false;
+}
+
+bool I2CBus::ctxRead(void* bus, std::uint8_t addr,
+                     std::uint8_t* send, std::size_t send_n,
+                     std::uint8_t* recv, std::size_t recv_n) {
+  return bus ? static_cast<I2CBus*>(bus)->read(addr, send, send_n, recv, recv_n) : false;
+}
+
+// ---- "active" routing for legacy driver callbacks ----
 void I2CBus::setActive(I2CBus* bus) {
   active_ = bus;
   if (active_) active_->begin();
@@ -75,7 +133,7 @@ bool I2CBus::cbRead(std::uint8_t addr,
 bool I2CBus::clearBus(std::uint8_t pulses, bool slow_recover) {
   // 1) Detach Wire so we can manipulate the pins directly
   if (inited_) {
-    Wire.end();
+    wire().end();
     inited_ = false;
   }
 
@@ -123,13 +181,13 @@ bool I2CBus::clearBus(std::uint8_t pulses, bool slow_recover) {
   const auto initial_hz = hz_;
   const auto step_hz    = slow_recover ? 100000U : initial_hz;
 
-  Wire.begin(static_cast<int>(sda_), static_cast<int>(scl_), step_hz);
-  Wire.setTimeOut(timeout_ms_);
+  wire().begin(static_cast<int>(sda_), static_cast<int>(scl_), step_hz);
+  wire().setTimeOut(timeout_ms_);
   inited_ = true;
 
   if (slow_recover && initial_hz != step_hz) {
     // ESP32 Arduino supports setClock(); harmless if equal
-    Wire.setClock(initial_hz);
+    wire().setClock(initial_hz);
   }
 
   return freed;
@@ -0,0 +1,177 @@
+// src/hal/i2c_async.cpp
+//
+// Queued transaction engine behind I2CBus, built on the ESP-IDF I2C master
+// driver. Wire/Wire1 (Arduino-ESP32 2.x) install the IDF driver on their port
+// in begin(), so each bus's worker can issue command links on its own port;
+// the IDF driver serializes them against that TwoWire's own traffic.
+#include "boardkit.hpp"
+
+#ifdef ESP_PLATFORM
+
+#include <Arduino.h>
+#include <driver/i2c.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+namespace {
+  constexpr std::size_t kMaxPorts     = 2;         // I2C_NUM_0 (Wire), I2C_NUM_1 (Wire1)
+  constexpr std::size_t kMaxBatch     = 4;         // transactions per bus acquisition
+  constexpr uint32_t    kWorkerStack  = 3072;
+
+  // Each transaction is at most START+addr+data (+ repeated START+addr+data)
+  constexpr std::size_t kLinkBytes = I2C_LINK_RECOMMENDED_SIZE(2 * kMaxBatch);
+
+  void appendTxn(i2c_cmd_handle_t cmd, const I2CBus::Transaction& t) {
+    const uint8_t addrW = static_cast<uint8_t>((t.address << 1) | I2C_MASTER_WRITE);
+    const uint8_t addrR = static_cast<uint8_t>((t.address << 1) | I2C_MASTER_READ);
+
+    if (t.txLen || !t.rxLen) {   // write phase (or address-only probe)
+      i2c_master_start(cmd);
+      i2c_master_write_byte(cmd, addrW, true);
+      if (t.txLen) i2c_master_write(cmd, t.tx, t.txLen, true);
+    }
+    if (t.rxLen) {               // repeated START, read phase
+      i2c_master_start(cmd);
+      i2c_master_write_byte(cmd, addrR, true);
+      i2c_master_read(cmd, t.rx, t.rxLen, I2C_MASTER_LAST_NACK);
+    }
+  }
+
+  // Run `n` transactions as one command link: a single START..STOP acquisition.
+  bool execute(uint8_t port, I2CBus::Transaction* const* txns, std::size_t n, uint16_t timeoutMs) {
+    static uint8_t linkBuf[kMaxPorts][kLinkBytes];  // one per port's worker
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(linkBuf[port], sizeof(linkBuf[port]));
+    if (!cmd) return false;
+    for (std::size_t i = 0; i < n; ++i) appendTxn(cmd, *txns[i]);
+    i2c_master_stop(cmd);
+    const esp_err_t err = i2c_master_cmd_begin(static_cast<i2c_port_t>(port), cmd,
+                                               pdMS_TO_TICKS(timeoutMs));
+    i2c_cmd_link_delete_static(cmd);
+    return err == ESP_OK;
+  }
+
+  void complete(I2CBus::Transaction& t, bool ok) {
+    if (t.done) t.done(t, ok, t.ctx);
+    t.state.store(ok ? I2CBus::TxnState::Done : I2CBus::TxnState::Failed,
+                  std::memory_order_release);
+  }
+}
+
+bool I2CBus::startAsync(std::size_t queueDepth, unsigned priority, int core) {
+  if (queue_) return true;
+  if (port_ >= kMaxPorts) return false;
+  begin();  // make sure the IDF driver is installed on the port
+
+  QueueHandle_t q = xQueueCreate(queueDepth, sizeof(Transaction*));
+  if (!q) return false;
+  queue_ = q;
+
+  TaskHandle_t task = nullptr;
+  if (xTaskCreatePinnedToCore(&I2CBus::workerMain_, port_ ? "i2c1" : "i2c0", kWorkerStack, this,
+                              priority, &task, core) != pdPASS) {
+    vQueueDelete(q);
+    queue_ = nullptr;
+    return false;
+  }
+  worker_ = task;
+  return true;
+}
+
+bool I2CBus::submit(Transaction& head) {
+  if (!queue_) return false;
+  for (Transaction* t = &head; t; t = t->next) {
+    t->state.store(TxnState::Queued, std::memory_order_relaxed);
+  }
+  Transaction* p = &head;
+  if (xQueueSend(static_cast<QueueHandle_t>(queue_), &p, 0) != pdTRUE) {
+    for (Transaction* t = &head; t; t = t->next) t->state.store(TxnState::Idle);
+    return false;
+  }
+  return true;
+}
+
+bool I2CBus::wait(Transaction& head, std::uint32_t timeout_ms) {
+  const TickType_t start = xTaskGetTickCount();
+  const TickType_t limit = pdMS_TO_TICKS(timeout_ms);
+  while (head.pending()) {
+    const TickType_t spent = xTaskGetTickCount() - start;
+    if (spent >= limit) return false;  // caller keeps the descriptor alive until !pending()
+    ulTaskNotifyTake(pdTRUE, limit - spent);
+  }
+  for (Transaction* t = &head; t; t = t->next) {
+    if (!t->succeeded()) return false;
+  }
+  return true;
+}
+
+bool I2CBus::transact(Transaction& head, std::uint32_t timeout_ms) {
+  head.waiter = xTaskGetCurrentTaskHandle();
+  if (!submit(head)) return false;
+  // Each command link is bounded by the driver timeout, so completion is
+  // guaranteed; keep waiting past timeout_ms because the descriptor is
+  // usually on the caller's stack.
+  while (!wait(head, timeout_ms)) {
+    if (!head.pending()) return false;
+  }
+  return true;
+}
+
+bool I2CBus::onWorker_() const {
+  return worker_ && xTaskGetCurrentTaskHandle() == static_cast<TaskHandle_t>(worker_);
+}
+
+void I2CBus::workerMain_(void* arg) {
+  auto* self = static_cast<I2CBus*>(arg);
+  Transaction* head = nullptr;
+  for (;;) {
+    if (xQueueReceive(static_cast<QueueHandle_t>(self->queue_), &head, portMAX_DELAY) == pdTRUE) {
+      self->runBatch_(*head);
+    }
+  }
+}
+
+bool I2CBus::runBatch_(Transaction& head) {
+  void* waiter = head.waiter;
+  bool  headOk = false;
+  bool  allOk  = true;
+
+  Transaction* cursor = &head;
+  while (cursor) {
+    // Gather up to kMaxBatch descriptors; grab `next` before completing any.
+    Transaction* seg[kMaxBatch];
+    std::size_t n = 0;
+    while (cursor && n < kMaxBatch) { seg[n++] = cursor; cursor = cursor->next; }
+
+    bool ok[kMaxBatch];
+    if (execute(port_, seg, n, timeout_ms_)) {
+      for (std::size_t i = 0; i < n; ++i) ok[i] = true;
+    } else {
+      // One NACK fails the whole link; rerun individually to attribute it
+      for (std::size_t i = 0; i < n; ++i) ok[i] = (n > 1) && execute(port_, &seg[i], 1, timeout_ms_);
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+      allOk &= ok[i];
+      if (seg[i] == &head) headOk = ok[i];
+      else complete(*seg[i], ok[i]);
+    }
+  }
+
+  // Head completes last so wait(head) covers the whole batch
+  complete(head, headOk);
+  if (waiter) xTaskNotifyGive(static_cast<TaskHandle_t>(waiter));
+  return allOk;
+}
+
+#else  // !ESP_PLATFORM
+
+bool I2CBus::startAsync(std::size_t, unsigned, int) { return false; }
+bool I2CBus::submit(Transaction&) { return false; }
+bool I2CBus::wait(Transaction& head, std::uint32_t) { return head.succeeded(); }
+bool I2CBus::transact(Transaction&, std::uint32_t) { return false; }
+bool I2CBus::onWorker_() const { return false; }
+void I2CBus::workerMain_(void*) {}
+bool I2CBus::runBatch_(Transaction&) { return false; }
+
+#endif // ESP_PLATFORM
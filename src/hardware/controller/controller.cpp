@@ -5,11 +5,12 @@ Controller::Controller(const BoardPins& pins,
                        gpio_pin_t buttonPin,
                        Pull pull,
                        ActivePolarity polarity,
-                       uint16_t debounceMs) noexcept
+                       uint16_t debounceMs,
+                       ButtonMode buttonMode) noexcept
 : pins_(pins),
   i2c_(pins_.i2c()),                                  // build I2CBus from BoardPins
   buttonPin_(GpioPin(buttonPin, GpioMode::Input, pull, polarity)),
-  button_(DebouncedButton(buttonPin_, debounceMs))     // behavior layered on the pin
+  button_(DebouncedButton(buttonPin_, debounceMs, buttonMode))  // behavior layered on the pin
 {}
 
 void Controller::begin() {
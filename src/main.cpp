@@ -2,47 +2,204 @@
 #include <PubSubClient.h>
 #include <WiFi.h>
 #include <Wire.h>
+#include <esp_mac.h>       // esp_read_mac (W5500 MAC)
 #include <esp_task_wdt.h>  // For watchdog timer
+#include <esp_wifi.h>      // esp_wifi_sta_get_ap_info (SSID without String)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
 
 #include <Arduino.h>
 #include "boardkit.hpp"
 
+#include "config/BootCache.h"
+#include "config/DeviceIdentity.h"
 #include "config/MqttConfig.h"
+#include "config/PublishConfig.h"
+#include "ethernet/EthernetManager.h"
+#include "gateway/CannonChannels.h"
+#include "ota/OtaUpdate.h"
 #include "state/CannonStateView.h"
 #include "state/ControllerState.h"
 #include "telemetry/CannonTelemetry.h"
+#include "telemetry/CannonTopics.h"
+#include "telemetry/LatencyProbe.h"
+#include "telemetry/ResourceMonitor.h"
 #include "telemetry/ControllerTelemetrySource.h"
+#include "telemetry/TraceFrame.h"
+#include "util/AngleTracker.h"
+#include "util/DeadlineScheduler.h"
+#include "util/DeferredLog.h"
+#include "util/PublishGovernor.h"
+#include "util/SpscRing.h"
+#include "net/TransportSelector.h"
+#include "net/adapters/Arduino/ArduinoWifiClientAdapter.h"
+#include "protocols/mqtt/MqttCommandRouter.h"
+#include "protocols/mqtt/MqttNativeClient.h"
+#include "protocols/mqtt/MqttOutboundQueue.h"
+#include "protocols/mqtt/MqttPublishStream.h"
+#include "util/Profiler.h"
+#include "util/TextFormat.h"
 
 // ============================================================================
 // CONFIGURATION CONSTANTS (replaces magic numbers)
 // ============================================================================
 namespace config {
-  // Cannon Identity
-  constexpr uint8_t CANNON_ID = 2;                  // ← CHANGE THIS FOR EACH CANNON
+  // Cannon identity: stored in NVS (CannonN/config "id=<n>"); this is the
+  // fallback for a board that has never been given one
+  constexpr uint8_t DEFAULT_CANNON_ID = 2;
   
   // Filter coefficients
   constexpr float DISTANCE_FILTER_ALPHA = 0.2f;     // 20% new, 80% old
-  constexpr float ANGLE_FILTER_ALPHA = 0.3f;        // 30% new, 70% old
   
   // Change detection thresholds
-  constexpr float MAX_ANGLE_JUMP_DEG = 10.0f;       // Reject unrealistic angle changes
+  constexpr float MAX_ANGLE_JUMP_DEG = 10.0f;       // Reject unrealistic angle changes (vs. prediction)
   constexpr int MIN_ANGLE_CHANGE_DEG = 1;           // Publish threshold
   constexpr uint8_t MIN_DISTANCE_CHANGE_MM = 2;     // Publish threshold
   
+  // Angle estimation between the ALS31300 driver and ctl::State
+  enum class AngleEstimator : uint8_t { DriverIir, AlphaBeta };
+  constexpr AngleEstimator ANGLE_ESTIMATOR = AngleEstimator::AlphaBeta;
+  constexpr uint8_t ALS_IIR_SHIFT = 5;              // DriverIir: historical 32-tap X/Y/Z filter
+  constexpr uint8_t ALS_PREFILTER_SHIFT = 1;        // AlphaBeta: light X/Y/Z smoothing ahead of the tracker
+  constexpr uint16_t ANGLE_NOISE_CDEG = 25;         // Heading noise sigma after the prefilter
+  constexpr uint32_t ANGLE_ACCEL_CDEG_S2 = 20000;   // Expected swing acceleration sigma (200 deg/s^2)
+
+  // ALS31300 motion wake: a still cannon is left to the part's own duty
+  // cycle and its INT pin instead of being polled at ANGLE_RATE_HZ
+  constexpr bool ALS_WAKE_MODE = true;              // needs ALS_INT_PIN wired
+  constexpr uint8_t ALS_WAKE_THRESHOLD = 2;         // X/Y delta that counts as movement (6-bit)
+  constexpr uint32_t ALS_IDLE_AFTER_MS = 3000;      // Still this long -> low-power + INT
+  constexpr auto ALS_IDLE_INTERVAL = ALS31300::Sensor::LowPowerInterval::Ms50; // part-side sampling while idle
+  constexpr uint32_t ALS_IDLE_POLL_MS = 1000;       // Safety poll for a missed INT edge
+
+  // Publish governor for CannonN/Hor (runtime: CannonN/config, kept in NVS).
+  // Applies after StateView's whole-degree quantization.
+  constexpr util::GovernorLimits HOR_GOVERNOR{
+    0,    // deadband (deg): any whole-degree change qualifies
+    50,   // min interval (ms): at most 20 angle messages/s per cannon
+    10,   // sustained rate (messages/s)
+    5,    // burst: quick moves still go out at once
+    150   // settle (ms): exact final angle once the swing stops
+  };
+
   // Timing
   constexpr uint32_t STATUS_REPORT_INTERVAL_MS = 5000;
-  constexpr uint32_t STARTUP_SETTLE_MS = 1000;
+  constexpr uint32_t PERF_REPORT_INTERVAL_MS = 10000;  // PROF_ENABLED builds only
+  constexpr uint32_t STARTUP_SETTLE_MS = 1000;       // Skipped with FAST_BOOT
+  constexpr bool FAST_BOOT = true;                  // NVS-cached sensor addresses + WiFi AP/lease, no settle delays
+  constexpr bool WIFI_CACHE_IP = true;              // FAST_BOOT: rejoin with the last DHCP lease (no DHCP round trip)
+  constexpr uint32_t WIFI_FAST_JOIN_MS = 3000;      // FAST_BOOT: cached AP join budget before a full scan
   constexpr uint32_t MQTT_RECONNECT_CHECK_MS = 5000;
+  constexpr uint32_t MQTT_CONNECT_TIMEOUT_MS = 3000;  // CONNACK deadline (native client, non-blocking)
+  constexpr uint32_t MQTT_TCP_TIMEOUT_MS = 1000;    // TCP handshake, blocks the network task per link tried
+  constexpr bool USE_NATIVE_MQTT = true;            // In-tree MQTT 3.1.1 client; false = PubSubClient (QoS0 only)
+
+  // Network transport: W5500 Ethernet while its link is up, WiFi otherwise
+  // (native MQTT client only; PubSubClient stays on WiFi)
+  constexpr bool USE_ETHERNET = true;               // No W5500 found = WiFi only
+  constexpr uint32_t ETH_POLL_MS = 50;              // Bring-up / link watch cadence
+  constexpr uint32_t ETH_PREFER_HOLD_MS = 2000;     // Ethernet link stable this long before MQTT moves over
+  constexpr uint32_t TRANSPORT_REPORT_INTERVAL_MS = 30000; // Per-transport publish latency -> CannonN/transport
+  constexpr uint32_t MEMORY_REPORT_INTERVAL_MS = 60000;    // Heap + stack watermarks -> CannonN/diagnostics/memory
   constexpr uint32_t WATCHDOG_TIMEOUT_S = 10;
+  // Ethernet then WiFi: the worst reconnect stall stays a quarter of the watchdog
+  static_assert(2 * MQTT_TCP_TIMEOUT_MS <= WATCHDOG_TIMEOUT_S * 1000 / 4, "MQTT TCP connect bound too close to the watchdog");
+  constexpr uint16_t OUTBOUND_DRAIN_PER_SEC = 20;   // Backlog replay rate after a reconnect
+  constexpr uint16_t OUTBOUND_DRAIN_BURST = 5;      // Messages sent back to back before pacing
+  constexpr uint32_t RESTART_DRAIN_MS = 1500;       // Queue flush before a commanded restart (under the watchdog)
+  static_assert(RESTART_DRAIN_MS <= WATCHDOG_TIMEOUT_S * 1000 / 4, "restart drain too close to the watchdog");
+
+  // Trace mode (CannonN/trace): full-rate samples, batched into binary frames
+  constexpr uint8_t TRACE_BATCH_SAMPLES = 25;       // Default samples per frame (0.5 s at 50 Hz)
+  constexpr uint8_t TRACE_MAX_BATCH = 64;           // Upper bound accepted from "on <n>"
+  constexpr uint32_t TRACE_FLUSH_MS = 1000;         // Ship a partial frame after this long
+
+  // Latency probe (CannonN/ping): timing records on CannonN/probe
+  constexpr uint32_t PROBE_HOLD_MS = 5000;          // records flow this long after each ping
+
+  // OTA (CannonN/ota <url>): image pulled over HTTP on the active link
+  constexpr uint32_t OTA_HTTP_TIMEOUT_MS = 5000;    // stall limit: no body bytes this long fails the update
+  constexpr uint32_t OTA_HTTP_CONNECT_MS = 1000;    // TCP handshake, blocks the network task
+  static_assert(OTA_HTTP_CONNECT_MS <= WATCHDOG_TIMEOUT_S * 1000 / 4, "OTA HTTP connect bound too close to the watchdog");
+  constexpr size_t OTA_STEP_BYTES = 4096;           // downloaded per job run
+  constexpr uint32_t OTA_STEP_MS = 5;               // job period while downloading
+  constexpr uint32_t OTA_IDLE_POLL_MS = 1000;       // job period otherwise (trial boot watch)
+  constexpr uint32_t OTA_PROGRESS_MS = 2000;        // CannonN/ota/status while downloading
+  constexpr uint32_t OTA_CONFIRM_TIMEOUT_MS = 120000; // new image must reach MQTT by then
+
+  // Job rates (defaults; adjustable at runtime via CannonN/rates)
+  constexpr uint32_t ANGLE_RATE_HZ = 50;            // ALS31300 sampling
+  constexpr uint32_t RANGE_POLL_MS = 20;            // VL6180X status polling (GPIO1 unwired)
+  constexpr uint32_t RANGE_FALLBACK_MS = 100;       // Safety poll when GPIO1 wakes the task
+  constexpr uint32_t BUTTON_POLL_MS = 5;            // ButtonMode::Polling only
+  constexpr uint32_t NETWORK_PERIOD_MS = 10;        // MQTT service cadence
+  constexpr uint32_t SCHED_MAX_SLEEP_MS = 1000;     // Longest idle sleep (watchdog margin)
+  constexpr uint32_t MAX_JOB_RATE_HZ = 1000;        // Upper bound accepted from CannonN/rates
+  constexpr uint32_t RESET_STEP_GAP_MS = 2;         // Sensor reset: pause between steps (sampling runs)
+  constexpr uint32_t RESET_STATUS_DELAY_MS = 100;   // Status document after a reset result
+
+  // Task runtime (ESP32-S3: core 0 = WiFi/lwIP, core 1 = application)
+  constexpr BaseType_t SENSOR_TASK_CORE = 1;
+  constexpr BaseType_t NETWORK_TASK_CORE = 0;
+  constexpr UBaseType_t SENSOR_TASK_PRIORITY = configMAX_PRIORITIES - 2;
+  constexpr UBaseType_t NETWORK_TASK_PRIORITY = 2;
+  constexpr uint32_t SENSOR_TASK_STACK = 4096;
+  constexpr uint32_t NETWORK_TASK_STACK = 8192;
+  constexpr UBaseType_t I2C_TASK_PRIORITY = configMAX_PRIORITIES - 1; // above the sensor task
+  constexpr BaseType_t LOG_TASK_CORE = 0;          // drains DLOG_* records to Serial
+  constexpr UBaseType_t LOG_TASK_PRIORITY = 1;     // just above idle: runs in spare time only
+  constexpr uint32_t LOG_TASK_STACK = 3072;
+  constexpr BaseType_t ETH_DHCP_TASK_CORE = 0;     // blocking DHCP exchanges, off the network task
+  constexpr UBaseType_t ETH_DHCP_TASK_PRIORITY = 1; // below the network task
+  constexpr uint32_t LOG_DRAIN_MS = 20;            // ring of DLOG_RING_RECORDS absorbs bursts in between
+  constexpr size_t I2C_QUEUE_DEPTH = 16;
   
   // Hardware
   constexpr int BUTTON_PIN = 35;
   constexpr int BUTTON_DEBOUNCE_MS = 20;
+  constexpr ButtonMode BUTTON_MODE = ButtonMode::Interrupt; // ISR-timestamped edges
   constexpr uint8_t ALS_FALLBACK_ADDR = 0x65;
   constexpr int I2C_SDA_PIN = 15;
   constexpr int I2C_SCL_PIN = 18;
-  constexpr uint32_t I2C_FREQUENCY = 100000U;
+  // VL6180X on the second controller (Wire1) so both sensors transfer in
+  // parallel; false = shared with the ALS31300 on Wire (the original wiring)
+  constexpr bool VL6180X_OWN_BUS = false;
+  constexpr int VL6180X_SDA_PIN = 8;               // VL6180X_OWN_BUS only
+  constexpr int VL6180X_SCL_PIN = 9;
+  constexpr uint32_t VL6180X_I2C_FREQUENCY = 400000U; // VL6180X tops out at 400 kHz
+  constexpr uint32_t I2C_FREQUENCY =               // ALS31300 alone: 1 MHz
+      VL6180X_OWN_BUS ? 1000000U : VL6180X_I2C_FREQUENCY;
+  constexpr int VL6180X_GPIO1_PIN = 16;            // VL6180X GPIO1 "range ready" (BoardPins::NC = poll status)
+  constexpr int ALS_INT_PIN = 17;                  // ALS31300 INT, open drain (BoardPins::NC = always poll)
+  constexpr int ETH_SCLK_PIN = 12;                 // W5500 on SPI
+  constexpr int ETH_MISO_PIN = 13;
+  constexpr int ETH_MOSI_PIN = 11;
+  constexpr int ETH_CS_PIN = 10;
+  constexpr int ETH_RST_PIN = 14;                  // -1 if not wired
+  constexpr auto ALS_READ_MODE = ALS31300::Sensor::ReadMode::FullLoop; // 1 bare 8-byte read per sample
   
+  // VL6180X continuous ranging
+  constexpr VL6180X::RangingConfig VL6180X_RANGING{
+    20,   // inter-measurement period (ms)
+    10    // max convergence time (ms)
+  };
+
+  // Gateway mode: further cannons whose ALS31300 (own address, 0x60-0x6F)
+  // and fire button hang off this board. Each publishes its own CannonN/*
+  // topics over this board's MQTT session; Loaded stays with its own id
+  // (the VL6180X is fixed at 0x29, so one per bus).
+  struct GatewayChannel { uint8_t cannonId; uint8_t alsAddr; int buttonPin; };
+  constexpr bool GATEWAY_MODE = false;
+  // Button pins: 4/5 are plain GPIOs on every S3 module. 33-37 are not:
+  // octal-PSRAM modules (N8R8, N16R8) reserve them for the PSRAM bus.
+  constexpr GatewayChannel GATEWAY_CHANNELS[] = {
+    {3, 0x61, 4},                                  // buttonPin BoardPins::NC = angle only
+    {4, 0x62, 5},
+  };
+  constexpr size_t GATEWAY_COUNT = GATEWAY_MODE ? sizeof(GATEWAY_CHANNELS) / sizeof(GATEWAY_CHANNELS[0]) : 0;
+  constexpr uint32_t GATEWAY_RATE_HZ = 50;         // per channel; one channel per "gateway" job run
+
   // VL6180X Error Codes (from datasheet)
   constexpr uint8_t VL6180X_ERR_ECE_FAIL = 6;       // ECE check failed
   constexpr uint8_t VL6180X_ERR_VCSEL_WD = 11;      // VCSEL watchdog timeout
@@ -51,23 +208,65 @@ namespace config {
 // ============================================================================
 // STATE MANAGEMENT
 // ============================================================================
-enum class ResetState { IDLE, PENDING, IN_PROGRESS };
-static ResetState resetState = ResetState::IDLE;
-static unsigned long resetStartTime = 0;
+// Reset is requested by the network task, executed on the sensor task (which
+// owns the I2C devices) one short step per job run, and reported back by the
+// network task. Sensors not being reset keep sampling throughout.
+enum class ResetState : uint8_t { IDLE, PENDING, IN_PROGRESS, COMPLETE };
+enum ResetTarget : uint8_t { ResetAngle = 1, ResetDistance = 2, ResetAll = ResetAngle | ResetDistance };
+static std::atomic<ResetState> resetState{ResetState::IDLE};
+static std::atomic<uint8_t> resetRequest{0};   // ResetTarget bits, network -> sensor task
+static std::atomic<uint8_t> resetDone{0};      // what the finished run covered
+
+// One sensor sample plus the change masks it produced. Pushed by the sensor
+// task, consumed by the network task.
+struct SensorEvent {
+  uint32_t tsMs          = 0;
+  util::Angle angle     {};
+  uint8_t  distanceMm    = 0;
+  uint8_t  rangeStatus   = VL6180X_ERROR_NONE;
+  bool     distanceRead  = false;   // VL6180X was sampled this cycle
+  bool     alsOk         = false;   // ALS31300 update succeeded
+  bool     button        = false;
+  uint32_t buttonEdgeUs  = 0;       // micros() when the button edge physically began
+  uint32_t angleUs       = 0;       // micros() of the ALS31300 sample behind angle
+  uint32_t rangeUs       = 0;       // micros() of the last VL6180X sample
+  uint32_t commitUs      = 0;       // micros() when commitSample() ran
+  bool     justLoaded    = false;
+  bool     justFired     = false;
+  uint32_t stateChanges  = ctl::ChangedNone;
+  uint32_t viewChanges   = cannon::ChangedNone;
+};
+
+// One gateway channel's changes (gateway::Channel* bits), sensor -> network task
+struct GatewayEvent {
+  uint8_t     channel = 0;
+  uint32_t    changes = gateway::ChannelNone;
+  util::Angle angle   {};
+  uint32_t    firedUs = 0;   // micros() when the press physically began
+  bool        online  = false;
+};
 
 // ============================================================================
 // FORWARD DECLARATIONS
 // ============================================================================
 void sendStartupStatus();
 void scanI2CDevices();
-void handleReset();
+void publishResetResult();
 void handleMqttReconnection();
-void onMqttMessage(char *topic, byte *payload, unsigned int length);
+void onMqttMessage(const char *topic, const uint8_t *payload, size_t length);
+void startRuntimeTasks();
 
-// Helper function to build cannon-specific topics
-void buildCannonTopic(char* out, size_t cap, const char* suffix) {
-  snprintf(out, cap, "MermaidsTale/Cannon%d/%s", config::CANNON_ID, suffix);
-}
+// (Re)create the ALS31300 driver at addr, program its read mode, take a first sample
+bool startAls(uint8_t addr);
+
+// Bind every command handler and fill the subscription table (after topics.build)
+void registerCommands();
+
+// Give each outbound topic its queueing policy (after topics.build)
+void routeOutbound();
+
+// Gateway channels, their topics and button pins (before routeOutbound)
+void startGateway();
 
 // ============================================================================
 // GLOBAL OBJECTS
@@ -76,122 +275,714 @@ static uint8_t detectedALS_ADDR = 0x00;
 static bool alsAddressDetected = false;
 
 Adafruit_VL6180X distanceSensor = Adafruit_VL6180X();
-bool vl6180xInitialized = false;
-bool als31300Initialized = false;
-ALS31300::Sensor als(config::ALS_FALLBACK_ADDR);
+std::atomic<bool> vl6180xInitialized{false};
+std::atomic<bool> als31300Initialized{false};
+static std::atomic<uint8_t> vl6180xProbeError{0};  // last I2C probe result at 0x29
+static std::atomic<bool> vl6180xResetOk{false};
+static std::atomic<bool> als31300ResetOk{false};
+util::AngleTracker angleTracker({config::ANGLE_NOISE_CDEG, config::ANGLE_ACCEL_CDEG_S2,
+                                 static_cast<uint16_t>(config::MAX_ANGLE_JUMP_DEG * 100)});
 
 Controller ctrl(
-  BoardPins::DevKitS3_DefaultI2C(config::I2C_SDA_PIN, config::I2C_SCL_PIN, config::I2C_FREQUENCY),
+  BoardPins::DevKitS3_DefaultI2C(config::I2C_SDA_PIN, config::I2C_SCL_PIN, config::I2C_FREQUENCY)
+    .withGpio(BoardPins::GPIO{BoardPins::NC, config::VL6180X_GPIO1_PIN}),
   config::BUTTON_PIN,
   Pull::Up,
   ActivePolarity::ActiveLow,
-  config::BUTTON_DEBOUNCE_MS
+  config::BUTTON_DEBOUNCE_MS,
+  config::BUTTON_MODE
 );
 
+// ALS31300 owns Wire; the VL6180X gets Wire1 when it is wired to its own pins
+static I2CBus vl6180xOwnBus(config::VL6180X_SDA_PIN, config::VL6180X_SCL_PIN,
+                            config::VL6180X_I2C_FREQUENCY, 50, /*port=*/1);
+I2CBus& rangeBus = config::VL6180X_OWN_BUS ? vl6180xOwnBus : ctrl.i2c();
+
+static ALS31300::Sensor::Transport alsTransport() {
+  return {&ctrl.i2c(), &I2CBus::ctxRead, &I2CBus::ctxWrite};
+}
+ALS31300::Sensor als(config::ALS_FALLBACK_ADDR, alsTransport());
+
+VL6180X::RangingEngine ranging(rangeBus,
+                               GpioPin(ctrl.board().gpio().irq, GpioMode::Input, Pull::Up));
+
 ctl::State gstate;
 ControllerTelemetrySource tSource(gstate);
 WiFiClient wifiClient;
 PubSubClient pubSubClient(wifiClient);
-ArduinoPubSubClientAdapter mqttAdapter(pubSubClient);
+ArduinoPubSubClientAdapter pubSubAdapter(pubSubClient);
+
+// Sensor addresses and WiFi AP/lease from the last boot (NVS)
+BootCache bootCache;
+
+// Which cannon this board is (NVS), read before anything uses it in setup()
+DeviceIdentity deviceIdentity;
+static uint8_t cannonId = config::DEFAULT_CANNON_ID;
+
+// W5500 Ethernet; the MAC is derived from the chip's eFuse MAC in setup()
+static const byte kEthMacUnset[6] = {};
+EthernetManager eth(EthPins{config::ETH_SCLK_PIN, config::ETH_MISO_PIN, config::ETH_MOSI_PIN,
+                            config::ETH_CS_PIN, config::ETH_RST_PIN},
+                    kEthMacUnset);
+EthernetClient ethClient;
+net::ArduinoEthClientAdapter ethNet(ethClient);
+net::ArduinoWiFiClientAdapter wifiNet(wifiClient);
+
+// Ethernet first, WiFi as fallback; the native MQTT client connects through it
+net::TransportSelector<2> transport(config::ETH_PREFER_HOLD_MS);
+static bool ethLinkUp(void*) { return eth.isUp(); }
+static bool wifiLinkUp(void*) { return WiFi.status() == WL_CONNECTED; }
+static bool networkUp() { return wifiLinkUp(nullptr) || eth.isUp(); }
+
+// Native client: QoS1 Loaded/Fired events with pipelined PUBACKs
+static uint32_t mqttClockMs() { return millis(); }
+mqtt::NativeClient<> nativeMqtt(transport, &mqttClockMs);
+static void recordPublishLatency(void*, uint32_t rttMs) { transport.recordLatency(rttMs); }
+
+mqtt::IMqttClient& mqttAdapter = config::USE_NATIVE_MQTT
+    ? static_cast<mqtt::IMqttClient&>(nativeMqtt)
+    : static_cast<mqtt::IMqttClient&>(pubSubAdapter);
+
+// Everything the network task publishes goes through this queue so values
+// produced while the broker is unreachable are coalesced, not lost.
+// 14 routes, 8 single-slot topics; 4 routes and 2 slots more per gateway channel.
+// Fifo entries fit the longest probe/pong line, so probing never drops its own records.
+static constexpr size_t kOutboundFifoCap = integ::kMaxPongLen;
+static_assert(integ::kMaxProbeLen <= kOutboundFifoCap, "probe records must fit a Fifo entry");
+mqtt::OutboundQueue<15 + 4 * config::GATEWAY_COUNT, 8 + 2 * config::GATEWAY_COUNT,
+                    16, 512, kOutboundFifoCap> outbound(mqttAdapter);
+
+// Routed documents: serialize into a buffer (Cap <= the queue's slot size)
+// and publish through the queue, so their policy and reconnect replay apply.
+// `fn(util::ByteSink&)` returns false to skip the publish.
+template <size_t Cap, typename Fn>
+static bool publishQueued(const char* topic, Fn&& fn, bool retain) {
+  char msg[Cap];
+  util::BufferSink sink(msg, sizeof(msg));
+  if (!fn(sink) || !sink.ok()) return false;
+  return outbound.publish(topic, reinterpret_cast<const uint8_t*>(msg), sink.size(), retain, 0);
+}
 
-static float getAngleDeg(const ctl::State &s) { return s.getAngleDeg(); }
-static bool getLoaded(const ctl::State &s) { return s.getLoaded(); }
-static bool getFired(const ctl::State &s) { return s.getFired(); }
+cannon::StateView<ctl::State> cView(gstate);
 
-cannon::StateView<ctl::State> cView(gstate, &getAngleDeg, &getLoaded, &getFired);
+// Every topic for this cannon, built once in setup()
+cannon::Topics topics;
 
-// Build base topic for this cannon (initialized in setup())
-char cannonBaseTopic[64];
+// Inbound commands: unicast and room-wide broadcast topics, one handler each
+mqtt::CommandRouter<8, 8> commands;   // 7 routes, 8 filters
 
 telem::TelemetryConfig tcfg{
-    cannonBaseTopic,
+    topics.base(),
     "state",
     "changes",
     true,
     0
 };
-telem::TelemetryPublisher tPub(mqttAdapter, tSource, tcfg);
+telem::TelemetryPublisher tPub(outbound, tSource, tcfg);
+
+integ::CannonTelemetry cannonPub(outbound, topics);
+
+static util::SpscRing<SensorEvent, 64> sensorEvents;
+
+// Gateway mode: channel state (sensor task), topics per channel (network task)
+static constexpr size_t kGatewaySlots = config::GATEWAY_COUNT ? config::GATEWAY_COUNT : 1;
+static gateway::CannonChannels<kGatewaySlots> gwChannels;
+static cannon::Topics gwTopics[kGatewaySlots];
+static int gwButtonPins[kGatewaySlots];
+static util::SpscRing<GatewayEvent, 32> gatewayEvents;
+
+// Publish governor: one set of limits per governed topic, between the view's
+// change bits and CannonTelemetry. Network task only.
+enum GovernedTopic : uint8_t { GovHor, GovernedTopicCount };
+static const char* const kGovernedNames[GovernedTopicCount] = { "hor" };
+static util::GovernorLimits govLimits[GovernedTopicCount] = { config::HOR_GOVERNOR };
+static util::PublishGovernor horGov(360);                  // whole degrees wrap
+static util::PublishGovernor gwHorGov[kGatewaySlots];      // gateway channels, "hor" limits
+PublishConfig publishConfig;
+
+// OTA: own sockets, so a download never touches the MQTT session's client
+WiFiClient otaWifiClient;
+EthernetClient otaEthClient;
+net::ArduinoWiFiClientAdapter otaWifiNet(otaWifiClient);
+net::ArduinoEthClientAdapter otaEthNet(otaEthClient);
+ota::Update otaUpdate(&mqttClockMs);
+static bool otaTrial = false;   // running image not confirmed yet
+
+// Trace mode: the sensor task records while traceEnabled, the network task
+// packs frames. Kept out of sensorEvents so tracing never crowds normal events.
+static std::atomic<bool> traceEnabled{false};
+static std::atomic<uint8_t> traceBatch{config::TRACE_BATCH_SAMPLES};
+static util::SpscRing<integ::TraceSample, 256> traceSamples;
+
+// Latency probe: armed for PROBE_HOLD_MS by each CannonN/ping. Network task only.
+static struct {
+  bool     armed   = false;
+  uint32_t sinceMs = 0;   // last ping
+  uint32_t seq     = 0;   // next record
+} probeCtx;
+static TaskHandle_t sensorTaskHandle = nullptr;
+static TaskHandle_t networkTaskHandle = nullptr;
+static TaskHandle_t logTaskHandle = nullptr;
+
+// Heap and task stack watermarks (network task)
+static ResourceMonitor resources;
+
+// Job rates: Hz (0 = trigger-only) -> scheduler period
+static constexpr uint32_t periodForHz(uint32_t hz) {
+  return hz ? 1000000U / hz : util::DeadlineScheduler<1>::kTriggerOnly;
+}
+
+// Each task runs its jobs off a deadline table and sleeps in between.
+// Ids are the registration order in registerJobs().
+enum SensorJob : uint8_t { JobAngle, JobRange, JobButton, JobReset, JobGateway, SensorJobCount };
+enum NetworkJob : uint8_t { JobMqtt, JobReconnect, JobStatus, JobLink, JobTransport, JobStatusDoc,
+                            JobOta, JobMemory, JobPerf, NetworkJobCount };
+static util::DeadlineScheduler<SensorJobCount> sensorJobs;
+static util::DeadlineScheduler<NetworkJobCount> networkJobs;
+
+// ALS31300 motion wake (sensor task; the INT ISR only reads `idle`)
+static constexpr bool alsWakeMode = config::ALS_WAKE_MODE && config::ALS_INT_PIN != BoardPins::NC;
+static const GpioPin alsIntPin(config::ALS_INT_PIN, GpioMode::Input, Pull::Up, ActivePolarity::ActiveLow);
+static struct {
+  std::atomic<bool> idle{false};
+  bool        armed          = false;   // thresholds accepted by the part
+  uint32_t    stillSinceMs   = 0;
+  util::Angle stillAngle     {};
+  uint32_t    activePeriodUs = 0;       // angle period to restore on wake
+} alsWake;
+
+// Back to the sampling rate the angle job had before it went idle
+static void leaveAlsIdle(bool restorePeriod) {
+  if (!alsWake.idle) return;
+  alsWake.idle = false;
+  if (restorePeriod) sensorJobs.setPeriod(JobAngle, alsWake.activePeriodUs);
+}
 
-integ::CannonTelemetry cannonPub(mqttAdapter, "MermaidsTale");
+bool startAls(uint8_t addr) {
+  leaveAlsIdle(/*restorePeriod=*/true);   // restart() below puts the part back in active mode
+  als.restart(addr);
+  als.setFilterShift(config::ANGLE_ESTIMATOR == config::AngleEstimator::AlphaBeta
+                         ? config::ALS_PREFILTER_SHIFT : config::ALS_IIR_SHIFT);
+  angleTracker.reset();
+  if (!als.setReadMode(config::ALS_READ_MODE)) {
+    DLOG_W("ALS31300 at 0x%02X: loop mode not accepted, using indexed reads", addr);
+  }
+  alsWake.armed = alsWakeMode && als.setWakeThresholds(config::ALS_WAKE_THRESHOLD, config::ALS_WAKE_THRESHOLD);
+  if (alsWakeMode && !alsWake.armed) {
+    DLOG_W("ALS31300 at 0x%02X: motion wake not accepted, polling only", addr);
+  }
+  alsWake.stillSinceMs = millis();
+  return als.update();
+}
 
 // ============================================================================
 // MQTT MESSAGE HANDLER
 // ============================================================================
-void onMqttMessage(char *topic, byte *payload, unsigned int length) {
-  char message[128];
-  size_t len = (length < sizeof(message) - 1) ? length : sizeof(message) - 1;
-  memcpy(message, payload, len);
-  message[len] = '\0';
+// "angle=200 range=50ms status=0": values are Hz, or a period with "ms";
+// 0 leaves a job to its interrupt (timers: off). Unknown names are ignored.
+static void applyRates(char *message) {
+  char *save = nullptr;
+  for (char *tok = strtok_r(message, " ,", &save); tok; tok = strtok_r(nullptr, " ,", &save)) {
+    char *eq = strchr(tok, '=');
+    if (!eq) continue;
+    *eq = '\0';
+
+    char *end = nullptr;
+    uint32_t v = strtoul(eq + 1, &end, 10);
+    if (end == eq + 1) continue;
+    uint32_t periodUs;
+    if (strcmp(end, "ms") == 0) {
+      periodUs = v * 1000U;
+    } else {
+      if (v > config::MAX_JOB_RATE_HZ) v = config::MAX_JOB_RATE_HZ;
+      periodUs = periodForHz(v);
+    }
 
-  String topicStr = String(topic);
-  
-  // Build expected topics for this cannon
-  char resetTopic[64], statusTopic[64];
-  buildCannonTopic(resetTopic, sizeof(resetTopic), "reset");
-  buildCannonTopic(statusTopic, sizeof(statusTopic), "status");
-
-  // Handle reset command
-  if (topicStr == resetTopic && strcmp(message, "true") == 0) {
-    Serial.printf("Reset command received for Cannon%d via MQTT\n", config::CANNON_ID);
-    resetState = ResetState::PENDING;
-    resetStartTime = millis();
+    const char* name;   // the scheduler's own copy: tok is gone before the log drains
+    int id = sensorJobs.find(tok);
+    if (id >= 0) {
+      sensorJobs.setPeriod(id, periodUs);
+      name = sensorJobs.name(id);
+      if (sensorTaskHandle) xTaskNotifyGive(sensorTaskHandle);
+    } else if ((id = networkJobs.find(tok)) >= 0) {
+      if (id == JobMqtt && periodUs == 0) continue;   // would stop hearing commands
+      networkJobs.setPeriod(id, periodUs);
+      name = networkJobs.name(id);
+    } else {
+      continue;
+    }
+    DLOG_I("Job %s: period %lu us", name, static_cast<unsigned long>(periodUs));
   }
+}
 
-  // Handle status request
-  if (topicStr == statusTopic && strcmp(message, "request") == 0) {
-    Serial.printf("Status request received for Cannon%d via MQTT\n", config::CANNON_ID);
+// A last message before restarting: what the queue still holds goes out
+// first (for at most RESTART_DRAIN_MS), then `msg` behind it, then a moment
+// for the socket to send it. Network task only.
+static void sendFinalNotice(const char* topic, const char* msg, bool retain) {
+  const unsigned long start = millis();
+  auto flush = [start] {
+    while (outbound.pending() && millis() - start < config::RESTART_DRAIN_MS) {
+      outbound.drain(millis());
+      mqttAdapter.loop();
+      delay(10);
+    }
+  };
+  flush();
+  outbound.publish(topic, msg, retain, 0);
+  flush();      // `msg` itself, if its topic is queued
+  mqttAdapter.loop();
+  delay(100);   // let the reply leave
+}
+
+static void restartAfterNotice(const char* topic, const char* msg, bool retain) {
+  sendFinalNotice(topic, msg, retain);
+  ESP.restart();
+}
+
+// Command handlers: each runs on the network task for "<base>/Cannon<id>/<cmd>"
+// and the broadcast "<base>/Cannons/<cmd>" alike.
+static void onResetCommand(const mqtt::Command& cmd, void*) {
+  const char* message = cmd.text;
+  uint8_t targets = 0;
+  const char* what = "";   // a literal: the command text is gone before the log drains
+  if (strcmp(message, "true") == 0 || strcmp(message, "all") == 0) { targets = ResetAll; what = "all"; }
+  else if (strcmp(message, "angle") == 0) { targets = ResetAngle; what = "angle"; }
+  else if (strcmp(message, "distance") == 0) { targets = ResetDistance; what = "distance"; }
+
+  if (targets) {
+    DLOG_I("Reset (%s) received for Cannon%d via MQTT", what, cannonId);
+    resetRequest.fetch_or(targets);
+    if (resetState.load() == ResetState::IDLE) resetState = ResetState::PENDING;
+    sensorJobs.trigger(JobReset);
+    if (sensorTaskHandle) xTaskNotifyGive(sensorTaskHandle);
+  } else if (strcmp(message, "rescan") == 0) {
+    // Next boot rediscovers the sensors and searches for the AP
+    DLOG_I("Rescan requested for Cannon%d: clearing boot cache, restarting", cannonId);
+    bootCache.clear();
+    restartAfterNotice(topics[cannon::TopicReset], "restarting", /*retain=*/false);
+  }
+}
+
+static void onStatusCommand(const mqtt::Command& cmd, void*) {
+  // Our own retained status document arrives here too; only "request" acts
+  if (strcmp(cmd.text, "request") == 0) {
+    DLOG_I("Status request received for Cannon%d via MQTT", cannonId);
     sendStartupStatus();
   }
 }
 
+static void onTraceCommand(const mqtt::Command& cmd, void*) {
+  const char* message = cmd.text;
+  if (strncmp(message, "on", 2) == 0 && (message[2] == '\0' || message[2] == ' ')) {
+    int n = (message[2] == ' ') ? atoi(message + 3) : 0;
+    if (n <= 0) n = config::TRACE_BATCH_SAMPLES;
+    if (n > config::TRACE_MAX_BATCH) n = config::TRACE_MAX_BATCH;
+    traceBatch = static_cast<uint8_t>(n);
+    traceEnabled = true;
+    DLOG_I("Trace on for Cannon%d (%d samples per frame)", cannonId, n);
+  } else if (strcmp(message, "off") == 0) {
+    traceEnabled = false;
+    DLOG_I("Trace off for Cannon%d", cannonId);
+  }
+}
+
+static void onRatesCommand(const mqtt::Command& cmd, void*) {
+  char message[128];   // applyRates tokenizes in place
+  const size_t n = cmd.len < sizeof(message) - 1 ? cmd.len : sizeof(message) - 1;
+  memcpy(message, cmd.text, n);
+  message[n] = '\0';
+  applyRates(message);
+}
+
+// Echo the host's token with our clock, and keep probe records flowing
+static void onPingCommand(const mqtt::Command& cmd, void*) {
+  const uint32_t nowUs = micros();
+  probeCtx.armed = true;
+  probeCtx.sinceMs = millis();
+
+  char msg[integ::kMaxPongLen + 1];
+  util::BufferSink sink(msg, sizeof(msg));
+  util::TextWriter w(sink);
+  const size_t n = cmd.len < integ::kMaxPingToken ? cmd.len : integ::kMaxPingToken;
+  if (!integ::writePong(w, cmd.text, n, nowUs)) return;
+  outbound.publish(topics[cannon::TopicPong], reinterpret_cast<const uint8_t*>(msg), sink.size(), false, 0);
+}
+
+static bool probing() {
+  return probeCtx.armed && millis() - probeCtx.sinceMs < config::PROBE_HOLD_MS;
+}
+
+// One timing record, queued right behind the game message it describes
+static void publishProbe(integ::ProbeKind kind, uint32_t sampleUs, uint32_t stateUs, uint32_t publishUs) {
+  char msg[integ::kMaxProbeLen + 1];
+  util::BufferSink sink(msg, sizeof(msg));
+  util::TextWriter w(sink);
+  if (!integ::writeProbe(w, {kind, probeCtx.seq++, sampleUs, stateUs, publishUs})) return;
+  outbound.publish(topics[cannon::TopicProbe], reinterpret_cast<const uint8_t*>(msg), sink.size(), false, 0);
+}
+
+static void applyGovernorLimits() {
+  horGov.setLimits(govLimits[GovHor]);
+  for (size_t i = 0; i < gwChannels.size(); ++i) gwHorGov[i].setLimits(govLimits[GovHor]);
+}
+
+// {"hor":{"deadband":0,"interval":50,...}}: the limits in force, retained
+static void publishGovernorConfig() {
+  publishQueued<256>(topics[cannon::TopicConfigState], [](util::ByteSink& out) {
+    util::JsonWriter w(out);
+    w.beginObject();
+    for (size_t g = 0; g < GovernedTopicCount; ++g) {
+      w.key(kGovernedNames[g]);
+      util::writeGovernorLimits(w, govLimits[g]);
+    }
+    w.endObject();
+    return w.flush();
+  }, /*retain=*/true);
+}
+
+// "hor.deadband=1 hor.interval=100 hor.rate=5 hor.burst=3 hor.settle=200",
+// or "defaults". Unknown topics/limits are ignored; the result goes to NVS.
+static void onConfigCommand(const mqtt::Command& cmd, void*) {
+  char message[128];   // tokenized in place
+  const size_t n = cmd.len < sizeof(message) - 1 ? cmd.len : sizeof(message) - 1;
+  memcpy(message, cmd.text, n);
+  message[n] = '\0';
+
+  uint32_t newId = 0;
+  bool badId = false;
+  if (strcmp(message, "defaults") == 0) {
+    govLimits[GovHor] = config::HOR_GOVERNOR;
+    publishConfig.clear();
+  } else {
+    char *save = nullptr;
+    for (char *tok = strtok_r(message, " ,", &save); tok; tok = strtok_r(nullptr, " ,", &save)) {
+      if (strncmp(tok, "id=", 3) == 0) {
+        // Digits only and in DeviceIdentity's range before any narrowing:
+        // "id=258" must not wrap to Cannon2
+        char *end = nullptr;
+        const unsigned long v = strtoul(tok + 3, &end, 10);
+        if (tok[3] >= '0' && tok[3] <= '9' && *end == '\0' && v >= 1 && v <= DeviceIdentity::kMaxId) {
+          newId = static_cast<uint32_t>(v);
+        } else {
+          badId = true;
+        }
+        continue;
+      }
+      char *dot = strchr(tok, '.');
+      char *eq = strchr(tok, '=');
+      if (!dot || !eq || eq < dot) continue;
+      *dot = '\0';
+      *eq = '\0';
+      char *end = nullptr;
+      const uint32_t v = strtoul(eq + 1, &end, 10);
+      if (end == eq + 1) continue;
+      for (size_t g = 0; g < GovernedTopicCount; ++g) {
+        if (strcmp(tok, kGovernedNames[g]) == 0) util::setGovernorLimit(govLimits[g], dot + 1, v);
+      }
+    }
+    // The limits in force rather than each token: those are gone before the log drains
+    for (size_t g = 0; g < GovernedTopicCount; ++g) {
+      const util::GovernorLimits& l = govLimits[g];
+      DLOG_I("Governor %s: deadband=%u interval=%u rate=%u burst=%u settle=%u", kGovernedNames[g],
+             l.deadband, l.minIntervalMs, l.ratePerSec, l.burst, l.settleMs);
+    }
+    publishConfig.save(govLimits, GovernedTopicCount);
+  }
+  applyGovernorLimits();
+  publishGovernorConfig();
+
+  // New cannon id: every topic changes, so restart under it (unicast use only;
+  // the same id on every cannon is never what a broadcast meant)
+  if (badId) {
+    DLOG_W("Cannon id rejected (1..%u)", static_cast<unsigned>(DeviceIdentity::kMaxId));
+    return;
+  }
+  if (newId && newId != cannonId && strstr(cmd.topic, cannon::Topics::kBroadcast) == nullptr) {
+    if (!deviceIdentity.save(static_cast<uint8_t>(newId))) {
+      DLOG_W("Cannon id %lu not saved", static_cast<unsigned long>(newId));
+      return;
+    }
+    DLOG_I("Cannon%d becomes Cannon%lu: restarting", cannonId, static_cast<unsigned long>(newId));
+    char moved[24];
+    snprintf(moved, sizeof(moved), "moved to Cannon%lu", static_cast<unsigned long>(newId));
+    restartAfterNotice(topics[cannon::TopicStatus], moved, /*retain=*/true);   // replaces our retained status
+  }
+}
+
+// One line on CannonN/ota/status (retained): where an update stands, or
+// which slot is running ("confirmed app1")
+static void publishOtaStatus(const char* what) {
+  char msg[96];
+  util::BufferSink sink(msg, sizeof(msg));
+  util::TextWriter w(sink);
+  w.str(what);
+  switch (otaUpdate.state()) {
+    case ota::Update::State::Downloading:
+      w.str(" ").u32(otaUpdate.received());
+      if (otaUpdate.total() > 0) w.str("/").u32(static_cast<uint32_t>(otaUpdate.total()));
+      w.str(otaUpdate.compressed() ? " bytes (gzip)" : " bytes");
+      break;
+    case ota::Update::State::Failed:
+      w.str(": ").str(otaUpdate.error());
+      break;
+    default:
+      w.str(" ").str(ota::Update::runningLabel());
+      break;
+  }
+  outbound.publish(topics[cannon::TopicOtaStatus],
+                   reinterpret_cast<const uint8_t*>(msg), sink.size(), true, 0);
+}
+
+// "http://host:port/path.bin[.gz]" -> update; "confirm", "rollback", "abort"
+static void onOtaCommand(const mqtt::Command& cmd, void*) {
+  const char* message = cmd.text;
+  if (strncmp(message, "http://", 7) == 0) {
+    // Whichever link carries MQTT now carries the download
+    net::INetClient& link = eth.isUp() ? static_cast<net::INetClient&>(otaEthNet)
+                                       : static_cast<net::INetClient&>(otaWifiNet);
+    if (!otaUpdate.start(link, message, config::OTA_HTTP_TIMEOUT_MS, config::OTA_HTTP_CONNECT_MS)) {
+      DLOG_W("OTA for Cannon%d not started: %s", cannonId,
+             otaUpdate.state() == ota::Update::State::Downloading ? "already running" : otaUpdate.error());
+      if (otaUpdate.state() == ota::Update::State::Failed) publishOtaStatus("failed");
+      return;
+    }
+    DLOG_I("OTA for Cannon%d: download started", cannonId);   // the URL is transient
+    publishOtaStatus("downloading");
+    networkJobs.setPeriod(JobOta, config::OTA_STEP_MS * 1000U);
+    networkJobs.trigger(JobOta);
+  } else if (strcmp(message, "abort") == 0 && otaUpdate.state() == ota::Update::State::Downloading) {
+    otaUpdate.abort("aborted");
+    networkJobs.setPeriod(JobOta, config::OTA_IDLE_POLL_MS * 1000U);
+    publishOtaStatus("failed");
+  } else if (strcmp(message, "confirm") == 0 && otaTrial) {
+    ota::Update::confirm();
+    otaTrial = false;
+    publishOtaStatus("confirmed");
+  } else if (strcmp(message, "rollback") == 0) {
+    DLOG_I("OTA rollback requested for Cannon%d", cannonId);
+    sendFinalNotice(topics[cannon::TopicOtaStatus], "rolling back", /*retain=*/true);
+    ota::Update::rollback();
+    publishOtaStatus("rollback unavailable, still on");
+  }
+}
+
+void onMqttMessage(const char *topic, const uint8_t *payload, size_t length) {
+  commands.dispatch(topic, payload, length);
+}
+
+void registerCommands() {
+  // The broker forwards only our own command topics plus one broadcast filter
+  for (cannon::Topic t : cannon::Topics::kCommands) commands.subscribe(topics[t], 0);
+  commands.subscribe({topics.room(), cannon::Topics::kBroadcast, "+"}, 0);
+
+  // "+" routes unicast and broadcast to the same handler
+  commands.on({topics.room(), "+", "reset"},  &onResetCommand);
+  commands.on({topics.room(), "+", "status"}, &onStatusCommand);
+  commands.on({topics.room(), "+", "trace"},  &onTraceCommand);
+  commands.on({topics.room(), "+", "rates"},  &onRatesCommand);
+  commands.on({topics.room(), "+", "config"}, &onConfigCommand);
+  commands.on({topics.room(), "+", "ota"},    &onOtaCommand);
+  commands.on({topics.room(), "+", "ping"},   &onPingCommand);
+}
+
+void routeOutbound() {
+  using mqtt::QueuePolicy;
+  outbound.route(topics[cannon::TopicHor],         QueuePolicy::LatestWins);     // only the newest angle matters
+  outbound.route(topics[cannon::TopicStatus],      QueuePolicy::ReplaceInPlace); // retained documents
+  outbound.route(topics[cannon::TopicDiagnostics], QueuePolicy::ReplaceInPlace);
+  outbound.route(topics[cannon::TopicBoot],        QueuePolicy::ReplaceInPlace);
+  outbound.route(topics[cannon::TopicConfigState], QueuePolicy::ReplaceInPlace);
+  outbound.route(topics[cannon::TopicMemory],      QueuePolicy::ReplaceInPlace);
+  outbound.route(topics[cannon::TopicI2C],         QueuePolicy::LatestWins);     // boot scan summary
+  outbound.route(topics[cannon::TopicOtaStatus],   QueuePolicy::LatestWins);     // update progress
+  outbound.route(topics[cannon::TopicLoaded],      QueuePolicy::Fifo);           // game events, in order
+  outbound.route(topics[cannon::TopicFired],       QueuePolicy::Fifo);
+  outbound.route(topics[cannon::TopicLoadedAt],    QueuePolicy::Fifo);
+  outbound.route(topics[cannon::TopicFiredAt],     QueuePolicy::Fifo);
+  outbound.route(topics[cannon::TopicProbe],       QueuePolicy::Fifo);           // behind the message it times
+  outbound.route(topics[cannon::TopicPong],        QueuePolicy::Fifo);
+  for (size_t i = 0; i < gwChannels.size(); ++i) {
+    const cannon::Topics& t = gwTopics[i];
+    outbound.route(t[cannon::TopicHor],     QueuePolicy::LatestWins);
+    outbound.route(t[cannon::TopicStatus],  QueuePolicy::ReplaceInPlace);
+    outbound.route(t[cannon::TopicFired],   QueuePolicy::Fifo);
+    outbound.route(t[cannon::TopicFiredAt], QueuePolicy::Fifo);
+  }
+  outbound.setDrainRate(config::OUTBOUND_DRAIN_PER_SEC, config::OUTBOUND_DRAIN_BURST);
+}
+
+void startGateway() {
+  for (const config::GatewayChannel& c : config::GATEWAY_CHANNELS) {
+    if (!config::GATEWAY_MODE) break;
+    // The id comes from NVS now, so a clash is only known at run time
+    if (c.cannonId == cannonId) {
+      Serial.printf("Gateway: Cannon%u is this board's own id - channel skipped\n", c.cannonId);
+      continue;
+    }
+    const int i = gwChannels.add(c.cannonId, c.alsAddr, config::ALS_PREFILTER_SHIFT,
+                                 config::BUTTON_DEBOUNCE_MS * 1000U);
+    if (i < 0) break;
+    gwTopics[i].build("MermaidsTale", c.cannonId);
+    gwHorGov[i] = util::PublishGovernor(360);
+    gwButtonPins[i] = c.buttonPin;
+    if (c.buttonPin != BoardPins::NC) pinMode(c.buttonPin, INPUT_PULLUP);   // active low, like ours
+  }
+  if (gwChannels.size()) {
+    Serial.printf("Gateway mode: %u extra cannon(s) on this board\n",
+                  static_cast<unsigned>(gwChannels.size()));
+  }
+}
+
+
 // ============================================================================
 // RESET HANDLER (Non-blocking state machine)
 // ============================================================================
-void handleReset() {
-  if (resetState == ResetState::PENDING && millis() - resetStartTime > 100) {
-    resetState = ResetState::IN_PROGRESS;
-    
-    Serial.printf("Executing sensor reset for Cannon%d...\n", config::CANNON_ID);
-    
-    // Build topics for this cannon
-    char sensorsTopic[64], resetTopic[64];
-    buildCannonTopic(sensorsTopic, sizeof(sensorsTopic), "sensors");
-    buildCannonTopic(resetTopic, sizeof(resetTopic), "reset");
-    
-    // Reset sensor states
-    vl6180xInitialized = false;
-    als31300Initialized = false;
-    
-    // Reinitialize VL6180X
-    if (distanceSensor.begin()) {
-      vl6180xInitialized = true;
-      Serial.println("VL6180X reset successful");
-      mqttAdapter.publish(sensorsTopic, "VL6180X reset OK", false, 0);
-    } else {
-      Serial.println("VL6180X reset failed");
-      mqttAdapter.publish(sensorsTopic, "VL6180X reset failed", false, 0);
-    }
-    
-    // Reinitialize ALS31300
-    uint8_t alsAddr = alsAddressDetected ? detectedALS_ADDR : config::ALS_FALLBACK_ADDR;
-    als = ALS31300::Sensor(alsAddr);
-    
-    if (als.update()) {
-      als31300Initialized = true;
-      Serial.println("ALS31300 reset successful");
-      mqttAdapter.publish(sensorsTopic, "ALS31300 reset OK", false, 0);
-    } else {
-      Serial.println("ALS31300 reset failed");
-      mqttAdapter.publish(sensorsTopic, "ALS31300 reset failed", false, 0);
+// Runs as the sensor task's "reset" job, one step per run with
+// RESET_STEP_GAP_MS in between, so angle/range jobs interleave. Only the
+// sensor being reset stops sampling; clearBus() runs only if a probe fails.
+enum class ResetStep : uint8_t {
+  Idle, VlStop, VlProbe, VlRecover, VlInit, VlRanging, AlsProbe, AlsRecover, AlsStart, Finish
+};
+static struct {
+  ResetStep step      = ResetStep::Idle;
+  uint8_t   targets   = 0;
+  bool      recovered = false;   // clearBus() already tried for the current sensor
+} resetCtx;
+
+static ResetStep beginAngleReset() {
+  als31300Initialized = false;           // angleJob idles; the VL6180X keeps ranging
+  resetCtx.recovered = false;
+  return ResetStep::AlsProbe;
+}
+
+static ResetStep afterDistanceReset() {
+  return (resetCtx.targets & ResetAngle) ? beginAngleReset() : ResetStep::Finish;
+}
+
+static uint8_t alsResetAddr() {
+  return alsAddressDetected ? detectedALS_ADDR : config::ALS_FALLBACK_ADDR;
+}
+
+static void resetJob(void*) {
+  PROF_SCOPE("sensor.reset");
+  const uint32_t now = micros();
+
+  switch (resetCtx.step) {
+    case ResetStep::Idle:
+      // The previous result is reported first; publishResetResult() re-triggers
+      if (resetState.load() == ResetState::COMPLETE) return;
+      resetCtx.targets = resetRequest.exchange(0);
+      if (!resetCtx.targets) return;
+      resetState = ResetState::IN_PROGRESS;
+      if (resetCtx.targets & ResetDistance) vl6180xResetOk = false;
+      if (resetCtx.targets & ResetAngle) als31300ResetOk = false;
+      resetCtx.step = (resetCtx.targets & ResetDistance) ? ResetStep::VlStop : beginAngleReset();
+      break;
+
+    // VL6180X
+    case ResetStep::VlStop:
+      vl6180xInitialized = false;            // rangeJob idles; the ALS keeps sampling
+      ranging.stop();
+      resetCtx.recovered = false;
+      resetCtx.step = ResetStep::VlProbe;
+      break;
+
+    case ResetStep::VlProbe:
+      vl6180xProbeError = rangeBus.probe(0x29);
+      if (vl6180xProbeError == 0) {
+        resetCtx.step = ResetStep::VlInit;
+      } else if (!resetCtx.recovered) {
+        resetCtx.step = ResetStep::VlRecover;
+      } else {
+        resetCtx.step = afterDistanceReset();
+      }
+      break;
+
+    case ResetStep::VlRecover:
+      DLOG_W("VL6180X not answering - clearing bus");
+      rangeBus.clearBus();
+      resetCtx.recovered = true;
+      resetCtx.step = ResetStep::VlProbe;
+      break;
+
+    case ResetStep::VlInit:
+      resetCtx.step = distanceSensor.begin(&rangeBus.wire()) ? ResetStep::VlRanging
+                                                             : afterDistanceReset();
+      break;
+
+    case ResetStep::VlRanging:
+      vl6180xResetOk = ranging.start(config::VL6180X_RANGING);
+      vl6180xInitialized = vl6180xResetOk.load();
+      resetCtx.step = afterDistanceReset();
+      break;
+
+    // ALS31300
+    case ResetStep::AlsProbe: {
+      const uint8_t index = 0x00;
+      if (ctrl.i2c().write(alsResetAddr(), &index, 1)) {
+        resetCtx.step = ResetStep::AlsStart;
+      } else if (!resetCtx.recovered) {
+        resetCtx.step = ResetStep::AlsRecover;
+      } else {
+        resetCtx.step = ResetStep::Finish;
+      }
+      break;
     }
-    
-    mqttAdapter.publish(resetTopic, "complete", false, 0);
-    Serial.println("Reset complete");
-    
-    // Send updated status report after reset
-    delay(100); // Brief pause to ensure MQTT messages are sent
-    sendStartupStatus();
-    
+
+    case ResetStep::AlsRecover:
+      DLOG_W("ALS31300 not answering - clearing bus");
+      ctrl.i2c().clearBus();
+      resetCtx.recovered = true;
+      resetCtx.step = ResetStep::AlsProbe;
+      break;
+
+    case ResetStep::AlsStart:
+      als31300ResetOk = startAls(alsResetAddr());
+      als31300Initialized = als31300ResetOk.load();
+      resetCtx.step = ResetStep::Finish;
+      break;
+
+    case ResetStep::Finish:
+      resetCtx.step = ResetStep::Idle;
+      resetDone = resetCtx.targets;
+      resetState = ResetState::COMPLETE;
+      networkJobs.trigger(JobMqtt);
+      if (networkTaskHandle) xTaskNotifyGive(networkTaskHandle);
+      return;
+  }
+  sensorJobs.defer(JobReset, config::RESET_STEP_GAP_MS * 1000U, now);
+}
+
+// Runs on the network task once the sensor task has finished the reset.
+void publishResetResult() {
+  if (resetState.load() != ResetState::COMPLETE) return;
+
+  const uint8_t done = resetDone.load();
+  DLOG_I("Sensor reset executed for Cannon%d", cannonId);
+
+  const char* sensorsTopic = topics[cannon::TopicSensors];
+
+  if (done & ResetDistance) {
+    DLOG_I(vl6180xResetOk ? "VL6180X reset successful" : "VL6180X reset failed");
+    outbound.publish(sensorsTopic, vl6180xResetOk ? "VL6180X reset OK" : "VL6180X reset failed", false, 0);
+  }
+  if (done & ResetAngle) {
+    DLOG_I(als31300ResetOk ? "ALS31300 reset successful" : "ALS31300 reset failed");
+    outbound.publish(sensorsTopic, als31300ResetOk ? "ALS31300 reset OK" : "ALS31300 reset failed", false, 0);
+  }
+
+  outbound.publish(topics[cannon::TopicReset], "complete", false, 0);
+  DLOG_I("Reset complete");
+
+  // Updated status report, on its own pass shortly after
+  networkJobs.defer(JobStatusDoc, config::RESET_STATUS_DELAY_MS * 1000U, micros());
+
+  // A request that arrived mid-run starts the next one
+  if (resetRequest.load()) {
+    resetState = ResetState::PENDING;
+    sensorJobs.trigger(JobReset);
+    if (sensorTaskHandle) xTaskNotifyGive(sensorTaskHandle);
+  } else {
     resetState = ResetState::IDLE;
   }
 }
@@ -199,144 +990,157 @@ void handleReset() {
 // ============================================================================
 // MQTT RECONNECTION HANDLER
 // ============================================================================
+// Runs as the "reconnect" job, every MQTT_RECONNECT_CHECK_MS by default.
 void handleMqttReconnection() {
-  static unsigned long lastMqttCheck = 0;
-  
-  if (millis() - lastMqttCheck > config::MQTT_RECONNECT_CHECK_MS) {
-    lastMqttCheck = millis();
+  if (!networkUp()) return;   // linkJob triggers this job when a link appears
+  if (!mqttAdapter.connected()) {
+    DLOG_W("MQTT disconnected for Cannon%d, attempting reconnect...", cannonId);
     
-    if (!mqttAdapter.connected()) {
-      Serial.printf("MQTT disconnected for Cannon%d, attempting reconnect...\n", config::CANNON_ID);
-      
-      if (mqttAdapter.connect()) {
-        // Build topics for this cannon
-        char resetTopic[64], statusTopic[64];
-        buildCannonTopic(resetTopic, sizeof(resetTopic), "reset");
-        buildCannonTopic(statusTopic, sizeof(statusTopic), "status");
-        
-        // Resubscribe after reconnection
-        mqttAdapter.subscribe(resetTopic, 0);
-        mqttAdapter.subscribe(statusTopic, 0);
-        Serial.printf("MQTT reconnected for Cannon%d and resubscribed\n", config::CANNON_ID);
-      } else {
-        Serial.println("MQTT reconnection failed");
-      }
+    if (mqttAdapter.connect()) {
+      // Every command filter again, as one SUBSCRIBE
+      commands.resubscribe(mqttAdapter);
+      DLOG_I("MQTT reconnected for Cannon%d and resubscribed", cannonId);
+    } else {
+      DLOG_W("MQTT reconnection failed");
     }
   }
 }
 
 // ============================================================================
-// STARTUP STATUS (Fixed string concatenation issues)
+// STARTUP STATUS (bounds-checked builders, no printf formatting)
 // ============================================================================
+// "a.b.c.d" without going through String
+static void writeIp(util::TextWriter& w, const IPAddress& ip) {
+  w.u32(ip[0]).ch('.').u32(ip[1]).ch('.').u32(ip[2]).ch('.').u32(ip[3]);
+}
+
+// Retained one-line status for gateway channel i, on its own CannonN/status
+static void publishGatewayStatus(size_t i) {
+  char msg[96];
+  util::BufferSink sink(msg, sizeof(msg));
+  util::TextWriter w(sink);
+  w.str("Cannon").u32(gwChannels.cannonId(i)).str(" online - ")
+   .str(gwChannels.online(i) ? "Angle ✓ " : "Angle ✗ ")
+   .str("- via Cannon").u32(cannonId);
+  outbound.publish(gwTopics[i][cannon::TopicStatus],
+                   reinterpret_cast<const uint8_t*>(msg), sink.size(), true, 0);
+}
+
 void sendStartupStatus() {
-  Serial.printf("=== Cannon%d Startup Status ===\n", config::CANNON_ID);
+  Serial.printf("=== Cannon%d Startup Status ===\n", cannonId);
 
   char statusMsg[256];
-  char detailedMsg[512];
-  int statusLen = 0;
-  int detailLen = 0;
+  char detailedMsg[768];   // room for the gateway channels' health
+  util::BufferSink statusSink(statusMsg, sizeof(statusMsg));
+  util::BufferSink detailSink(detailedMsg, sizeof(detailedMsg));
+  util::TextWriter status(statusSink);
+  util::TextWriter detail(detailSink);
   bool allGood = true;
 
-  statusLen += snprintf(statusMsg + statusLen, sizeof(statusMsg) - statusLen, 
-                        "Cannon%d online - ", config::CANNON_ID);
+  status.str("Cannon").u32(cannonId).str(" online - ");
 
   // Check WiFi
   if (WiFi.status() == WL_CONNECTED) {
-    statusLen += snprintf(statusMsg + statusLen, sizeof(statusMsg) - statusLen, "WiFi ✓ ");
-    detailLen += snprintf(detailedMsg + detailLen, sizeof(detailedMsg) - detailLen,
-                         "WiFi: Connected to %s (IP: %s) | ", 
-                         WiFi.SSID().c_str(), WiFi.localIP().toString().c_str());
-    Serial.printf("✓ WiFi connected to %s (IP: %s)\n", 
-                  WiFi.SSID().c_str(), WiFi.localIP().toString().c_str());
+    // Straight from the driver: WiFi.SSID() would build a String
+    wifi_ap_record_t ap = {};
+    const char* ssid = esp_wifi_sta_get_ap_info(&ap) == ESP_OK
+                           ? reinterpret_cast<const char*>(ap.ssid) : cfg::WIFI_SSID;
+    const IPAddress ip = WiFi.localIP();
+    status.str("WiFi ✓ ");
+    detail.str("WiFi: Connected to ").str(ssid).str(" (IP: ");
+    writeIp(detail, ip);
+    detail.str(") | ");
+    Serial.printf("✓ WiFi connected to %s (IP: %u.%u.%u.%u)\n",
+                  ssid, ip[0], ip[1], ip[2], ip[3]);
   } else {
-    statusLen += snprintf(statusMsg + statusLen, sizeof(statusMsg) - statusLen, "WiFi ✗ ");
+    status.str("WiFi ✗ ");
     
     const char* wifiErrorMsg = "Unknown error";
     if (WiFi.status() == WL_NO_SSID_AVAIL) wifiErrorMsg = "Network not found";
     else if (WiFi.status() == WL_CONNECT_FAILED) wifiErrorMsg = "Connection failed";
     else if (WiFi.status() == WL_CONNECTION_LOST) wifiErrorMsg = "Connection lost";
     
-    detailLen += snprintf(detailedMsg + detailLen, sizeof(detailedMsg) - detailLen,
-                         "WiFi: Failed - %s | ", wifiErrorMsg);
+    detail.str("WiFi: Failed - ").str(wifiErrorMsg).str(" | ");
     Serial.printf("✗ WiFi: %s\n", wifiErrorMsg);
     allGood = false;
   }
 
   // Check MQTT
   if (mqttAdapter.connected()) {
-    statusLen += snprintf(statusMsg + statusLen, sizeof(statusMsg) - statusLen, "MQTT ✓ ");
-    detailLen += snprintf(detailedMsg + detailLen, sizeof(detailedMsg) - detailLen,
-                         "MQTT: Connected and subscribed | ");
+    status.str("MQTT ✓ ");
+    detail.str("MQTT: Connected and subscribed | ");
     Serial.println("✓ MQTT connected and ready");
   } else {
-    statusLen += snprintf(statusMsg + statusLen, sizeof(statusMsg) - statusLen, "MQTT ✗ ");
-    detailLen += snprintf(detailedMsg + detailLen, sizeof(detailedMsg) - detailLen,
-                         "MQTT: Disconnected | ");
+    status.str("MQTT ✗ ");
+    detail.str("MQTT: Disconnected | ");
     Serial.println("✗ MQTT: Disconnected");
     allGood = false;
   }
 
   // Check VL6180X
   if (vl6180xInitialized) {
-    statusLen += snprintf(statusMsg + statusLen, sizeof(statusMsg) - statusLen, "Distance ✓ ");
-    detailLen += snprintf(detailedMsg + detailLen, sizeof(detailedMsg) - detailLen,
-                         "VL6180X: Online at 0x29 | ");
+    status.str("Distance ✓ ");
+    detail.str("VL6180X: Online at 0x29 | ");
     Serial.println("✓ VL6180X distance sensor ready");
   } else {
-    statusLen += snprintf(statusMsg + statusLen, sizeof(statusMsg) - statusLen, "Distance ✗ ");
-    Wire.beginTransmission(0x29);
-    uint8_t vl_error = Wire.endTransmission();
+    status.str("Distance ✗ ");
+    // Probe result recorded by the sensor task; keep the bus to its owner
+    uint8_t vl_error = vl6180xProbeError;
     
     const char* distError = (vl_error != 0) 
       ? "Not responding on I2C - Check wiring" 
       : "I2C OK but init failed";
     
-    detailLen += snprintf(detailedMsg + detailLen, sizeof(detailedMsg) - detailLen,
-                         "VL6180X: %s | ", distError);
+    detail.str("VL6180X: ").str(distError).str(" | ");
     Serial.printf("✗ VL6180X: %s\n", distError);
     allGood = false;
   }
 
   // Check ALS31300
   if (als31300Initialized) {
-    statusLen += snprintf(statusMsg + statusLen, sizeof(statusMsg) - statusLen, "Angle ✓ ");
+    status.str("Angle ✓ ");
     uint8_t usedAddr = alsAddressDetected ? detectedALS_ADDR : config::ALS_FALLBACK_ADDR;
-    detailLen += snprintf(detailedMsg + detailLen, sizeof(detailedMsg) - detailLen,
-                         "ALS31300: Online at 0x%02X | ", usedAddr);
+    detail.str("ALS31300: Online at 0x").hex(usedAddr, 2).str(" | ");
     Serial.printf("✓ ALS31300 angle sensor ready at 0x%02X\n", usedAddr);
   } else {
-    statusLen += snprintf(statusMsg + statusLen, sizeof(statusMsg) - statusLen, "Angle ✗ ");
+    status.str("Angle ✗ ");
     const char* angleError = alsAddressDetected 
       ? "Detected but not responding" 
       : "No device detected";
     
-    detailLen += snprintf(detailedMsg + detailLen, sizeof(detailedMsg) - detailLen,
-                         "ALS31300: %s | ", angleError);
+    detail.str("ALS31300: ").str(angleError).str(" | ");
     Serial.printf("✗ ALS31300: %s\n", angleError);
     allGood = false;
   }
 
+  // Gateway channels: health in our diagnostics, a status line on each one's own topic
+  if (gwChannels.size()) {
+    detail.str("Gateway: ");
+    gwChannels.writeHealth(detail, micros());
+    detail.str(" | ");
+    for (size_t i = 0; i < gwChannels.size(); ++i) {
+      if (!gwChannels.online(i)) allGood = false;
+      publishGatewayStatus(i);
+    }
+  }
+
   // Final status
   if (allGood) {
-    statusLen += snprintf(statusMsg + statusLen, sizeof(statusMsg) - statusLen,
-                         "- Ready to fire! 🎯");
+    status.str("- Ready to fire! 🎯");
     Serial.println("🎯 All systems ready!");
   } else {
-    statusLen += snprintf(statusMsg + statusLen, sizeof(statusMsg) - statusLen,
-                         "- Issues detected");
+    status.str("- Issues detected");
     Serial.println("⚠️ Issues detected");
   }
 
-  // Send to MQTT
-  if (mqttAdapter.connected()) {
-    char statusTopic[64], diagnosticsTopic[64];
-    buildCannonTopic(statusTopic, sizeof(statusTopic), "status");
-    buildCannonTopic(diagnosticsTopic, sizeof(diagnosticsTopic), "diagnostics");
-    
-    mqttAdapter.publish(statusTopic, statusMsg, true, 0);
-    mqttAdapter.publish(diagnosticsTopic, detailedMsg, true, 0);
-    Serial.println("Status messages sent via MQTT");
-  }
+  // Send to MQTT (held in the outbound queue while disconnected).
+  // Truncated builders still publish what fit, as the old snprintf chain did.
+  outbound.publish(topics[cannon::TopicStatus],
+                   reinterpret_cast<const uint8_t*>(statusMsg), statusSink.size(), true, 0);
+  outbound.publish(topics[cannon::TopicDiagnostics],
+                   reinterpret_cast<const uint8_t*>(detailedMsg), detailSink.size(), true, 0);
+  Serial.println(mqttAdapter.connected() ? "Status messages sent via MQTT"
+                                         : "Status messages queued until MQTT reconnects");
 
   Serial.println("===============================");
 }
@@ -344,19 +1148,9 @@ void sendStartupStatus() {
 // ============================================================================
 // I2C SCANNER (Improved ALS detection)
 // ============================================================================
-void scanI2CDevices() {
-  Serial.println("\nScanning I2C bus...");
-  
-  char i2cTopic[64];
-  buildCannonTopic(i2cTopic, sizeof(i2cTopic), "i2c");
-  mqttAdapter.publish(i2cTopic, "Scanning I2C bus...", false, 0);
-
-  int deviceCount = 0;
-  alsAddressDetected = false;
-
+static void scanBus(I2CBus& bus, int& deviceCount) {
   for (uint8_t address = 1; address < 127; address++) {
-    Wire.beginTransmission(address);
-    uint8_t error = Wire.endTransmission();
+    uint8_t error = bus.probe(address);
 
     if (error == 0) {
       char deviceMsg[128];
@@ -371,9 +1165,8 @@ void scanI2CDevices() {
       // ALS31300 can be at 0x60-0x6F depending on programming
       else if (address >= 0x60 && address <= 0x6F) {
         // Try to verify this is actually an ALS31300
-        Wire.beginTransmission(address);
-        Wire.write(0x00);
-        if (Wire.endTransmission() == 0) {
+        const uint8_t index = 0x00;
+        if (bus.write(address, &index, 1)) {
           detectedALS_ADDR = address;
           alsAddressDetected = true;
           msgLen += snprintf(deviceMsg + msgLen, sizeof(deviceMsg) - msgLen,
@@ -386,10 +1179,19 @@ void scanI2CDevices() {
       }
 
       Serial.println(deviceMsg);
-      mqttAdapter.publish(i2cTopic, deviceMsg, false, 0);
       deviceCount++;
     }
   }
+}
+
+void scanI2CDevices() {
+  Serial.println("\nScanning I2C bus...");
+  
+  int deviceCount = 0;
+  alsAddressDetected = false;
+
+  scanBus(ctrl.i2c(), deviceCount);
+  if (&rangeBus != &ctrl.i2c()) scanBus(rangeBus, deviceCount);
 
   char resultMsg[128];
   if (deviceCount == 0) {
@@ -403,27 +1205,181 @@ void scanI2CDevices() {
     Serial.println(resultMsg);
   }
 
-  mqttAdapter.publish(i2cTopic, resultMsg, false, 0);
+  // Runs before MQTT is up: held in the outbound queue until the first connect
+  outbound.publish(topics[cannon::TopicI2C], resultMsg, false, 0);
   Serial.println();
 }
 
+// ============================================================================
+// FAST BOOT
+// ============================================================================
+// How this boot went (bootCache holds what the last one learned)
+static struct {
+  bool cacheHit      = false;   // NVS entry loaded
+  bool sensorsCached = false;   // sensors answered at the cached addresses (no scan)
+  bool wifiCached    = false;   // joining the cached AP/channel
+  bool wifiFastJoin  = false;   // cached join still within WIFI_FAST_JOIN_MS
+  bool published     = false;   // boot-to-first-publish reported
+} bootInfo;
+static uint32_t wifiJoinStartMs = 0;
+
+static void startWifi() {
+  WiFi.mode(WIFI_STA);
+  WiFi.persistent(false);       // the boot cache keeps what we need
+  const BootCache::Data& c = bootCache.data();
+  if (config::FAST_BOOT && bootCache.wifiKnown()) {
+    // No scan: straight to the known AP; with the old lease, no DHCP either
+    if (config::WIFI_CACHE_IP && c.ip) {
+      WiFi.config(IPAddress(c.ip), IPAddress(c.gateway), IPAddress(c.mask), IPAddress(c.dns));
+    }
+    WiFi.begin(cfg::WIFI_SSID, cfg::WIFI_PASS, c.channel, c.bssid);
+    bootInfo.wifiCached = bootInfo.wifiFastJoin = true;
+    Serial.printf("WiFi: joining cached AP on channel %u\n", c.channel);
+  } else {
+    WiFi.begin(cfg::WIFI_SSID, cfg::WIFI_PASS);
+  }
+  wifiJoinStartMs = millis();
+}
+
+// Runs in linkJob: falls back to a full search when the cached AP does not
+// answer, and records AP/channel/lease after every association.
+static void pollWifi(uint32_t nowMs) {
+  static bool recorded = false;
+  if (WiFi.status() == WL_CONNECTED) {
+    bootInfo.wifiFastJoin = false;
+    if (config::FAST_BOOT && !recorded) {
+      BootCache::Data& c = bootCache.data();
+      if (const uint8_t* bssid = WiFi.BSSID()) memcpy(c.bssid, bssid, sizeof(c.bssid));
+      c.channel = static_cast<uint8_t>(WiFi.channel());
+      c.ip      = static_cast<uint32_t>(WiFi.localIP());
+      c.gateway = static_cast<uint32_t>(WiFi.gatewayIP());
+      c.mask    = static_cast<uint32_t>(WiFi.subnetMask());
+      c.dns     = static_cast<uint32_t>(WiFi.dnsIP());
+      bootCache.save();
+      recorded = true;
+    }
+    return;
+  }
+  recorded = false;
+
+  if (bootInfo.wifiFastJoin && nowMs - wifiJoinStartMs >= config::WIFI_FAST_JOIN_MS) {
+    Serial.println("WiFi: cached AP not answering - full search");
+    bootInfo.wifiCached = bootInfo.wifiFastJoin = false;
+    WiFi.disconnect();
+    WiFi.config(IPAddress(), IPAddress(), IPAddress());   // back to DHCP
+    WiFi.begin(cfg::WIFI_SSID, cfg::WIFI_PASS);
+  }
+}
+
+// Ethernet (non-blocking) and WiFi together; whichever is up first carries
+// MQTT, and the transport job moves it to Ethernet later if needed
+static void startNetwork() {
+  if (config::USE_ETHERNET) {
+    byte mac[6];
+    esp_read_mac(mac, ESP_MAC_ETH);
+    eth.setMac(mac);
+    if (!eth.startDhcpWorker(config::ETH_DHCP_TASK_PRIORITY, config::ETH_DHCP_TASK_CORE)) {
+      Serial.println("[ETH] DHCP worker not started - DHCP runs on the network task");
+    }
+    eth.start();
+    transport.add("eth", ethNet, &ethLinkUp);
+  }
+  transport.add("wifi", wifiNet, &wifiLinkUp);
+  startWifi();
+}
+
+// Client setup only; the reconnect job connects as soon as a link is up
+static void startMqtt() {
+  mqtt::Config mqttConfig;
+  mqttConfig.brokerHost = cfg::MQTT_HOST;
+  mqttConfig.brokerPort = cfg::MQTT_PORT;
+
+  // Generate dynamic client ID: "cannon-1", "cannon-2", etc.
+  static char clientId[32];
+  snprintf(clientId, sizeof(clientId), "cannon-%d", cannonId);
+  mqttConfig.clientId = clientId;
+
+  nativeMqtt.setConnectTimeoutMs(config::MQTT_CONNECT_TIMEOUT_MS);
+  nativeMqtt.setTcpTimeoutMs(config::MQTT_TCP_TIMEOUT_MS);
+  nativeMqtt.setAckHook(&recordPublishLatency);
+  mqttAdapter.begin(mqttConfig);
+  mqttAdapter.onMessage(onMqttMessage);  // also serves later reconnects
+}
+
+// Probe the cached addresses; scan both buses only on a miss
+static void discoverSensors() {
+  const BootCache::Data& c = bootCache.data();
+  const uint8_t index = 0x00;
+  if (config::FAST_BOOT && bootCache.sensorsKnown() &&
+      ctrl.i2c().write(c.alsAddr, &index, 1) &&
+      (!c.vlPresent || rangeBus.probe(0x29) == 0)) {
+    detectedALS_ADDR = c.alsAddr;
+    alsAddressDetected = true;
+    bootInfo.sensorsCached = true;
+    Serial.printf("Boot cache: ALS31300 at 0x%02X%s - bus scan skipped\n",
+                  c.alsAddr, c.vlPresent ? ", VL6180X at 0x29" : "");
+    return;
+  }
+  if (config::FAST_BOOT) Serial.println("Boot cache miss - full I2C scan");
+  scanI2CDevices();
+}
+
+// First time MQTT is up: report how long the boot took to reach the broker
+static void reportBootTime() {
+  if (bootInfo.published) return;
+  bootInfo.published = true;
+
+  char msg[96];
+  util::BufferSink sink(msg, sizeof(msg));
+  util::TextWriter w(sink);
+  w.str("first_publish_ms=").u32(millis())
+   .str(" sensors=").str(bootInfo.sensorsCached ? "cached" : "scanned")
+   .str(" wifi=").str(bootInfo.wifiCached ? "cached" : "searched")
+   .str(" via=").str(config::USE_NATIVE_MQTT ? transport.activeName() : "wifi");
+  Serial.printf("Boot to first publish: %lu ms (%s)\n", millis(), msg);
+  outbound.publish(topics[cannon::TopicBoot],
+                   reinterpret_cast<const uint8_t*>(msg), sink.size(), true, 0);
+
+  // Which slot came up, and whether it is a new image on trial
+  publishOtaStatus(ota::Update::takeRolledBack() ? "rolled back to" : otaTrial ? "trial" : "running");
+}
+
 // ============================================================================
 // SETUP
 // ============================================================================
 void setup() {
   Serial.begin(115200);
-  delay(config::STARTUP_SETTLE_MS);
+  if (!config::FAST_BOOT) delay(config::STARTUP_SETTLE_MS);
+
+  // A new image on trial counts this boot; too many without confirm() and
+  // the previous slot boots instead (does not return then)
+  ota::Update::checkTrialBoot();
+  otaTrial = ota::Update::trialPending();
+
+  // Build every topic for this cannon (and any gateway channels) once
+  cannonId = deviceIdentity.load(config::DEFAULT_CANNON_ID);
+  topics.build("MermaidsTale", cannonId);
+  startGateway();
+  routeOutbound();
 
-  // Initialize cannon base topic
-  snprintf(cannonBaseTopic, sizeof(cannonBaseTopic), "MermaidsTale/Cannon%d", config::CANNON_ID);
+  // Publish limits from the last CannonN/config, or the compiled-in defaults
+  if (publishConfig.load(govLimits, GovernedTopicCount)) Serial.println("Publish governor: limits from NVS");
+  applyGovernorLimits();
+  registerCommands();
 
-  Serial.printf("Starting Cannon%d System...\n", config::CANNON_ID);
+  Serial.printf("Starting Cannon%d System (%s%s)...\n", cannonId,
+                ota::Update::runningLabel(), otaTrial ? ", trial boot" : "");
 
-  // Enable watchdog timer
+  // Enable watchdog timer (each runtime task subscribes itself)
   esp_task_wdt_init(config::WATCHDOG_TIMEOUT_S, true);
-  esp_task_wdt_add(NULL);
   Serial.printf("Watchdog timer enabled (%ds timeout)\n", config::WATCHDOG_TIMEOUT_S);
 
+  // Network first: WiFi association and Ethernet DHCP run in the background
+  // while the sensors come up; the reconnect job connects MQTT once a link is up
+  bootInfo.cacheHit = config::FAST_BOOT && bootCache.load();
+  startNetwork();
+  startMqtt();
+
   ctrl.begin();
   delay(100);
 
@@ -435,76 +1391,51 @@ void setup() {
     Serial.println("I2C bus recovery failed - continuing anyway");
   }
 
-  I2CBus::setActive(&ctrl.i2c());
-  ALS31300::Sensor::setCallbacks(
-      I2CBus::cbRegisterDevice, I2CBus::cbUnregisterDevice,
-      I2CBus::cbChangeAddress, I2CBus::cbWrite, I2CBus::cbRead);
-
-  // Scan I2C bus
-  scanI2CDevices();
-
-  // Connect to WiFi
-  WiFi.mode(WIFI_STA);
-  WiFi.begin(cfg::WIFI_SSID, cfg::WIFI_PASS);
-  Serial.print("Connecting to WiFi");
-
-  while (WiFi.status() != WL_CONNECTED) {
-    delay(500);
-    Serial.print(".");
+  if (&rangeBus != &ctrl.i2c()) {
+    Serial.println("VL6180X on its own bus (Wire1)");
+    if (!rangeBus.clearBus()) Serial.println("VL6180X bus recovery failed - continuing anyway");
   }
-  Serial.println(" Connected!");
 
-  // Connect to MQTT
-  mqtt::Config mqttConfig;
-  mqttConfig.brokerHost = cfg::MQTT_HOST;
-  mqttConfig.brokerPort = cfg::MQTT_PORT;
-  
-  // Generate dynamic client ID: "cannon-1", "cannon-2", etc.
-  static char clientId[32];
-  snprintf(clientId, sizeof(clientId), "cannon-%d", config::CANNON_ID);
-  mqttConfig.clientId = clientId;
-  
-  mqttAdapter.begin(mqttConfig);
-  mqttAdapter.connect();
-  mqttAdapter.loop();
+  // Known addresses from the boot cache, or a full scan
+  discoverSensors();
 
-  if (mqttAdapter.connected()) {
-    Serial.println("MQTT connected");
-    
-    // Build topics for this cannon
-    char resetTopic[64], statusTopic[64];
-    buildCannonTopic(resetTopic, sizeof(resetTopic), "reset");
-    buildCannonTopic(statusTopic, sizeof(statusTopic), "status");
-    
-    pubSubClient.setCallback(onMqttMessage);
-    mqttAdapter.subscribe(resetTopic, 0);
-    mqttAdapter.subscribe(statusTopic, 0);
-    Serial.printf("Subscribed to Cannon%d reset and status commands\n", config::CANNON_ID);
+  // From here on driver traffic goes through the queued I2C engines (one
+  // worker per bus); read()/write() become a synchronous facade over them.
+  if (ctrl.i2c().startAsync(config::I2C_QUEUE_DEPTH, config::I2C_TASK_PRIORITY,
+                            config::SENSOR_TASK_CORE) &&
+      rangeBus.startAsync(config::I2C_QUEUE_DEPTH, config::I2C_TASK_PRIORITY,
+                          config::SENSOR_TASK_CORE)) {
+    Serial.println("Async I2C engine started");
   } else {
-    Serial.println("MQTT not connected");
-    Serial.printf("Broker: %s:%d\n", mqtt::Config().brokerHost, mqtt::Config().brokerPort);
+    Serial.println("Async I2C engine unavailable - using blocking Wire transfers");
   }
 
   // Initialize VL6180X
   Serial.println("\n=== VL6180X Initialization ===");
   Serial.println("Checking for VL6180X at address 0x29...");
 
-  Wire.beginTransmission(0x29);
-  uint8_t vl_error = Wire.endTransmission();
+  uint8_t vl_error = rangeBus.probe(0x29);
+  vl6180xProbeError = vl_error;
 
   if (vl_error == 0) {
     Serial.println("VL6180X detected on I2C bus!");
-    if (!distanceSensor.begin()) {
+    if (!distanceSensor.begin(&rangeBus.wire())) {
       Serial.println("VL6180X detected but initialization failed!");
       vl6180xInitialized = false;
+    } else if (!ranging.start(config::VL6180X_RANGING)) {
+      Serial.println("VL6180X initialized but continuous ranging failed to start!");
+      vl6180xInitialized = false;
     } else {
-      Serial.println("VL6180X initialized successfully!");
+      Serial.printf("VL6180X initialized: continuous ranging every %ums (%s)\n",
+                    ranging.config().intermeasurementMs,
+                    ranging.usingInterrupt() ? "GPIO1 interrupt" : "status polling");
       vl6180xInitialized = true;
     }
   } else {
     Serial.printf("ERROR: VL6180X not responding (I2C error: %d)\n", vl_error);
     Serial.printf("Check wiring: SDA=%d, SCL=%d, 3.3V, GND\n", 
-                  config::I2C_SDA_PIN, config::I2C_SCL_PIN);
+                  config::VL6180X_OWN_BUS ? config::VL6180X_SDA_PIN : config::I2C_SDA_PIN,
+                  config::VL6180X_OWN_BUS ? config::VL6180X_SCL_PIN : config::I2C_SCL_PIN);
     vl6180xInitialized = false;
   }
 
@@ -513,9 +1444,7 @@ void setup() {
   
   if (alsAddressDetected) {
     Serial.printf("Using detected ALS31300 at address 0x%02X\n", detectedALS_ADDR);
-    als = ALS31300::Sensor(detectedALS_ADDR);
-    
-    if (als.update()) {
+    if (startAls(detectedALS_ADDR)) {
       Serial.println("ALS31300 initialized successfully!");
       als31300Initialized = true;
     } else {
@@ -526,7 +1455,7 @@ void setup() {
     Serial.printf("No ALS31300 detected. Trying fallback address 0x%02X\n", 
                   config::ALS_FALLBACK_ADDR);
     
-    if (als.update()) {
+    if (startAls(config::ALS_FALLBACK_ADDR)) {
       Serial.println("ALS31300 initialized with fallback address!");
       als31300Initialized = true;
       detectedALS_ADDR = config::ALS_FALLBACK_ADDR;
@@ -537,145 +1466,596 @@ void setup() {
     }
   }
 
-  Serial.println("Setup complete");
+  if (config::FAST_BOOT) {
+    bootCache.data().alsAddr = als31300Initialized ? detectedALS_ADDR : 0;
+    bootCache.data().vlPresent = vl6180xProbeError == 0;
+    bootCache.save();
+  }
+
+  Serial.printf("Setup complete (%lu ms)\n", millis());
+  if (!config::FAST_BOOT) delay(config::STARTUP_SETTLE_MS);
 
-  delay(config::STARTUP_SETTLE_MS);
-  sendStartupStatus();
+  // The startup status goes out when MQTT first connects (mqttJob)
+  startRuntimeTasks();
 }
 
 // ============================================================================
-// MAIN LOOP
+// SENSOR TASK (core 1): acquisition + state, never touches the network
 // ============================================================================
-void loop() {
-  // Feed the watchdog
-  esp_task_wdt_reset();
+// Latest reading from each sensor job; committed together by commitSample()
+static struct {
+  util::Angle filteredAngle;
+  float    filteredDistance = 0;
+  bool     firstReading     = true;
+  uint8_t  stat             = VL6180X_ERROR_NONE;
+  uint8_t  rangeMm          = 0;       // last raw VL6180X range
+  bool     rangeFresh       = false;   // rangeJob produced a sample this pass
+  bool     alsOk            = false;
+  uint32_t angleUs          = 0;       // micros() of the last good ALS31300 read
+  uint32_t rangeUs          = 0;       // micros() of the last VL6180X sample
+} sensorCtx;
+
+// Sleep bound for a scheduler wait; capped so the task watchdog stays fed
+static TickType_t sleepTicks(uint32_t waitUs) {
+  uint32_t ms = (waitUs == util::DeadlineScheduler<1>::kNever) ? config::SCHED_MAX_SLEEP_MS
+                                                              : (waitUs + 999U) / 1000U;
+  if (ms > config::SCHED_MAX_SLEEP_MS) ms = config::SCHED_MAX_SLEEP_MS;
+  return pdMS_TO_TICKS(ms);
+}
 
-  static unsigned long lastStatus = 0;
-  static float filteredAngle = 0;
-  static float filteredDistance = 0;
-  static bool firstReading = true;
+// ISR hook (VL6180X GPIO1, button edge): run the job now and wake the sensor task
+static void IRAM_ATTR wakeSensorJob(void* job) {
+  sensorJobs.trigger(static_cast<int>(reinterpret_cast<uintptr_t>(job)));
+  BaseType_t woken = pdFALSE;
+  if (sensorTaskHandle) vTaskNotifyGiveFromISR(sensorTaskHandle, &woken);
+  portYIELD_FROM_ISR(woken);
+}
 
-  // MQTT maintenance
-  mqttAdapter.loop();
-  handleMqttReconnection();
-  handleReset();
+// ALS31300 INT: movement while idle brings the angle job back at once. While
+// sampling, the latch simply stays asserted (no further edges).
+static void IRAM_ATTR onAlsInt(void*) {
+  if (alsWake.idle.load(std::memory_order_relaxed)) {
+    wakeSensorJob(reinterpret_cast<void*>(uintptr_t(JobAngle)));
+  }
+}
 
-  ctrl.pollButton();
+// Motion wake: after ALS_IDLE_AFTER_MS without a MIN_ANGLE_CHANGE_DEG move the
+// part duty-cycles on its own and the angle job drops to a safety poll. INT,
+// the latch seen by that poll, or a CannonN/rates change restores sampling.
+static void updateAlsWake() {
+  const uint32_t now = millis();
+  const util::Angle a = sensorCtx.filteredAngle;
+  const bool moved = a.distanceTo(alsWake.stillAngle) >= config::MIN_ANGLE_CHANGE_DEG * 100;
+  if (moved) {
+    alsWake.stillAngle = a;
+    alsWake.stillSinceMs = now;
+  }
 
-  // Read distance sensor
-  uint8_t mm = 0;
-  uint8_t stat = VL6180X_ERROR_NONE;
-  static uint8_t lastDistanceError = VL6180X_ERROR_NONE;
+  if (alsWake.idle) {
+    const bool rateChanged = sensorJobs.periodUs(JobAngle) != config::ALS_IDLE_POLL_MS * 1000U;
+    if (!als.interruptFlagged() && !moved && !rateChanged) return;
+    if (!als.setLowPower(false)) return;           // bus trouble: the poll retries
+    leaveAlsIdle(/*restorePeriod=*/!rateChanged);
+    alsWake.stillSinceMs = now;
+    DLOG_I("ALS31300 moving: sampling resumed");
+    return;
+  }
 
-  if (vl6180xInitialized) {
-    mm = distanceSensor.readRange();
-    stat = distanceSensor.readRangeStatus();
+  // Trace wants every sample; angle=0 already leaves the job without a timer
+  if (now - alsWake.stillSinceMs < config::ALS_IDLE_AFTER_MS) return;
+  if (traceEnabled.load(std::memory_order_relaxed)) return;
+  const uint32_t periodUs = sensorJobs.periodUs(JobAngle);
+  if (periodUs == util::DeadlineScheduler<1>::kTriggerOnly) return;
+  if (!als.setLowPower(true, config::ALS_IDLE_INTERVAL)) return;
+  alsWake.activePeriodUs = periodUs;
+  alsWake.idle = true;
+  sensorJobs.setPeriod(JobAngle, config::ALS_IDLE_POLL_MS * 1000U);
+  DLOG_I("ALS31300 still: low-power, INT wake");
+}
 
-    // Apply distance filtering
-    if (stat == VL6180X_ERROR_NONE) {
-      if (firstReading) {
-        filteredDistance = mm;
-      } else {
-        filteredDistance = filteredDistance * (1.0f - config::DISTANCE_FILTER_ALPHA) 
-                         + mm * config::DISTANCE_FILTER_ALPHA;
-      }
-    }
+static void angleJob(void*) {
+  // Integer centi-degrees end to end
+  sensorCtx.alsOk = als31300Initialized ? als.update() : false;
+  if (!sensorCtx.alsOk) return;
+  sensorCtx.angleUs = micros();
 
-    // Log error status changes (ignore known non-critical errors)
-    if (stat != lastDistanceError) {
-      if (stat == VL6180X_ERROR_NONE) {
-        Serial.printf("VL6180X OK - Distance: %dmm\n", (int)filteredDistance);
-      } else if (stat != config::VL6180X_ERR_ECE_FAIL && 
-                 stat != config::VL6180X_ERR_VCSEL_WD) {
-        Serial.printf("VL6180X Error %d - Distance: %dmm\n", stat, mm);
-      }
-      lastDistanceError = stat;
+  if (config::ANGLE_ESTIMATOR == config::AngleEstimator::AlphaBeta) {
+    if (als.hasNewData()) angleTracker.update(als.angle(), micros());
+    sensorCtx.filteredAngle = angleTracker.angle();
+  } else {
+    sensorCtx.filteredAngle = als.angle();
+  }
+  if (alsWake.armed) updateAlsWake();
+}
+
+// Only touches the bus when the continuous ranging has a sample ready
+static void rangeJob(void*) {
+  PROF_SCOPE("sensor.range");
+  VL6180X::RangeSample range;
+  if (!vl6180xInitialized || !ranging.poll(range)) return;
+
+  const uint8_t mm = range.rangeMm;
+  sensorCtx.stat = range.status;
+  sensorCtx.rangeUs = micros();
+
+  // Apply distance filtering
+  if (sensorCtx.stat == VL6180X_ERROR_NONE) {
+    if (sensorCtx.firstReading) {
+      sensorCtx.filteredDistance = mm;   // seed once; DISTANCE_FILTER_ALPHA applies from here
+      sensorCtx.firstReading = false;
+    } else {
+      sensorCtx.filteredDistance = sensorCtx.filteredDistance * (1.0f - config::DISTANCE_FILTER_ALPHA)
+                                 + mm * config::DISTANCE_FILTER_ALPHA;
     }
   }
+  sensorCtx.rangeMm = mm;
+  sensorCtx.rangeFresh = true;
+}
 
-  // Update ALS sensor
-  static bool lastAlsStatus = true;
-  bool currentAlsStatus = als31300Initialized ? als.update() : false;
+static void buttonJob(void*) {
+  ctrl.pollButton();
+  // Edge-triggered: come back once the debounce window can commit the change
+  if (ctrl.button().settling()) {
+    sensorJobs.defer(JobButton, config::BUTTON_DEBOUNCE_MS * 1000U, micros());
+  }
+}
 
-  // Use raw angle without filtering
-  if (currentAlsStatus) {
-    filteredAngle = als.getAngle();
+// Gateway mode: one channel per run, so a slow or missing sensor costs one
+// burst per GATEWAY_RATE_HZ period; the transfer goes through the queued
+// I2C engine like the other jobs.
+static void gatewayJob(void*) {
+  PROF_SCOPE("sensor.gateway");
+  if (gwChannels.size() == 0) return;
+  const size_t i = gwChannels.next();
+  const int pin = gwButtonPins[i];
+
+  const uint8_t index = 0x28;
+  uint8_t block[gwChannels.kBurstBytes];
+  const bool ok = ctrl.i2c().read(gwChannels.address(i), &index, 1, block, sizeof(block));
+  const bool down = pin != BoardPins::NC && digitalRead(pin) == LOW;
+
+  GatewayEvent ev;
+  ev.changes = gwChannels.sample(i, micros(), ok ? block : nullptr, down);
+  if (ev.changes == gateway::ChannelNone) return;
+  ev.channel = static_cast<uint8_t>(i);
+  ev.angle = gwChannels.angle(i);
+  ev.firedUs = gwChannels.firedUs(i);
+  ev.online = gwChannels.online(i);
+  gatewayEvents.push(ev);   // full ring: dropped and counted, like sensorEvents
+}
+
+// Fold the latest readings into the state and hand one event to the network task
+static void commitSample() {
+  SensorEvent ev;
+  const uint8_t stat = sensorCtx.stat;
+  const uint8_t distanceMm = (uint8_t)sensorCtx.filteredDistance;
+
+  ev.tsMs = millis();
+  ev.commitUs = micros();
+  ev.angleUs = sensorCtx.angleUs;
+  ev.rangeUs = sensorCtx.rangeUs;
+  ev.distanceRead = sensorCtx.rangeFresh;
+  ev.button = ctrl.button().pressed();
+  ev.buttonEdgeUs = ctrl.button().edgeUs();
+  ev.stateChanges = gstate.update(ev.tsMs, sensorCtx.filteredAngle, ev.button,
+                                  distanceMm, stat == VL6180X_ERROR_NONE);
+  ev.viewChanges = cView.update();
+
+  ev.angle = cView.angle();
+  ev.distanceMm = distanceMm;
+  ev.rangeStatus = stat;
+  ev.alsOk = sensorCtx.alsOk;
+  ev.justLoaded = cView.justLoaded();
+  ev.justFired = cView.justFired();
+
+  if (traceEnabled.load(std::memory_order_relaxed)) {
+    integ::TraceSample t;
+    t.tsMs = ev.tsMs;
+    t.rawX = als.rawX; t.rawY = als.rawY; t.rawZ = als.rawZ;
+    t.x = als.x;       t.y = als.y;       t.z = als.z;
+    t.angleCdeg = als.angle().cdeg();
+    t.rangeMm = sensorCtx.rangeMm;
+    t.distanceMm = ev.distanceMm;
+    t.rangeStatus = stat;
+    t.flags = (ev.button ? integ::TraceButton : 0)
+            | (ev.alsOk ? integ::TraceAlsOk : 0)
+            | (ev.distanceRead ? integ::TraceRangeFresh : 0)
+            | (stat == VL6180X_ERROR_NONE ? integ::TracePresent : 0);
+    traceSamples.push(t);   // full ring: counted, reported in the next frame
   }
 
-  // Log ALS status changes
-  if (currentAlsStatus != lastAlsStatus) {
-    if (currentAlsStatus) {
-      Serial.printf("ALS31300 OK - Angle: %d°\n", (int)filteredAngle);
-    } else {
-      Serial.println("ALS31300 read error occurred");
-    }
-    lastAlsStatus = currentAlsStatus;
+  // Never blocks: if the network side falls behind, the sample is dropped
+  // and counted by the ring.
+  sensorEvents.push(ev);
+}
+
+void runSensorJobs() {
+  PROF_SCOPE("sensor.cycle");
+
+  sensorCtx.rangeFresh = false;
+  // Gateway runs publish their own events; only our own sensors commit a sample
+  if (sensorJobs.runDue(micros()) & ~(1u << JobGateway)) {
+    commitSample();
   }
+}
 
-  uint16_t deg = (uint16_t)filteredAngle;
-  gstate.update(millis(), deg, ctrl.button().pressed(), 
-                (uint8_t)filteredDistance, stat == VL6180X_ERROR_NONE);
+void sensorTask(void*) {
+  esp_task_wdt_add(NULL);
+  for (;;) {
+    esp_task_wdt_reset();
+    runSensorJobs();
+    // Idle until the next deadline or a sensor interrupt
+    ulTaskNotifyTake(pdTRUE, sleepTicks(sensorJobs.untilNext(micros())));
+  }
+}
 
-  // Publish only significant changes
+// ============================================================================
+// NETWORK TASK (core 0): MQTT/WiFi, publishing and logging
+// ============================================================================
+void handleSensorEvent(const SensorEvent& ev) {
+  PROF_SCOPE("net.event");      // logging + publishing for one sample
+  static uint8_t lastDistanceError = VL6180X_ERROR_NONE;
+  static bool lastAlsStatus = true;
   static int lastPublishedAngle = -1;
   static uint8_t lastPublishedDistance = 255;
   static bool lastButtonState = false;
 
-  uint32_t changed = cView.update();
-  int currentAngle = (int)filteredAngle;
-  uint8_t currentDistance = (uint8_t)filteredDistance;
-  bool currentButton = ctrl.button().pressed();
+  const int currentAngle = ev.angle.deg();
+
+  // Log error status changes (ignore known non-critical errors)
+  if (ev.distanceRead && ev.rangeStatus != lastDistanceError) {
+    if (ev.rangeStatus == VL6180X_ERROR_NONE) {
+      DLOG_I("VL6180X OK - Distance: %dmm", (int)ev.distanceMm);
+    } else if (ev.rangeStatus != config::VL6180X_ERR_ECE_FAIL && 
+               ev.rangeStatus != config::VL6180X_ERR_VCSEL_WD) {
+      DLOG_W("VL6180X Error %d - Distance: %dmm", ev.rangeStatus, ev.distanceMm);
+    }
+    lastDistanceError = ev.rangeStatus;
+  }
+
+  // Log ALS status changes
+  if (ev.alsOk != lastAlsStatus) {
+    if (ev.alsOk) {
+      DLOG_I("ALS31300 OK - Angle: %d°", currentAngle);
+    } else {
+      DLOG_W("ALS31300 read error occurred");
+    }
+    lastAlsStatus = ev.alsOk;
+  }
 
   // Log angle changes
-  if (als31300Initialized && currentAlsStatus) {
+  if (als31300Initialized && ev.alsOk) {
     if (abs(currentAngle - lastPublishedAngle) >= config::MIN_ANGLE_CHANGE_DEG) {
-      Serial.printf("Angle changed: %d°\n", currentAngle);
+      DLOG_D("Angle changed: %d°", currentAngle);
       lastPublishedAngle = currentAngle;
     }
   }
 
-  // Publish angle changes
-  if (changed & cannon::ChangedAngle) {
-    cannonPub.publishAngle(config::CANNON_ID, cView.angleDeg());
-    Serial.printf("MQTT: Published angle %d° for Cannon%d\n", (int)cView.angleDeg(), config::CANNON_ID);
+  // Publish angle changes, as far as the governor lets them through
+  // (values the governor releases later in pollGovernors() carry no probe record)
+  if ((ev.viewChanges & cannon::ChangedAngle) && horGov.offer(currentAngle, millis())) {
+    const uint32_t publishUs = micros();
+    cannonPub.publishAngle(util::Angle::fromDeg(horGov.value()));
+    if (probing()) publishProbe(integ::ProbeKind::Angle, ev.angleUs, ev.commitUs, publishUs);
+    DLOG_V("MQTT: Published angle %d° for Cannon%d", currentAngle, cannonId);
   }
 
   // Log distance changes
-  if (vl6180xInitialized && stat == VL6180X_ERROR_NONE) {
-    if (abs(currentDistance - lastPublishedDistance) >= config::MIN_DISTANCE_CHANGE_MM) {
-      Serial.printf("Distance changed: %dmm\n", currentDistance);
-      lastPublishedDistance = currentDistance;
+  if (ev.distanceRead && ev.rangeStatus == VL6180X_ERROR_NONE) {
+    if (abs(ev.distanceMm - lastPublishedDistance) >= config::MIN_DISTANCE_CHANGE_MM) {
+      DLOG_D("Distance changed: %dmm", ev.distanceMm);
+      lastPublishedDistance = ev.distanceMm;
     }
   }
 
   // Log button changes
-  if (currentButton != lastButtonState) {
-    Serial.println(currentButton ? "*** BUTTON PRESSED ***" : "*** Button Released ***");
-    lastButtonState = currentButton;
+  if (ev.button != lastButtonState) {
+    DLOG_I(ev.button ? "*** BUTTON PRESSED ***" : "*** Button Released ***");
+    lastButtonState = ev.button;
   }
 
   // Publish events
-  if (changed & cannon::ChangedLoaded) {
-    if (cView.justLoaded()) {
-      cannonPub.publishEvent(config::CANNON_ID, "Loaded");
-      Serial.printf("MQTT: Published Loaded event for Cannon%d\n", config::CANNON_ID);
+  if ((ev.viewChanges & cannon::ChangedLoaded) && ev.justLoaded) {
+    const uint32_t publishUs = micros();
+    cannonPub.publishEvent(integ::CannonEvent::Loaded);
+    if (probing()) publishProbe(integ::ProbeKind::Loaded, ev.rangeUs, ev.commitUs, publishUs);
+    DLOG_I("MQTT: Published Loaded event for Cannon%d", cannonId);
+  }
+  if ((ev.viewChanges & cannon::ChangedFired) && ev.justFired) {
+    const uint32_t publishUs = micros();
+    cannonPub.publishEvent(integ::CannonEvent::Fired, ev.buttonEdgeUs);
+    if (probing()) publishProbe(integ::ProbeKind::Fired, ev.buttonEdgeUs, ev.commitUs, publishUs);
+    DLOG_I("MQTT: Published Fired event for Cannon%d", cannonId);
+  }
+}
+
+// Publishing for one gateway channel, under its own CannonN/* topics
+void handleGatewayEvent(const GatewayEvent& ev) {
+  const cannon::Topics& t = gwTopics[ev.channel];
+  integ::CannonTelemetry pub(outbound, t);
+  const unsigned id = gwChannels.cannonId(ev.channel);
+
+  if (ev.changes & gateway::ChannelHealth) {
+    if (ev.online) DLOG_I("Gateway: Cannon%u ALS31300 OK", id);
+    else DLOG_W("Gateway: Cannon%u ALS31300 not answering", id);
+    publishGatewayStatus(ev.channel);
+  }
+  if ((ev.changes & gateway::ChannelAngle) && gwHorGov[ev.channel].offer(ev.angle.deg(), millis())) {
+    pub.publishAngle(util::Angle::fromDeg(gwHorGov[ev.channel].value()));
+    DLOG_V("MQTT: Published angle %d° for Cannon%u", ev.angle.deg(), id);
+  }
+  if (ev.changes & gateway::ChannelFired) {
+    pub.publishEvent(integ::CannonEvent::Fired, ev.firedUs);
+    DLOG_I("MQTT: Published Fired event for Cannon%u", id);
+  }
+}
+
+// What the governors held back: the newest angle once the limits allow,
+// and the exact final one after a swing
+static void pollGovernors(uint32_t nowMs) {
+  if (horGov.poll(nowMs)) cannonPub.publishAngle(util::Angle::fromDeg(horGov.value()));
+  for (size_t i = 0; i < gwChannels.size(); ++i) {
+    if (gwHorGov[i].poll(nowMs)) {
+      integ::CannonTelemetry(outbound, gwTopics[i]).publishAngle(util::Angle::fromDeg(gwHorGov[i].value()));
     }
   }
-  if (changed & cannon::ChangedFired) {
-    if (cView.justFired()) {
-      cannonPub.publishEvent(config::CANNON_ID, "Fired");
-      Serial.printf("MQTT: Published Fired event for Cannon%d\n", config::CANNON_ID);
+}
+
+// At most one frame per service pass, after the normal events, so tracing
+// only ever uses otherwise idle network time.
+void publishTraceFrame() {
+  static integ::TraceSample batch[config::TRACE_MAX_BATCH];
+  static uint8_t frame[integ::traceFrameMaxBytes(config::TRACE_MAX_BATCH)];
+  static uint16_t seq = 0;
+  static uint32_t reportedDrops = 0;
+  static uint32_t lostSamples = 0;   // popped for a frame the client refused
+  static unsigned long lastFrame = 0;
+
+  const size_t want = traceBatch.load();
+  const size_t have = traceSamples.size();
+  if (have == 0) { lastFrame = millis(); return; }
+  // Partial frames only when tracing stopped or the rate is too low to fill one
+  if (have < want && traceEnabled.load() && millis() - lastFrame < config::TRACE_FLUSH_MS) return;
+  // Samples wait in the ring (or drop, counted) until a streamed frame can go:
+  // the queue refuses those while anything it holds is still pending
+  if (!mqttAdapter.connected() || outbound.pending() != 0) return;
+
+  size_t n = 0;
+  while (n < want && traceSamples.pop(batch[n])) ++n;
+
+  const uint32_t drops = traceSamples.dropped() + lostSamples;
+  const uint32_t newDrops = drops - reportedDrops;
+
+  const size_t len = integ::encodeTraceFrame(batch, n, seq,
+                                             newDrops > 0xFFFF ? 0xFFFF : uint16_t(newDrops),
+                                             frame, sizeof(frame));
+  // Streamed: frames are larger than the PubSubClient packet buffer
+  if (!mqtt::publishStreamed(outbound, topics[cannon::TopicTraceData],
+                             [len](util::ByteSink& out) { return out.put(reinterpret_cast<const char*>(frame), len); })) {
+    lostSamples += n;   // reported as drops by the next frame, which keeps this seq
+    return;
+  }
+  ++seq;
+  reportedDrops = drops;
+  lastFrame = millis();
+}
+
+static SensorEvent latestEvent;   // most recent sample, for the status line
+
+// MQTT maintenance, backlog replay and event publishing
+static void mqttJob(void*) {
+  mqttAdapter.loop();
+
+  // Session (re)established: fresh retained status, and the boot timing once
+  static bool wasConnected = false;
+  const bool connected = mqttAdapter.connected();
+  if (connected && !wasConnected) {
+    sendStartupStatus();
+    publishGovernorConfig();
+    reportBootTime();
+  }
+  wasConnected = connected;
+  outbound.drain(millis());     // replay anything held while disconnected
+  publishResetResult();
+
+  SensorEvent ev;
+  while (sensorEvents.pop(ev)) {
+    handleSensorEvent(ev);
+    latestEvent = ev;
+  }
+  GatewayEvent gev;
+  while (gatewayEvents.pop(gev)) handleGatewayEvent(gev);
+  pollGovernors(millis());
+
+  publishTraceFrame();
+}
+
+static void reconnectJob(void*) { handleMqttReconnection(); }
+
+// Ethernet bring-up/lease upkeep, and transport failover for the MQTT session
+static void linkJob(void*) {
+  if (config::USE_ETHERNET) eth.poll(millis());
+  pollWifi(millis());
+
+  static bool hadLink = false;
+  const bool link = networkUp();
+  if (link && !hadLink) networkJobs.trigger(JobReconnect);   // connect without waiting a period
+  hadLink = link;
+
+  if (transport.poll(millis())) {
+    DLOG_W("Network transport changed, reconnecting MQTT");
+    networkJobs.trigger(JobReconnect);
+  }
+}
+
+// Publish latency (QoS1 publish -> PUBACK) per transport over the last window
+static void transportJob(void*) {
+  // A refused report keeps accumulating into the next window
+  if (mqtt::publishStreamed(outbound, topics[cannon::TopicTransport],
+                            [](util::ByteSink& out) { return transport.writeJson(out); })) {
+    transport.resetLatency();
+  }
+}
+
+// OTA: download steps while an update runs; otherwise watch a trial boot.
+// A new image is kept once it has reached the broker, and given up on if it
+// cannot within OTA_CONFIRM_TIMEOUT_MS.
+static void otaJob(void*) {
+  PROF_SCOPE("net.ota");
+  static uint32_t lastProgressMs = 0;
+  if (otaUpdate.state() == ota::Update::State::Downloading) {
+    if (otaUpdate.step(config::OTA_STEP_BYTES)) {
+      if (millis() - lastProgressMs >= config::OTA_PROGRESS_MS) {
+        lastProgressMs = millis();
+        publishOtaStatus("downloading");
+      }
+      return;
+    }
+    networkJobs.setPeriod(JobOta, config::OTA_IDLE_POLL_MS * 1000U);
+    if (otaUpdate.state() != ota::Update::State::Done) {
+      DLOG_W("OTA failed");
+      publishOtaStatus("failed");
+      return;
     }
+    DLOG_I("OTA: %lu bytes written, restarting", static_cast<unsigned long>(otaUpdate.written()));
+    restartAfterNotice(topics[cannon::TopicOtaStatus], "rebooting", /*retain=*/true);
+  }
+
+  if (!otaTrial) return;
+  if (mqttAdapter.connected()) {
+    ota::Update::confirm();
+    otaTrial = false;
+    publishOtaStatus("confirmed");
+  } else if (millis() >= config::OTA_CONFIRM_TIMEOUT_MS) {
+    DLOG_W("OTA: new image never reached the broker - rolling back");
+    ota::Update::rollback();
   }
+}
 
-  // Periodic status report
-  if (millis() - lastStatus > config::STATUS_REPORT_INTERVAL_MS) {
-    lastStatus = millis();
-    Serial.printf("Status - VL6180X: %s | ALS31300: %s | MQTT: %s\n",
-                  (vl6180xInitialized && stat == VL6180X_ERROR_NONE) ? "OK" : "Error",
-                  (als31300Initialized && currentAlsStatus) ? "OK" : "Error",
-                  mqttAdapter.connected() ? "Connected" : "Disconnected");
+// Heap (free, lowest, largest block) and every task's unused stack, retained.
+// Tasks are picked up once their handles exist (setup creates them after
+// this job is registered).
+static void memoryJob(void*) {
+  static bool watching = false;
+  if (!watching && sensorTaskHandle) {
+    resources.watch("net", networkTaskHandle);
+    resources.watch("sensors", sensorTaskHandle);
+    resources.watch("log", logTaskHandle);
+    resources.watch("i2c0", static_cast<TaskHandle_t>(ctrl.i2c().workerTask()));
+    if (&rangeBus != &ctrl.i2c()) resources.watch("i2c1", static_cast<TaskHandle_t>(rangeBus.workerTask()));
+    watching = true;
   }
+  resources.capture();
+  // Through the queue: the ReplaceInPlace route keeps the newest watermarks for a reconnect
+  publishQueued<384>(topics[cannon::TopicMemory],
+                     [](util::ByteSink& out) { return resources.writeJson(out); }, /*retain=*/true);
+}
 
-  delay(50);
+// Full status/diagnostics documents (trigger-only, e.g. after a reset)
+static void statusDocJob(void*) { sendStartupStatus(); }
+
+// Periodic status report
+static void statusJob(void*) {
+  PROF_SCOPE("net.status");
+  DLOG_I("Status - VL6180X: %s | ALS31300: %s | MQTT: %s (%s) | Dropped: %lu | Queued: %u",
+                (vl6180xInitialized && latestEvent.rangeStatus == VL6180X_ERROR_NONE) ? "OK" : "Error",
+                (als31300Initialized && latestEvent.alsOk) ? "OK" : "Error",
+                mqttAdapter.connected() ? "Connected" : "Disconnected",
+                config::USE_NATIVE_MQTT ? transport.activeName() : "wifi",
+                static_cast<unsigned long>(sensorEvents.dropped()),
+                static_cast<unsigned>(outbound.pending()));
+}
+
+#if PROF_ENABLED
+static void perfJob(void*) {
+  static util::prof::Report perf;   // ~1 KB; keep it off the task stack
+  perf.capture();
+  mqtt::publishStreamed(outbound, topics[cannon::TopicPerf],
+                        [](util::ByteSink& out) { return perf.writeJson(out); });
+}
+#endif
+
+void networkTask(void*) {
+  esp_task_wdt_add(NULL);
+  for (;;) {
+    esp_task_wdt_reset();
+    networkJobs.runDue(micros());
+    // Sleep until the next job deadline, or earlier if the sensor task signals
+    ulTaskNotifyTake(pdTRUE, sleepTicks(networkJobs.untilNext(micros())));
+  }
+}
+
+static void registerJobs() {
+  // Sensor task. GPIO1, the button and ALS31300 INT ISRs trigger their jobs
+  // directly; the range period is then only a safety net for a missed edge.
+  sensorJobs.add("angle", periodForHz(config::ANGLE_RATE_HZ), &angleJob);
+  sensorJobs.add("range", (ranging.usingInterrupt() ? config::RANGE_FALLBACK_MS
+                                                    : config::RANGE_POLL_MS) * 1000U, &rangeJob);
+  sensorJobs.add("button", config::BUTTON_MODE == ButtonMode::Interrupt
+                               ? util::DeadlineScheduler<1>::kTriggerOnly
+                               : config::BUTTON_POLL_MS * 1000U, &buttonJob);
+  ranging.setReadyHook(&wakeSensorJob, reinterpret_cast<void*>(uintptr_t(JobRange)));
+  sensorJobs.add("reset", util::DeadlineScheduler<1>::kTriggerOnly, &resetJob);
+  ctrl.button().setEdgeHook(&wakeSensorJob, reinterpret_cast<void*>(uintptr_t(JobButton)));
+  if (alsWakeMode) {
+    alsIntPin.begin();
+    alsIntPin.attachIrq(&onAlsInt, nullptr, GpioEdge::Falling);
+  }
+  sensorJobs.add("gateway", config::GATEWAY_COUNT
+                                ? periodForHz(config::GATEWAY_RATE_HZ * config::GATEWAY_COUNT)
+                                : util::DeadlineScheduler<1>::kTriggerOnly, &gatewayJob);
+
+  // Network task
+  networkJobs.add("mqtt", config::NETWORK_PERIOD_MS * 1000U, &mqttJob);
+  networkJobs.add("reconnect", config::MQTT_RECONNECT_CHECK_MS * 1000U, &reconnectJob);
+  networkJobs.add("status", config::STATUS_REPORT_INTERVAL_MS * 1000U, &statusJob);
+  networkJobs.add("link", config::ETH_POLL_MS * 1000U, &linkJob);
+  networkJobs.add("transport", config::TRANSPORT_REPORT_INTERVAL_MS * 1000U, &transportJob);
+  networkJobs.add("statusdoc", util::DeadlineScheduler<1>::kTriggerOnly, &statusDocJob);
+  networkJobs.add("ota", config::OTA_IDLE_POLL_MS * 1000U, &otaJob);
+  networkJobs.add("memory", config::MEMORY_REPORT_INTERVAL_MS * 1000U, &memoryJob);
+#if PROF_ENABLED
+  networkJobs.add("perf", config::PERF_REPORT_INTERVAL_MS * 1000U, &perfJob);
+#endif
+}
+
+// ============================================================================
+// LOG TASK (lowest priority): formats DLOG_* records and writes them out
+// ============================================================================
+// Only this task waits on the UART; a burst that outruns it drops records
+// in the callers' ring instead of stalling them.
+void logTask(void*) {
+  char line[160];
+  uint32_t reported = 0;
+  for (;;) {
+    while (util::dlog::next(line, sizeof(line))) Serial.print(line);
+    const uint32_t dropped = util::dlog::dropped();
+    if (dropped != reported) {
+      Serial.printf("log: %lu records dropped\n", static_cast<unsigned long>(dropped - reported));
+      reported = dropped;
+    }
+    vTaskDelay(pdMS_TO_TICKS(config::LOG_DRAIN_MS));
+  }
+}
+
+void startRuntimeTasks() {
+  registerJobs();
+  xTaskCreatePinnedToCore(logTask, "log", config::LOG_TASK_STACK, nullptr,
+                          config::LOG_TASK_PRIORITY, &logTaskHandle, config::LOG_TASK_CORE);
+  xTaskCreatePinnedToCore(networkTask, "net", config::NETWORK_TASK_STACK, nullptr,
+                          config::NETWORK_TASK_PRIORITY, &networkTaskHandle,
+                          config::NETWORK_TASK_CORE);
+  xTaskCreatePinnedToCore(sensorTask, "sensors", config::SENSOR_TASK_STACK, nullptr,
+                          config::SENSOR_TASK_PRIORITY, &sensorTaskHandle,
+                          config::SENSOR_TASK_CORE);
+  Serial.printf("Runtime tasks started (sensors: core %d, net: core %d)\n",
+                (int)config::SENSOR_TASK_CORE, (int)config::NETWORK_TASK_CORE);
+}
+
+// ============================================================================
+// MAIN LOOP
+// ============================================================================
+// All work runs in the pinned tasks above; the Arduino loop task retires.
+void loop() {
+  vTaskDelete(NULL);
 }
@@ -0,0 +1,124 @@
+// src/net/PosixSocketClient.cpp
+//
+// BSD sockets behind net::INetClient. The same code builds against lwIP
+// (ESP-IDF) and the host C library, so anything written against INetClient
+// (e.g. mqtt::NativeClient) can be exercised on a PC against a real broker.
+#include "net/PosixSocketClient.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+#if defined(ESP_PLATFORM)
+  #include <lwip/netdb.h>
+  #include <lwip/sockets.h>
+#else
+  #include <fcntl.h>
+  #include <netdb.h>
+  #include <netinet/in.h>
+  #include <netinet/tcp.h>
+  #include <sys/ioctl.h>
+  #include <sys/socket.h>
+  #include <sys/time.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0   // lwIP / macOS: no SIGPIPE to suppress
+#endif
+
+PosixSocketClient::PosixSocketClient()
+: fd_(-1), timeout_ms_(1000), is_connected_(false) {}
+
+PosixSocketClient::~PosixSocketClient() { stop(); }
+
+bool PosixSocketClient::connect(const char* host, uint16_t port) {
+  stop();
+  if (!host) return false;
+
+  char service[6];
+  std::snprintf(service, sizeof(service), "%u", static_cast<unsigned>(port));
+
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family   = AF_INET;   // lwIP builds are usually IPv4-only
+  hints.ai_socktype = SOCK_STREAM;
+
+  addrinfo* res = nullptr;
+  if (getaddrinfo(host, service, &hints, &res) != 0 || !res) return false;
+
+  for (addrinfo* ai = res; ai && fd_ < 0; ai = ai->ai_next) {
+    fd_ = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd_ < 0) continue;
+    // SO_SNDTIMEO also bounds connect() on Linux and lwIP
+    if (!setBlockingTimeouts_() || ::connect(fd_, ai->ai_addr, ai->ai_addrlen) != 0) {
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+  freeaddrinfo(res);
+  if (fd_ < 0) return false;
+
+  // Small MQTT packets: send them now rather than waiting for Nagle
+  int one = 1;
+  setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  is_connected_ = true;
+  return true;
+}
+
+bool PosixSocketClient::connected() const { return is_connected_ && fd_ >= 0; }
+
+void PosixSocketClient::stop() {
+  if (fd_ >= 0) {
+    shutdown(fd_, SHUT_RDWR);
+    close(fd_);
+  }
+  fd_ = -1;
+  is_connected_ = false;
+}
+
+size_t PosixSocketClient::write(const uint8_t* buf, size_t len) {
+  if (!connected() || !buf) return 0;
+  size_t sent = 0;
+  while (sent < len) {
+    const ssize_t n = send(fd_, buf + sent, len - sent, MSG_NOSIGNAL);
+    if (n > 0) { sent += static_cast<size_t>(n); continue; }
+    if (n < 0 && (errno == EINTR)) continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;   // send timeout: partial
+    stop();
+    break;
+  }
+  return sent;
+}
+
+int PosixSocketClient::read(uint8_t* buf, size_t len) {
+  if (!connected() || !buf) return -1;
+  if (len == 0) return 0;
+  const ssize_t n = recv(fd_, buf, len, MSG_DONTWAIT);
+  if (n > 0) return static_cast<int>(n);
+  if (n == 0) { stop(); return -1; }                                  // peer closed
+  if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return 0;
+  stop();
+  return -1;
+}
+
+int PosixSocketClient::available() const {
+  if (!connected()) return 0;
+  int n = 0;
+  if (ioctl(fd_, FIONREAD, &n) != 0) return 0;
+  return n > 0 ? n : 0;
+}
+
+void PosixSocketClient::setTimeout(unsigned long ms) {
+  timeout_ms_ = ms;
+  if (fd_ >= 0) setBlockingTimeouts_();
+}
+
+bool PosixSocketClient::setBlockingTimeouts_() const {
+  timeval tv;
+  tv.tv_sec  = static_cast<long>(timeout_ms_ / 1000);
+  tv.tv_usec = static_cast<long>((timeout_ms_ % 1000) * 1000);
+  return setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) == 0 &&
+         setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)) == 0;
+}
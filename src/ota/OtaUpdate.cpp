@@ -0,0 +1,289 @@
+#include "OtaUpdate.h"
+#include <Preferences.h>
+#include <esp_system.h>
+#include <cstdlib>
+#include <cstring>
+#if CONFIG_IDF_TARGET_ESP32S3
+#include "esp32s3/rom/miniz.h"
+#else
+#include "esp32/rom/miniz.h"
+#endif
+
+namespace {
+constexpr const char* kNamespace = "ota";
+constexpr const char* kTrialKey  = "trial";    // label of the slot on trial ("" = none)
+constexpr const char* kBootsKey  = "boots";    // trial boots so far
+constexpr const char* kBackKey   = "back";     // fell back from an unconfirmed image
+
+constexpr uint8_t kEspImageMagic = 0xE9;
+
+bool pendingVerify(const esp_partition_t* p) {
+  esp_ota_img_states_t st;
+  return p && esp_ota_get_state_partition(p, &st) == ESP_OK && st == ESP_OTA_IMG_PENDING_VERIFY;
+}
+
+bool trialSlot(Preferences& prefs, char* label, size_t cap) {
+  return prefs.getString(kTrialKey, label, cap) > 0 && label[0] != '\0';
+}
+}
+
+// The Arduino core confirms a pending image before setup() unless told
+// otherwise; confirmation here waits for MQTT (see Update::confirm()).
+extern "C" bool verifyRollbackLater() { return true; }
+
+namespace ota {
+
+struct Update::Inflate {
+  tinfl_decompressor state;
+  uint8_t            window[TINFL_LZ_DICT_SIZE];
+  size_t             pos = 0;
+};
+
+// ============================================================================
+// Start: target slot, HTTP request (the connection opens on the first step)
+// ============================================================================
+bool Update::start(net::INetClient& net, const char* url, uint32_t timeoutMs, uint32_t connectTimeoutMs) {
+  if (state_ == State::Downloading) return false;
+  release_();
+  format_ = Format::Unknown;
+  written_ = 0;
+  sniffLen_ = 0;
+  streamEnd_ = false;
+  error_ = "";
+
+  target_ = esp_ota_get_next_update_partition(nullptr);
+  if (!target_) return fail_("no OTA slot");
+  if (!get_.begin(net, url, timeoutMs, connectTimeoutMs)) return fail_(get_.error());
+
+  // Sequential writes: sectors are erased as they fill, not all up front
+  const esp_err_t err = esp_ota_begin(target_, OTA_WITH_SEQUENTIAL_WRITES, &handle_);
+  if (err != ESP_OK) return fail_(esp_err_to_name(err));
+  open_ = true;
+  state_ = State::Downloading;
+  return true;
+}
+
+// ============================================================================
+// One bounded step: download, inflate, write
+// ============================================================================
+bool Update::step(size_t budget) {
+  if (state_ != State::Downloading) return false;
+
+  size_t used = 0;
+  do {
+    const int n = get_.poll(chunk_, sizeof(chunk_));
+    if (n > 0) {
+      used += static_cast<size_t>(n);
+      if (!feed_(chunk_, static_cast<size_t>(n))) return false;
+    }
+    if (get_.failed()) return fail_(get_.error());
+    if (get_.done()) return finish_();
+    if (n <= 0) break;             // nothing more ready this pass
+  } while (used < budget);
+  return true;
+}
+
+void Update::abort(const char* why) {
+  if (state_ != State::Downloading) return;
+  fail_(why);
+}
+
+bool Update::feed_(const uint8_t* p, size_t n) {
+  if (format_ == Format::Unknown) {
+    // Collect enough to tell the format (and skip a gzip header) in one go
+    const size_t take = (n < kSniffBytes - sniffLen_) ? n : kSniffBytes - sniffLen_;
+    memcpy(sniffBuf_ + sniffLen_, p, take);
+    sniffLen_ += take;
+    p += take;
+    n -= take;
+    if (sniffLen_ < kSniffBytes) return true;
+    if (!sniff_()) return false;
+  }
+  if (n == 0) return true;
+  return format_ == Format::Plain ? write_(p, n) : inflate_(p, n);
+}
+
+// Plain app image (0xE9), gzip (1F 8B 08) or zlib (78 xx)
+bool Update::sniff_() {
+  const uint8_t* b = sniffBuf_;
+  const size_t len = sniffLen_;
+  if (len == 0) return fail_("empty image");
+
+  if (b[0] == kEspImageMagic) {
+    format_ = Format::Plain;
+    return write_(b, len);
+  }
+
+  size_t body = 0;
+  if (len >= 2 && b[0] == 0x78 && ((b[0] << 8) | b[1]) % 31 == 0) {
+    format_ = Format::Zlib;
+  } else if (len >= 10 && b[0] == 0x1F && b[1] == 0x8B && b[2] == 8) {
+    // RFC 1952 header: fixed 10 bytes, then the optional fields flags ask for
+    const uint8_t flags = b[3];
+    body = 10;
+    if (flags & 0x04) body += 2 + (len > body + 1 ? (b[body] | (b[body + 1] << 8)) : len);   // FEXTRA
+    for (uint8_t f : {uint8_t(0x08), uint8_t(0x10)}) {                                        // FNAME, FCOMMENT
+      if (!(flags & f)) continue;
+      while (body < len && b[body] != 0) ++body;
+      ++body;
+    }
+    if (flags & 0x02) body += 2;                                                               // FHCRC
+    if (body >= len) return fail_("gzip header too long");
+    format_ = Format::Gzip;
+  } else {
+    return fail_("unknown image format");
+  }
+
+  inflater_ = static_cast<Inflate*>(malloc(sizeof(Inflate)));
+  if (!inflater_) return fail_("no memory for inflate");
+  tinfl_init(&inflater_->state);
+  inflater_->pos = 0;
+  return inflate_(b + body, len - body);
+}
+
+bool Update::inflate_(const uint8_t* p, size_t n) {
+  if (streamEnd_) return true;     // gzip trailer (CRC, size): esp_ota_end() validates instead
+  Inflate& z = *inflater_;
+  const mz_uint32 flags = TINFL_FLAG_HAS_MORE_INPUT |
+                          (format_ == Format::Zlib ? TINFL_FLAG_PARSE_ZLIB_HEADER : 0);
+  for (;;) {
+    size_t in = n;
+    size_t out = TINFL_LZ_DICT_SIZE - z.pos;
+    const tinfl_status st = tinfl_decompress(&z.state, p, &in, z.window, z.window + z.pos, &out, flags);
+    p += in;
+    n -= in;
+    if (out && !write_(z.window + z.pos, out)) return false;
+    z.pos = (z.pos + out) & (TINFL_LZ_DICT_SIZE - 1);
+
+    if (st == TINFL_STATUS_DONE) { streamEnd_ = true; return true; }
+    if (st < 0) return fail_("inflate error");
+    if (st == TINFL_STATUS_NEEDS_MORE_INPUT && n == 0) return true;
+  }
+}
+
+bool Update::write_(const uint8_t* p, size_t n) {
+  if (written_ == 0 && p[0] != kEspImageMagic) return fail_("not an app image");
+  const esp_err_t err = esp_ota_write(handle_, p, n);
+  if (err != ESP_OK) return fail_(esp_err_to_name(err));
+  written_ += static_cast<uint32_t>(n);
+  return true;
+}
+
+// ============================================================================
+// Download complete: validate, switch the boot slot, start the trial
+// ============================================================================
+bool Update::finish_() {
+  if (format_ == Format::Unknown && !sniff_()) return false;   // image under kSniffBytes
+  if (compressed() && !streamEnd_) return fail_("truncated image");
+
+  open_ = false;
+  esp_err_t err = esp_ota_end(handle_);                        // checks the image hash
+  if (err != ESP_OK) return fail_(esp_err_to_name(err));
+  err = esp_ota_set_boot_partition(target_);
+  if (err != ESP_OK) return fail_(esp_err_to_name(err));
+
+  Preferences prefs;
+  if (prefs.begin(kNamespace, /*readOnly=*/false)) {
+    prefs.putString(kTrialKey, target_->label);
+    prefs.putUChar(kBootsKey, 0);
+    prefs.end();
+  }
+  release_();
+  state_ = State::Done;
+  return false;
+}
+
+void Update::release_() {
+  if (open_) {
+    esp_ota_abort(handle_);
+    open_ = false;
+  }
+  free(inflater_);
+  inflater_ = nullptr;
+}
+
+bool Update::fail_(const char* why) {
+  strncpy(errorText_, why ? why : "failed", sizeof(errorText_) - 1);
+  errorText_[sizeof(errorText_) - 1] = '\0';
+  error_ = errorText_;
+  get_.end();
+  release_();
+  state_ = State::Failed;
+  return false;
+}
+
+// ============================================================================
+// Trial boot bookkeeping
+// ============================================================================
+void Update::checkTrialBoot() {
+  Preferences prefs;
+  if (!prefs.begin(kNamespace, /*readOnly=*/false)) return;
+  char label[17] = {};
+  if (!trialSlot(prefs, label, sizeof(label))) { prefs.end(); return; }
+
+  const esp_partition_t* running = esp_ota_get_running_partition();
+  if (!running || strcmp(running->label, label) != 0) {
+    // The bootloader already went back (invalid image or its own rollback)
+    prefs.remove(kTrialKey);
+    prefs.putUChar(kBackKey, 1);
+    prefs.end();
+    return;
+  }
+
+  const uint8_t boots = static_cast<uint8_t>(prefs.getUChar(kBootsKey, 0) + 1);
+  prefs.putUChar(kBootsKey, boots);
+  prefs.end();
+  if (boots > kMaxTrialBoots) rollback();
+}
+
+bool Update::trialPending() {
+  if (pendingVerify(esp_ota_get_running_partition())) return true;
+  Preferences prefs;
+  if (!prefs.begin(kNamespace, /*readOnly=*/true)) return false;
+  char label[17] = {};
+  const bool trial = trialSlot(prefs, label, sizeof(label));
+  prefs.end();
+  return trial;
+}
+
+void Update::confirm() {
+  if (pendingVerify(esp_ota_get_running_partition())) esp_ota_mark_app_valid_cancel_rollback();
+  Preferences prefs;
+  if (prefs.begin(kNamespace, /*readOnly=*/false)) {
+    prefs.remove(kTrialKey);
+    prefs.remove(kBootsKey);
+    prefs.end();
+  }
+}
+
+void Update::rollback() {
+  Preferences prefs;
+  if (prefs.begin(kNamespace, /*readOnly=*/false)) {
+    prefs.remove(kTrialKey);
+    prefs.remove(kBootsKey);
+    prefs.putUChar(kBackKey, 1);
+    prefs.end();
+  }
+  if (pendingVerify(esp_ota_get_running_partition())) {
+    esp_ota_mark_app_invalid_rollback_and_reboot();   // does not return on success
+  }
+  // Two app slots: the other one holds the previous image
+  const esp_partition_t* previous = esp_ota_get_next_update_partition(nullptr);
+  if (previous && esp_ota_set_boot_partition(previous) == ESP_OK) esp_restart();
+}
+
+bool Update::takeRolledBack() {
+  Preferences prefs;
+  if (!prefs.begin(kNamespace, /*readOnly=*/false)) return false;
+  const bool back = prefs.getUChar(kBackKey, 0) != 0;
+  if (back) prefs.remove(kBackKey);
+  prefs.end();
+  return back;
+}
+
+const char* Update::runningLabel() {
+  const esp_partition_t* p = esp_ota_get_running_partition();
+  return p ? p->label : "?";
+}
+
+} // namespace ota
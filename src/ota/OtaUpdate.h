@@ -0,0 +1,111 @@
+#pragma once
+/**
+ * OtaUpdate
+ * - Pulls a firmware image over HTTP (http::Get) into the inactive app
+ *   slot, one bounded step per call, so the download runs as a network-task
+ *   job beside MQTT on whichever link is up.
+ * - Images may be plain (.bin), gzip (.bin.gz) or zlib: detected from the
+ *   first bytes and inflated on the fly with the ROM tinfl decoder. The
+ *   32 KB window is allocated for the update only.
+ * - esp_ota_end() validates the image before the boot slot is switched.
+ * - A/B trial boot: a new image boots on trial. confirm() keeps it. If it
+ *   is not confirmed within kMaxTrialBoots boots, or rollback() is called,
+ *   the previous slot boots again. With the IDF bootloader rollback enabled
+ *   the same calls drive it; without it an NVS counter (Preferences "ota")
+ *   does the job.
+ *
+ * This file is framework-specific (ESP-IDF OTA API under Arduino).
+ */
+#include <Arduino.h>
+#include <esp_ota_ops.h>
+#include "net/INetClient.h"
+#include "protocols/http/HttpGet.h"
+
+namespace ota {
+
+class Update {
+public:
+  enum class State : uint8_t { Idle, Downloading, Done, Failed };
+
+  /** Boots a new image may take without confirm() before the previous slot returns. */
+  static constexpr uint8_t kMaxTrialBoots = 3;
+
+  explicit Update(http::Get::ClockMs clock) : get_(clock) {}
+
+  /**
+   * Begin an update from `url` over `net`. False if one is already running or
+   * the URL is bad. `timeoutMs` is the stall limit, `connectTimeoutMs` the
+   * bound on the blocking TCP handshake.
+   */
+  bool start(net::INetClient& net, const char* url, uint32_t timeoutMs, uint32_t connectTimeoutMs);
+
+  /**
+   * Move the update on by at most `budget` downloaded bytes. Returns true
+   * while it is still running; state() tells how it ended.
+   */
+  bool step(size_t budget);
+
+  /** Give up (e.g. from a retry command); the partial slot is discarded. */
+  void abort(const char* why);
+
+  State       state() const { return state_; }
+  const char* error() const { return error_; }
+  bool        compressed() const { return format_ == Format::Gzip || format_ == Format::Zlib; }
+  uint32_t    received() const { return get_.received(); }   // bytes downloaded
+  uint32_t    written() const { return written_; }           // image bytes in flash
+  int32_t     total() const { return get_.contentLength(); } // download size, -1 unknown
+
+  // ---- Boot side (setup / network task) ----
+
+  /** Early in setup(): count this trial boot; back to the previous slot after kMaxTrialBoots. */
+  static void checkTrialBoot();
+
+  /** The running image was just installed and is not confirmed yet. */
+  static bool trialPending();
+
+  /** Keep the running image (ends the trial). */
+  static void confirm();
+
+  /** Boot the other slot again. Restarts; returns only if there is nothing to go back to. */
+  static void rollback();
+
+  /** True once after a boot that fell back from an unconfirmed image. */
+  static bool takeRolledBack();
+
+  /** Label of the running slot ("app0" / "app1"). */
+  static const char* runningLabel();
+
+private:
+  enum class Format : uint8_t { Unknown, Plain, Gzip, Zlib };
+  struct Inflate;
+
+  static constexpr size_t kSniffBytes = 512;   // gzip header incl. file name
+  static constexpr size_t kChunk = 1024;
+
+  bool feed_(const uint8_t* p, size_t n);
+  bool sniff_();
+  bool inflate_(const uint8_t* p, size_t n);
+  bool write_(const uint8_t* p, size_t n);
+  bool finish_();
+  void release_();
+  bool fail_(const char* why);
+
+  http::Get       get_;
+  State           state_ = State::Idle;
+  Format          format_ = Format::Unknown;
+  const char*     error_ = "";
+  char            errorText_[40] = {};
+
+  const esp_partition_t* target_ = nullptr;
+  esp_ota_handle_t handle_ = 0;
+  bool             open_ = false;
+  uint32_t         written_ = 0;
+
+  Inflate*  inflater_ = nullptr;   // heap, update only
+  bool      streamEnd_ = false;
+  uint8_t   sniffBuf_[kSniffBytes] = {};
+  size_t    sniffLen_ = 0;
+  uint8_t   chunk_[kChunk] = {};
+};
+
+} // namespace ota
@@ -1,38 +1,9 @@
 
 #include <cstdio>
-#include <cmath>
 
-#include "boardkit.hpp"
-
-namespace allegro_constants {
-  constexpr float kPi       = 3.14159265358979323846f;
-  constexpr float kDegToRad = kPi / 180.0f;
-  constexpr float kRadToDeg = 180.0f / kPi;
-}
-
-// ============================================================================
-// HELPER FUNCTIONS FOR ANGLE HANDLING
-// ============================================================================
-
-/**
- * Normalize angle to 0-360 degree range.
- */
-static float normalizeAngle(float angle) {
-  while (angle < 0.0f) angle += 360.0f;
-  while (angle >= 360.0f) angle -= 360.0f;
-  return angle;
-}
-
-/**
- * Calculate shortest angular distance from 'from' to 'to'.
- * Returns value in range [-180, 180].
- */
-static float shortestAngularDistance(float from, float to) {
-  float diff = to - from;
-  if (diff > 180.0f) diff -= 360.0f;
-  if (diff < -180.0f) diff += 360.0f;
-  return diff;
-}
+#include "drivers/allegro/als31300.h"
+#include "drivers/allegro/als31300Registers.h"
+#include "util/Profiler.h"
 
 // ============================================================================
 // ALS31300 SENSOR IMPLEMENTATION
@@ -59,46 +30,235 @@ namespace ALS31300
         i2cChangeAddress = changeAddressCallback;
     }
 
-    Sensor::Sensor(uint8_t address) : address(address & 0x7F)
+    Sensor::Sensor(uint8_t address)
+        : address(address & 0x7F), transport_{nullptr, legacyRead, legacyWrite}
     {
         i2cRegister(address);
     }
 
+    Sensor::Sensor(uint8_t address, const Transport& transport)
+        : address(address & 0x7F), transport_(transport), legacy_(false)
+    {
+        if (!transport_.read) transport_.read = defaultTransportRead;
+        if (!transport_.write) transport_.write = defaultTransportWrite;
+    }
+
     Sensor::~Sensor()
     {
-        i2cUnregister(address);
+        if (legacy_) i2cUnregister(address);
+    }
+
+    void Sensor::restart(uint8_t newAddress)
+    {
+        newAddress &= 0x7F;
+        if (legacy_ && newAddress != address)
+        {
+            i2cUnregister(address);
+            i2cRegister(newAddress);
+        }
+        address = newAddress;
+
+        x = y = z = 0;
+        rawX = rawY = rawZ = 0;
+        xAcc_ = yAcc_ = zAcc_ = 0;
+        primed_ = false;
+        readMode_ = ReadMode::TwoReads;
+        loopPrimed_ = false;
+        newData_ = false;
+        interrupt_ = false;
+        lowPower_ = false;
     }
 
     bool Sensor::update()
     {
+        PROF_SCOPE("als.update");
         uint16_t newX, newY, newZ;
 
-        // Read MSBs from register 0x28
-        uint32_t readData;
-        if (!read(0x28, readData)) return false;
-        Register0x28 reg28{readData};
+        uint32_t data28 = 0, data29 = 0;
+        if (!readMeasurement(data28, data29)) return false;
+        Register0x28 reg28{data28};
+        Register0x29 reg29{data29};
 
-        newX = reg28.xAxisMsbs << 8;
-        newY = reg28.yAxisMsbs << 8;
-        newZ = reg28.zAxisMsbs << 8;
+        // No new conversion since the last read: skip the filter math
+        interrupt_ = reg28.interrupt;
+        newData_ = reg28.newData;
+        if (!newData_) return true;
 
-        // Read LSBs from register 0x29
-        if (!read(0x29, readData)) return false;
-        Register0x29 reg29{readData};
+        // 12-bit fields: 8 MSBs from register 0x28, 4 LSBs from register 0x29
+        newX = reg28.xAxisMsbs << 4;
+        newY = reg28.yAxisMsbs << 4;
+        newZ = reg28.zAxisMsbs << 4;
 
         newX |= reg29.xAxisLsbs;
         newY |= reg29.yAxisLsbs;
         newZ |= reg29.zAxisLsbs;
 
-        // Apply low-pass filter to reduce noise
-        const float filterIntensity = 32.0f;
-        x = (float((int16_t) newX) + x * (filterIntensity - 1.0f)) / filterIntensity;
-        y = (float((int16_t) newY) + y * (filterIntensity - 1.0f)) / filterIntensity;
-        z = (float((int16_t) newZ) + z * (filterIntensity - 1.0f)) / filterIntensity;
+        // Temperature (datasheet): T[C] = 302 * (value - 1708) / 4096
+        const int32_t rawTemp = (int32_t(reg28.temperatureMsbs) << 6) | reg29.temperatureLsbs;
+        temperatureCenti = int16_t((30200 * (rawTemp - 1708)) / 4096);
+
+        // Sign-extend the 12-bit two's complement fields
+        const int32_t sx = int32_t(int16_t(uint16_t(newX << 4))) >> 4;
+        const int32_t sy = int32_t(int16_t(uint16_t(newY << 4))) >> 4;
+        const int32_t sz = int32_t(int16_t(uint16_t(newZ << 4))) >> 4;
+        rawX = int16_t(sx);
+        rawY = int16_t(sy);
+        rawZ = int16_t(sz);
+
+        // Shift-based low-pass filter: acc += raw - acc / 2^shift
+        if (!primed_)
+        {
+            xAcc_ = sx << filterShift_;
+            yAcc_ = sy << filterShift_;
+            zAcc_ = sz << filterShift_;
+            primed_ = true;
+        }
+        else
+        {
+            xAcc_ += sx - (xAcc_ >> filterShift_);
+            yAcc_ += sy - (yAcc_ >> filterShift_);
+            zAcc_ += sz - (zAcc_ >> filterShift_);
+        }
+
+        x = int16_t(xAcc_ >> filterShift_);
+        y = int16_t(yAcc_ >> filterShift_);
+        z = int16_t(zAcc_ >> filterShift_);
 
         return true;
     }
 
+    bool Sensor::readMeasurement(uint32_t& reg28, uint32_t& reg29)
+    {
+        auto word = [](const uint8_t* b) -> uint32_t {
+            return uint32_t(b[0]) << 24 | uint32_t(b[1]) << 16 |
+                   uint32_t(b[2]) <<  8 | uint32_t(b[3]);
+        };
+
+        switch (readMode_)
+        {
+            case ReadMode::TwoReads:
+                return read(0x28, reg28) && read(0x29, reg29);
+
+            case ReadMode::Burst:
+            {
+                uint8_t index = 0x28;
+                uint8_t block[8];
+                if (!busRead(&index, 1, block, sizeof(block))) return false;
+                reg28 = word(block);
+                reg29 = word(block + 4);
+                return true;
+            }
+
+            case ReadMode::FastLoop:
+            case ReadMode::FullLoop:
+            {
+                const bool full = (readMode_ == ReadMode::FullLoop);
+                uint8_t index = 0x28;
+                uint8_t block[8];
+                const size_t n = full ? 8 : 4;
+
+                // Only the first read after (re)priming needs the index phase
+                if (!busRead(&index, loopPrimed_ ? 0 : 1, block, n))
+                {
+                    loopPrimed_ = false;
+                    return false;
+                }
+                loopPrimed_ = true;
+
+                reg28 = word(block);
+                // Fast loop carries MSBs only; LSBs read as zero
+                reg29 = full ? word(block + 4) : 0;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Sensor::setReadMode(ReadMode mode)
+    {
+        // Register 0x27 always gets programmed so leaving a loop mode
+        // restores single-read addressing on the part (and a restart()
+        // brings a part left duty-cycling back to continuous conversion).
+        if (!writeRegister27(mode, lowPower_, lowPowerInterval_)) return false;
+
+        readMode_ = mode;
+        return true;
+    }
+
+    bool Sensor::setLowPower(bool enable, LowPowerInterval interval)
+    {
+        if (!writeRegister27(readMode_, enable, interval)) return false;
+        lowPower_ = enable;
+        lowPowerInterval_ = interval;
+
+        // Latched INT from before: the next delta compare starts from here
+        return !enable || clearInterrupt();
+    }
+
+    bool Sensor::writeRegister27(ReadMode mode, bool lowPower, LowPowerInterval interval)
+    {
+        uint32_t loopMode = 0;
+        if (mode == ReadMode::FastLoop) loopMode = 1;
+        if (mode == ReadMode::FullLoop) loopMode = 2;
+
+        if (!write(customerAccessRegister, customerAccessCode)) return false;
+
+        uint32_t readData;
+        if (!read(0x27, readData)) return false;
+
+        // sleep: 0 = active, 2 = low-power duty-cycle mode
+        Register0x27 reg27{readData};
+        reg27.i2cLoopMode = loopMode;
+        reg27.sleep = lowPower ? 2 : 0;
+        reg27.lowPowerCounter = uint32_t(interval);
+        if (!write(0x27, reg27.raw)) return false;
+
+        // The register pointer moved: the next loop read needs its index again
+        loopPrimed_ = false;
+        return true;
+    }
+
+    bool Sensor::setWakeThresholds(uint8_t xThreshold, uint8_t yThreshold)
+    {
+        if (!write(customerAccessRegister, customerAccessCode)) return false;
+
+        uint32_t data02, data03;
+        if (!read(0x02, data02) || !read(0x03, data03)) return false;
+
+        // Latch INT until clearInterrupt(), so a brief swing is never missed
+        Register0x02 reg02{data02};
+        reg02.intLatchEnable = 1;
+
+        // Delta mode on the magnitude of the X/Y change; Z does not move with the barrel
+        Register0x03 reg03{data03};
+        reg03.xIntThreshold = xThreshold > 63 ? 63 : xThreshold;
+        reg03.yIntThreshold = yThreshold > 63 ? 63 : yThreshold;
+        reg03.xIntEnable = 1;
+        reg03.yIntEnable = 1;
+        reg03.zIntEnable = 0;
+        reg03.intEepromEnable = 0;
+        reg03.intMode = 1;
+        reg03.signedIntEnable = 0;
+
+        // EEPROM cells: only rewrite what changed
+        if (reg02.raw != data02 && !write(0x02, reg02.raw)) return false;
+        if (reg03.raw != data03 && !write(0x03, reg03.raw)) return false;
+
+        loopPrimed_ = false;
+        return true;
+    }
+
+    bool Sensor::clearInterrupt()
+    {
+        Register0x29 reg29{0};
+        reg29.intWrite = 1;
+        if (!write(0x29, reg29.raw)) return false;
+
+        interrupt_ = false;
+        loopPrimed_ = false;
+        return true;
+    }
+
     bool Sensor::programAddress(uint8_t newAddress)
     {
         newAddress &= 0x7F;
@@ -133,7 +293,7 @@ namespace ALS31300
             uint8_t(value >>  0 & 0xFF)
         };
 
-        return i2cWrite(address, sendPayload, 5);
+        return busWrite(sendPayload, 5);
     }
 
     bool Sensor::read(uint8_t reg, uint32_t& value)
@@ -141,7 +301,7 @@ namespace ALS31300
         uint8_t sendPayload = reg;
         uint8_t receivePayload[4];
 
-        if (!i2cRead(address, &sendPayload, 1, receivePayload, 4)) return false;
+        if (!busRead(&sendPayload, 1, receivePayload, 4)) return false;
 
         value = receivePayload[0] << 24 |
                 receivePayload[1] << 16 |
@@ -151,22 +311,10 @@ namespace ALS31300
         return true;
     }
 
-    uint16_t Sensor::getAngle()
-    {
-        // Return raw angle directly without filtering
-        float rawAngle = angleFromXY(x, y);
-        return static_cast<uint16_t>(normalizeAngle(rawAngle) + 0.5f);
-    }
-
-    float Sensor::angleFromXY(float x, float y)
-    {
-        float angle = atan2f(y, x) * allegro_constants::kRadToDeg;
-        return normalizeAngle(angle);
-    }
-
-    void Sensor::xyFromAngle(float angle, float& x, float& y)
+    util::Angle Sensor::angle() const
     {
-        x = cosf(angle * allegro_constants::kDegToRad);
-        y = sinf(angle * allegro_constants::kDegToRad);
+        // The accumulators share one scale, so feed them straight to atan2
+        // and keep the fractional bits the >> would throw away.
+        return util::atan2Cdeg(yAcc_, xAcc_);
     }
 }
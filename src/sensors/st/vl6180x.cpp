@@ -0,0 +1,163 @@
+
+#include "drivers/st/vl6180x.h"
+
+// ============================================================================
+// VL6180X REGISTER MAP (subset used for continuous ranging)
+// ============================================================================
+
+namespace vl6180x_regs {
+  constexpr uint16_t SYSTEM__MODE_GPIO1                = 0x0011;
+  constexpr uint16_t SYSTEM__INTERRUPT_CONFIG_GPIO     = 0x0014;
+  constexpr uint16_t SYSTEM__INTERRUPT_CLEAR           = 0x0015;
+  constexpr uint16_t SYSRANGE__START                   = 0x0018;
+  constexpr uint16_t SYSRANGE__INTERMEASUREMENT_PERIOD = 0x001B;
+  constexpr uint16_t SYSRANGE__MAX_CONVERGENCE_TIME    = 0x001C;
+  constexpr uint16_t RESULT__RANGE_STATUS              = 0x004D;
+  constexpr uint16_t RESULT__INTERRUPT_STATUS_GPIO     = 0x004F;
+  constexpr uint16_t RESULT__RANGE_VAL                 = 0x0062;
+
+  constexpr uint8_t GPIO1_INTERRUPT_ACTIVE_LOW = 0x10;  // GPIO1 = interrupt output, active low
+  constexpr uint8_t INT_RANGE_NEW_SAMPLE       = 0x04;  // range: new sample ready
+  constexpr uint8_t INT_CLEAR_ALL              = 0x07;
+  constexpr uint8_t RANGE_START_CONTINUOUS     = 0x03;
+  constexpr uint8_t RANGE_START_STOP           = 0x01;  // start bit toggles continuous mode off
+
+  constexpr uint16_t READOUT_OVERHEAD_MS       = 5;     // readout averaging + margin
+  constexpr uint8_t  IRQ_STALL_PERIODS         = 4;     // poll status after this many quiet periods
+}
+
+// ============================================================================
+// VL6180X RANGING ENGINE
+// ============================================================================
+
+namespace VL6180X
+{
+    RangingEngine::RangingEngine(I2CBus& bus, GpioPin gpio1, uint8_t address)
+    : bus_(bus), gpio1_(gpio1), address_(address & 0x7F)
+    {
+    }
+
+    bool RangingEngine::start(const RangingConfig& config)
+    {
+        using namespace vl6180x_regs;
+
+        config_ = config;
+
+        // Clamp to what the part accepts, keeping period > convergence + readout
+        if (config_.maxConvergenceMs < 1) config_.maxConvergenceMs = 1;
+        if (config_.maxConvergenceMs > 63) config_.maxConvergenceMs = 63;
+        const uint16_t minPeriod = config_.maxConvergenceMs + READOUT_OVERHEAD_MS;
+        if (config_.intermeasurementMs < minPeriod) config_.intermeasurementMs = minPeriod;
+        if (config_.intermeasurementMs > 2550) config_.intermeasurementMs = 2550;
+
+        // Period register counts in 10 ms units, minus one; round up
+        uint16_t periodCode = (config_.intermeasurementMs + 9) / 10;
+        periodCode = (periodCode > 0) ? periodCode - 1 : 0;
+
+        if (!write8(SYSTEM__MODE_GPIO1, GPIO1_INTERRUPT_ACTIVE_LOW)) return false;
+        if (!write8(SYSTEM__INTERRUPT_CONFIG_GPIO, INT_RANGE_NEW_SAMPLE)) return false;
+        if (!write8(SYSRANGE__MAX_CONVERGENCE_TIME, config_.maxConvergenceMs)) return false;
+        if (!write8(SYSRANGE__INTERMEASUREMENT_PERIOD, static_cast<uint8_t>(periodCode))) return false;
+        if (!write8(SYSTEM__INTERRUPT_CLEAR, INT_CLEAR_ALL)) return false;
+
+        ready_ = false;
+        if (gpio1_.valid())
+        {
+            gpio1_.setMode(GpioMode::Input);
+            gpio1_.setPull(Pull::Up);               // GPIO1 is open-drain on the part
+            gpio1_.begin();
+            gpio1_.attachIrq(&RangingEngine::onReady, this, GpioEdge::Falling);
+        }
+
+        if (!write8(SYSRANGE__START, RANGE_START_CONTINUOUS)) return false;
+
+        lastSampleMs_ = millis();
+        running_ = true;
+        return true;
+    }
+
+    bool RangingEngine::stop()
+    {
+        using namespace vl6180x_regs;
+
+        if (gpio1_.valid()) gpio1_.detachIrq();
+        const bool wasRunning = running_;
+        running_ = false;
+        ready_ = false;
+
+        if (!wasRunning) return true;
+        if (!write8(SYSRANGE__START, RANGE_START_STOP)) return false;
+        return write8(SYSTEM__INTERRUPT_CLEAR, INT_CLEAR_ALL);
+    }
+
+    bool RangingEngine::poll(RangeSample& out)
+    {
+        using namespace vl6180x_regs;
+
+        if (!running_) return false;
+
+        const unsigned long now = millis();
+        if (!sampleReady(now)) return false;
+
+        uint8_t range = 0, status = 0;
+        if (!read8(RESULT__RANGE_VAL, range)) return false;
+        if (!read8(RESULT__RANGE_STATUS, status)) return false;
+
+        // Re-arm GPIO1 for the next measurement
+        write8(SYSTEM__INTERRUPT_CLEAR, INT_CLEAR_ALL);
+
+        out.rangeMm = range;
+        out.status  = status >> 4;
+        out.tsMs    = now;
+        lastSampleMs_ = now;
+        return true;
+    }
+
+    bool RangingEngine::sampleReady(unsigned long nowMs)
+    {
+        using namespace vl6180x_regs;
+
+        if (gpio1_.valid())
+        {
+            if (ready_)
+            {
+                ready_ = false;
+                return true;
+            }
+
+            // Quiet for too long: a missed edge leaves GPIO1 asserted forever,
+            // so check the status register and let the clear re-arm it.
+            const unsigned long stallMs =
+                static_cast<unsigned long>(config_.intermeasurementMs) * IRQ_STALL_PERIODS;
+            if (nowMs - lastSampleMs_ < stallMs) return false;
+        }
+
+        uint8_t intStatus = 0;
+        if (!read8(RESULT__INTERRUPT_STATUS_GPIO, intStatus)) return false;
+        if ((intStatus & 0x07) != INT_RANGE_NEW_SAMPLE)
+        {
+            if (gpio1_.valid()) lastSampleMs_ = nowMs;  // don't re-check every call
+            return false;
+        }
+        return true;
+    }
+
+    void IRAM_ATTR RangingEngine::onReady(void* arg)
+    {
+        auto* self = static_cast<RangingEngine*>(arg);
+        self->ready_ = true;
+        if (self->hook_) self->hook_(self->hookArg_);
+    }
+
+    bool RangingEngine::write8(uint16_t reg, uint8_t value)
+    {
+        const uint8_t payload[3] = { uint8_t(reg >> 8), uint8_t(reg & 0xFF), value };
+        return bus_.write(address_, payload, sizeof(payload));
+    }
+
+    bool RangingEngine::read8(uint16_t reg, uint8_t& value)
+    {
+        const uint8_t index[2] = { uint8_t(reg >> 8), uint8_t(reg & 0xFF) };
+        return bus_.read(address_, index, sizeof(index), &value, 1);
+    }
+}
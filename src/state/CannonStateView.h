@@ -1,6 +1,10 @@
 #pragma once
 #include <cstdint>
-#include <cmath>
+#include <tuple>
+#include <type_traits>
+#include "state/ControllerState.h"
+#include "util/Angle.h"
+#include "util/FieldSchema.h"
 
 // Change bits local to the cannon view
 namespace cannon {
@@ -11,80 +15,77 @@ enum : uint32_t {
   ChangedFired  = 1u << 2,
 };
 
+// How a watched snapshot field turns into a view change
+enum class Trigger : uint8_t {
+  Quantized,   // value / field quantum changed (e.g. whole degrees)
+  Rising,      // false -> true edge
+};
+
+template <typename F>
+struct ViewField {
+  F        field;     // a ctl::schema descriptor
+  uint32_t flag;      // view change bit
+  Trigger  trigger;
+};
+
+template <typename F>
+constexpr ViewField<F> watch(const F& field, uint32_t flag, Trigger trigger) {
+  return ViewField<F>{field, flag, trigger};
+}
+
+// What the cannon publishes: angle in whole degrees (no jitter spam),
+// loaded/fired on their rising edges
+constexpr auto kViewFields = std::make_tuple(
+    watch(ctl::schema::kAngle,   ChangedAngle,  Trigger::Quantized),
+    watch(ctl::schema::kPresent, ChangedLoaded, Trigger::Rising),
+    watch(ctl::schema::kButton,  ChangedFired,  Trigger::Rising));
+
 template <typename StateT>
 class StateView {
 public:
-  using AngleGetter = float (*)(const StateT&);
-  using BoolGetter  = bool  (*)(const StateT&);
-
-  StateView(StateT& s,
-            AngleGetter getAngle,
-            BoolGetter  getLoaded,
-            BoolGetter  getFired)
-  : s_(s), getAngle_(getAngle), getLoaded_(getLoaded), getFired_(getFired) {}
+  explicit StateView(const StateT& s) : s_(s) {}
 
   // Call once per loop after ControllerState has been updated.
   uint32_t update() {
+    const ctl::Snapshot& snap = s_.current();
     uint32_t changed = ChangedNone;
 
-    // Angle: quantize to integer degrees to avoid jitter spam
-    const float a = getAngle_(s_);
-    const int   q = normalize360(a);
-    if (q != angleDegInt_) {
-      angleDegInt_ = q;
-      angleDeg_    = a;
-      changed |= ChangedAngle;
-    }
-
-    // Loaded: rising edge
-    const bool ld = getLoaded_(s_);
-    justLoaded_ = (ld && !loaded_);
-    if (justLoaded_) changed |= ChangedLoaded;
-    loaded_ = ld;
-
-    // Fired: rising edge
-    const bool fd = getFired_(s_);
-    justFired_ = (fd && !fired_);
-    if (justFired_) changed |= ChangedFired;
-    fired_ = fd;
+    util::schema::forEach(kViewFields, [&](const auto& v, auto i) {
+      using C = typename std::decay_t<decltype(v.field)>::Codec;
+      const int32_t q = C::quantize(v.field.get(snap), v.field.quantum);
+      const bool hit = (v.trigger == Trigger::Rising) ? (q && !last_[i]) : (q != last_[i]);
+      if (hit) changed |= v.flag;
+      last_[i] = q;
+    });
+    if (changed & ChangedAngle) angle_ = snap.angle;
 
     lastChange_ = changed;
     return changed;
   }
 
   // What the publisher needs:
-  float    angleDeg()   const { return angleDeg_; }
-  bool     justLoaded() const { return justLoaded_; }
-  bool     justFired()  const { return justFired_; }
+  util::Angle angle()   const { return angle_; }
+  int      angleDeg()   const { return angle_.deg(); }
+  bool     justLoaded() const { return (lastChange_ & ChangedLoaded) != 0; }
+  bool     justFired()  const { return (lastChange_ & ChangedFired) != 0; }
   uint32_t lastChangeMask() const { return lastChange_; }
 
   // Reset loaded and fired flags (call after firing to allow new cycle)
   void resetLoadedAndFired() {
-    loaded_ = false;
-    fired_ = false;
-    justLoaded_ = false;
-    justFired_ = false;
+    util::schema::forEach(kViewFields, [&](const auto& v, auto i) {
+      if (v.trigger == Trigger::Rising) last_[i] = 0;
+    });
+    lastChange_ &= ~(ChangedLoaded | ChangedFired);
   }
 
 private:
-  static int normalize360(float deg) {
-    float m = std::fmod(deg, 360.0f);
-    if (m < 0) m += 360.0f;
-    return static_cast<int>(std::lround(m));
-  }
+  static constexpr std::size_t kCount = std::tuple_size<decltype(kViewFields)>::value;
 
   const StateT& s_;
-  AngleGetter   getAngle_;
-  BoolGetter    getLoaded_;
-  BoolGetter    getFired_;
 
   // cached view
-  float    angleDeg_     = 0.0f;
-  int      angleDegInt_  = 0;   // 0..359
-  bool     loaded_       = false;
-  bool     fired_        = false;
-  bool     justLoaded_   = false;
-  bool     justFired_    = false;
-  uint32_t lastChange_   = ChangedNone;
+  util::Angle angle_       {};
+  int32_t  last_[kCount]   = {};   // last quantized value per watched field
+  uint32_t lastChange_     = ChangedNone;
 };
 } // namespace cannon
@@ -4,24 +4,31 @@
  * @brief Snapshot of all relevant controller/sensor data + change tracking.
  *
  * - No Arduino deps. Pure C++.
- * - Zero heap: caller passes output buffers.
- * - Designed to publish either full snapshot or "deltas" over MQTT.
+ * - Zero heap: serializers write into a caller buffer or any util::ByteSink.
+ * - Designed to publish either full snapshot or "deltas" over MQTT, as JSON
+ *   or in the compact binary forms described by ctl::wire.
  * - You decide what "present" means for your distance sensor (threshold or valid flag).
+ * - ctl::schema lists every Snapshot field once; the change mask and all four
+ *   encoders are generated from it (util/FieldSchema.h). Add a field there.
  */
 
+#include <cstddef>
 #include <cstdint>
-#include <cstdio>
-#include <cmath>
+#include "util/Angle.h"
+#include "util/ByteSink.h"
+#include "util/CborWriter.h"
+#include "util/FieldSchema.h"
+#include "util/JsonWriter.h"
 
 namespace ctl {
 
-/** Small epsilon for float comparisons (degrees). */
-constexpr float kAngleEpsDeg = 0.25f;
+/** Minimum angle movement that counts as a change (centi-degrees). */
+constexpr uint16_t kAngleEpsCdeg = 25;
 
 /** Snapshot of current readings. Extend as needed. */
 struct Snapshot {
   uint32_t tsMs            = 0;    // timestamp (millis)
-  float    angleDeg        = 0.0f; // ALS31300
+  util::Angle angle        {};     // ALS31300, centi-degrees
   bool     buttonPressed   = false;// DebouncedButton
   uint16_t distanceMm      = 0;    // VL6180X (0..~200 mm typical)
   bool     targetPresent   = false;// Derived or sensor-provided "seen" flag
@@ -37,26 +44,73 @@ enum ChangeFlags : uint32_t {
   ChangedTimeOnly   = 1u << 4, // heartbeat (time progressed, data same)
 };
 
+/**
+ * Binary wire schema for the parallel ".bin" telemetry topics.
+ *
+ * CBOR: a map keyed by small integers (one byte each), holding only the
+ * fields in the mask; tsMs is always present.
+ *   0: tsMs (uint)  1: angle, centi-degrees (uint)  2: button (bool)
+ *   3: distanceMm (uint)  4: present (bool)
+ *
+ * Packed v1: 12 bytes, little-endian, every field always present.
+ *   [0]     version (kPackedVersion)
+ *   [1]     change mask (ChangeFlags; kAllFields for a snapshot)
+ *   [2]     flags: bit0 button, bit1 present
+ *   [3]     reserved, 0
+ *   [4..7]  tsMs
+ *   [8..9]  angle, centi-degrees
+ *   [10..11] distanceMm
+ * Bump kPackedVersion on any layout change; consumers must check byte 0.
+ */
+namespace wire {
+enum FieldKey : uint8_t { KeyTs = 0, KeyAngle = 1, KeyButton = 2, KeyDistance = 3, KeyPresent = 4 };
+constexpr uint8_t     kPackedVersion = 1;
+constexpr std::size_t kPackedSize    = 12;
+constexpr uint8_t     kFlagButton    = 1u << 0;
+constexpr uint8_t     kFlagPresent   = 1u << 1;
+} // namespace wire
+
+/**
+ * The Snapshot schema: key, CBOR key, change bit, member, deadband,
+ * view quantum, packed offset (and bit, for flags).
+ */
+namespace schema {
+using util::schema::field;
+constexpr auto kTs       = field(JSON_KEY("t"),    wire::KeyTs,       ChangedNone,     &Snapshot::tsMs,          0,             1,   4);
+constexpr auto kAngle    = field(JSON_KEY("ang"),  wire::KeyAngle,    ChangedAngle,    &Snapshot::angle,         kAngleEpsCdeg, 100, 8);
+constexpr auto kButton   = field(JSON_KEY("btn"),  wire::KeyButton,   ChangedButton,   &Snapshot::buttonPressed, 0,             1,   2, 0);
+constexpr auto kDistance = field(JSON_KEY("dist"), wire::KeyDistance, ChangedDistance, &Snapshot::distanceMm,    0,             1,   10);
+constexpr auto kPresent  = field(JSON_KEY("prs"),  wire::KeyPresent,  ChangedPresence, &Snapshot::targetPresent, 0,             1,   2, 1);
+
+constexpr auto kFields = std::make_tuple(kTs, kAngle, kButton, kDistance, kPresent);
+constexpr std::size_t kFieldCount = std::tuple_size<decltype(kFields)>::value;
+constexpr std::size_t kAngleIndex = 1;   // position of kAngle in kFields (runtime deadband)
+static_assert(std::get<kAngleIndex>(kFields).flag == ChangedAngle, "kAngleIndex out of date");
+} // namespace schema
+
+/** Every data field (a full snapshot in the mask-driven encoders). */
+constexpr uint32_t kAllFields = util::schema::allFlags(schema::kFields);
+
 /** State object that holds last and current snapshot + change mask. */
 class State {
 public:
   State() = default;
 
   /** Set thresholds/policies without coupling to sensors. */
-  void setAngleEpsilon(float deg) { angleEpsDeg_ = deg; }
+  void setAngleEpsilonCdeg(uint16_t cdeg) { deadband_[schema::kAngleIndex] = cdeg; }
   void setPresenceDistanceThreshold(uint16_t mm) { presenceThresholdMm_ = mm; }
   void setHeartbeatMs(uint32_t ms) { heartbeatMs_ = ms; }
 
   /** Update from new raw readings. Returns change mask. */
   uint32_t update(uint32_t tsMs,
-                  float    angleDeg,
+                  util::Angle angle,
                   bool     buttonPressed,
                   uint16_t distanceMm,
                   bool     distanceValid /* if your driver reports validity */)
   {
     last_ = now_; // keep previous snapshot
     now_.tsMs          = tsMs;
-    now_.angleDeg      = angleDeg;
+    now_.angle         = angle;
     now_.buttonPressed = buttonPressed;
     now_.distanceMm    = distanceMm;
 
@@ -69,11 +123,7 @@ public:
     }
 
     // Compute changes
-    uint32_t mask = ChangedNone;
-    if (std::fabs(now_.angleDeg - last_.angleDeg) > angleEpsDeg_) mask |= ChangedAngle;
-    if (now_.buttonPressed != last_.buttonPressed)                 mask |= ChangedButton;
-    if (now_.distanceMm    != last_.distanceMm)                    mask |= ChangedDistance;
-    if (now_.targetPresent != last_.targetPresent)                 mask |= ChangedPresence;
+    uint32_t mask = util::schema::changeMask(schema::kFields, now_, last_, deadband_);
 
     // Heartbeat (time changed but no data changes)
     if (mask == ChangedNone && heartbeatMs_ > 0) {
@@ -92,56 +142,57 @@ public:
   uint32_t lastChangeMask() const { return lastChangeMask_; }
 
   /**
-   * Serialize as compact JSON (retained “state” message).
-   * Example: {"t":12345,"ang":12.5,"btn":1,"dist":87,"prs":1}
-   * Returns true if fully written.
+   * Serialize as compact JSON (retained “state” message) into any sink.
+   * Example: {"t":12345,"ang":12.50,"btn":1,"dist":87,"prs":1}
+   * Deterministic, so it can run twice for a measured, streamed publish.
+   * Returns true if the sink accepted everything.
    */
-  bool toJson(char* out, size_t cap) const {
-    if (!out || cap == 0) return false;
-    int n = std::snprintf(out, cap,
-      "{\"t\":%lu,\"ang\":%.2f,\"btn\":%d,\"dist\":%u,\"prs\":%d}",
-      static_cast<unsigned long>(now_.tsMs),
-      static_cast<double>(now_.angleDeg),
-      now_.buttonPressed ? 1 : 0,
-      static_cast<unsigned>(now_.distanceMm),
-      now_.targetPresent ? 1 : 0);
-    return n > 0 && static_cast<size_t>(n) < cap;
+  bool writeJson(util::ByteSink& out) const {
+    return writeDeltaJson(out, kAllFields);
   }
 
   /**
    * Serialize only changed fields (“delta” message). Always includes ts.
    * Example (angle & button changed):
-   *   {"t":12345,"ang":12.5,"btn":0}
+   *   {"t":12345,"ang":12.50,"btn":0}
    */
+  bool writeDeltaJson(util::ByteSink& out, uint32_t changeMask) const {
+    util::JsonWriter w(out);
+    w.beginObject();
+    util::schema::writeJson(schema::kFields, w, now_, changeMask);
+    w.endObject();
+    return w.ok();
+  }
+
+  /** CBOR map of tsMs + the fields in `mask` (see ctl::wire). */
+  bool writeCbor(util::ByteSink& out, uint32_t mask) const {
+    uint8_t buf[util::schema::cborMaxBytes(schema::kFields)];
+    util::CborWriter c(buf, sizeof(buf));
+    util::schema::writeCbor(schema::kFields, c, now_, mask & kAllFields);
+    return c.ok() && out.put(reinterpret_cast<const char*>(buf), c.size());
+  }
+
+  /** Fixed 12-byte packed record (see ctl::wire); mask goes in byte 1. */
+  bool writePacked(util::ByteSink& out, uint32_t mask) const {
+    uint8_t b[wire::kPackedSize] = {};
+    b[0] = wire::kPackedVersion;
+    b[1] = static_cast<uint8_t>(mask & 0xFF);
+    util::schema::pack(schema::kFields, b, now_);
+    return out.put(reinterpret_cast<const char*>(b), sizeof(b));
+  }
+
+  /** Buffer variants of the JSON forms; NUL-terminated, true if fully written. */
+  bool toJson(char* out, size_t cap) const {
+    util::BufferSink sink(out, cap);
+    return writeJson(sink) && sink.ok();
+  }
+
   bool toDeltaJson(char* out, size_t cap, uint32_t changeMask) const {
-    if (!out || cap == 0) return false;
-    int n = std::snprintf(out, cap, "{\"t\":%lu", static_cast<unsigned long>(now_.tsMs));
-    if (n <= 0 || static_cast<size_t>(n) >= cap) return false;
-    size_t len = static_cast<size_t>(n);
-
-    auto addField = [&](const char* key, const char* fmt, double v)->bool {
-      int m = std::snprintf(out + len, cap - len, ",\"%s\":", key);
-      if (m <= 0 || len + (size_t)m >= cap) return false;
-      len += (size_t)m;
-      m = std::snprintf(out + len, cap - len, fmt, v);
-      if (m <= 0 || len + (size_t)m >= cap) return false;
-      len += (size_t)m;
-      return true;
-    };
-
-    if (changeMask & ChangedAngle)    { if (!addField("ang",  "%.2f", static_cast<double>(now_.angleDeg))) return false; }
-    if (changeMask & ChangedButton)   { if (!addField("btn",  "%d",   now_.buttonPressed ? 1.0 : 0.0))     return false; }
-    if (changeMask & ChangedDistance) { if (!addField("dist", "%u",   static_cast<double>(now_.distanceMm))) return false; }
-    if (changeMask & ChangedPresence) { if (!addField("prs",  "%d",   now_.targetPresent ? 1.0 : 0.0))     return false; }
-
-    // finalize
-    if (len + 2 >= cap) return false;
-    out[len++] = '}';
-    out[len]   = '\0';
-    return true;
+    util::BufferSink sink(out, cap);
+    return writeDeltaJson(sink, changeMask) && sink.ok();
   }
 
-  float getAngleDeg() const { return now_.angleDeg; }
+  util::Angle getAngle() const { return now_.angle; }
   bool getLoaded() const { return now_.targetPresent; }
   bool getFired() const { return now_.buttonPressed; }
 
@@ -150,7 +201,7 @@ private:
   Snapshot last_{};
   uint32_t lastChangeMask_ = ChangedNone;
 
-  float    angleEpsDeg_        = kAngleEpsDeg;
+  std::array<uint16_t, schema::kFieldCount> deadband_ = util::schema::deadbands(schema::kFields);
   uint16_t presenceThresholdMm_ = 50;      // Cannonball must be within 50mm to be "loaded"
   uint32_t heartbeatMs_         = 2000;    // publish time-only heartbeat every 2s
   uint32_t lastHeartbeat_       = 0;
@@ -1,81 +1,77 @@
 #pragma once
 #include <cstddef>
 #include <cstdio>
-#include <cmath>
 #include "boardkit.hpp"
+#include "util/Angle.h"
+#include "telemetry/CannonTopics.h"
 
 namespace integ
 {
 
-  // Let you route topic assembly through your MqttTopic helper
-  using TopicBuilderFn = int (*)(char *out, std::size_t cap,
-                                 const char *base, const char *leaf);
-
-  inline int defaultJoin(char *out, std::size_t cap,
-                         const char *base, const char *leaf)
-  {
-    return std::snprintf(out, cap, "%s/%s", base, leaf);
-  }
+  enum class CannonEvent : uint8_t { Loaded, Fired };
 
   class CannonTelemetry
   {
   public:
-    CannonTelemetry(mqtt::IMqttClient &client,
-                    const char *base = "MermaidsTale",
-                    TopicBuilderFn builder = &defaultJoin)
-        : client_(client), base_(base), build_(builder) {}
+    CannonTelemetry(mqtt::IMqttClient &client, const cannon::Topics &topics)
+        : client_(client), topics_(topics) {}
 
     /**
-     * Publish cannon angle in degrees.
-     * Topic format: MermaidsTale/Cannon{id}/Hor (with slash for consistency)
+     * Publish cannon angle, rounded to whole degrees.
+     * Topic format: MermaidsTale/Cannon{id}/Hor
      * Payload format: pre_{angle} (as expected by game)
      */
-    void publishAngle(uint8_t cannonId, float angleDeg)
+    void publishAngle(util::Angle angle)
     {
-      const int n = normalize360(angleDeg);
-      char leaf[24];
-      std::snprintf(leaf, sizeof(leaf), "Cannon%d/Hor", cannonId); // FIXED: Added slash
-
-      char topic[96];
-      if (build_(topic, sizeof(topic), base_, leaf) <= 0)
-        return;
-
-      char payload[16];
-      std::snprintf(payload, sizeof(payload), "pre_%d", n); // game expects "pre_<deg>"
-      client_.publish(topic, payload, /*retain=*/false, /*qos=*/0);
+      char payload[16] = "pre_";                 // game expects "pre_<deg>"
+      appendUnsigned(payload + 4, angle.deg());
+      client_.publish(topics_[cannon::TopicHor], payload, /*retain=*/false, /*qos=*/0);
     }
 
     /**
      * Publish cannon event (Loaded or Fired).
-     * Topic format: MermaidsTale/Cannon{id}/{event} (with slash for consistency)
+     * Topic format: MermaidsTale/Cannon{id}/{event}
      * Payload: "triggered" (as expected by game)
+     * QoS1: held until the broker acknowledges it (backends without QoS1 send QoS0).
      */
-    void publishEvent(uint8_t cannonId, const char *which /* "Loaded" or "Fired" */)
+    void publishEvent(CannonEvent which)
     {
-      char leaf[32];
-      std::snprintf(leaf, sizeof(leaf), "Cannon%d/%s", cannonId, which); // FIXED: Added slash
+      client_.publish(topics_[eventTopic(which)], "triggered", /*retain=*/false, /*qos=*/1); // game expects "triggered"
+    }
 
-      char topic[96];
-      if (build_(topic, sizeof(topic), base_, leaf) <= 0)
-        return;
+    /**
+     * Publish cannon event plus the time it physically happened.
+     * The game payload stays "triggered"; the device timestamp (micros) goes
+     * to MermaidsTale/Cannon{id}/{event}/at so existing consumers are unaffected.
+     */
+    void publishEvent(CannonEvent which, uint32_t eventUs)
+    {
+      publishEvent(which);
 
-      client_.publish(topic, "triggered", /*retain=*/false, /*qos=*/0); // game expects "triggered"
+      char payload[12];
+      appendUnsigned(payload, eventUs);
+      const cannon::Topic at = (which == CannonEvent::Fired) ? cannon::TopicFiredAt
+                                                             : cannon::TopicLoadedAt;
+      client_.publish(topics_[at], payload, /*retain=*/false, /*qos=*/0);
     }
 
   private:
-    /**
-     * Normalize angle to 0-359 degrees range.
-     */
-    static int normalize360(float deg)
+    static cannon::Topic eventTopic(CannonEvent which)
+    {
+      return (which == CannonEvent::Fired) ? cannon::TopicFired : cannon::TopicLoaded;
+    }
+
+    // Decimal digits + NUL; out must hold 11 bytes
+    static void appendUnsigned(char *out, uint32_t v)
     {
-      float m = std::fmod(deg, 360.0f);
-      if (m < 0.0f)
-        m += 360.0f;
-      return static_cast<int>(std::lround(m));
+      char tmp[10];
+      int n = 0;
+      do { tmp[n++] = char('0' + v % 10); v /= 10; } while (v);
+      while (n) *out++ = tmp[--n];
+      *out = '\0';
     }
 
     mqtt::IMqttClient &client_;
-    const char *base_;
-    TopicBuilderFn build_;
+    const cannon::Topics &topics_;
   };
 } // namespace integ
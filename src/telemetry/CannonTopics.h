@@ -0,0 +1,115 @@
+#pragma once
+/**
+ * @file CannonTopics.h
+ * @brief Every topic one cannon publishes or subscribes to, built once at boot.
+ *
+ * Layout: <base>/Cannon<id>/<leaf>, e.g. MermaidsTale/Cannon2/Hor.
+ * Commands arrive on the kCommands topics and on the room-wide broadcast
+ * <base>/Cannons/<leaf>; find() maps an exact topic back to its id by hash.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include "protocols/mqtt/MqttTopicTable.h"
+
+namespace cannon {
+
+enum Topic : uint8_t {
+  // Published
+  TopicHor = 0,     // "pre_<deg>" angle
+  TopicLoaded,      // "triggered"
+  TopicFired,       // "triggered"
+  TopicLoadedAt,    // device time of the Loaded event
+  TopicFiredAt,     // device time of the Fired event
+  TopicStatus,      // retained one-line status (also subscribed: "request")
+  TopicDiagnostics, // retained detail
+  TopicMemory,      // retained heap + task stack watermarks (JSON)
+  TopicSensors,     // reset results
+  TopicI2C,         // bus scan results
+  TopicPerf,        // stage timing summary (PROF_ENABLED builds)
+  TopicTraceData,   // binary trace frames (see TraceFrame.h)
+  TopicTransport,   // per-transport publish latency (JSON)
+  TopicBoot,        // retained boot-to-first-publish timing
+  TopicConfigState, // retained publish governor limits (JSON)
+  TopicOtaStatus,   // retained OTA progress / running slot ("running app0")
+  TopicProbe,       // latency records while probing (see LatencyProbe.h)
+  TopicPong,        // ping echo + device micros()
+  // Subscribed (each also reaches us as <base>/Cannons/<leaf>)
+  TopicReset,       // "true"/"all", "angle", "distance" -> sensor reset; we publish "complete"
+                    // "rescan" -> forget the boot cache and restart
+  TopicTrace,       // "on" | "on <samples per frame>" | "off"
+  TopicRates,       // "<job>=<hz>|<n>ms ..." scheduler rates, e.g. "angle=200"
+  TopicConfig,      // "<topic>.<limit>=<n> ..." publish governor, e.g. "hor.interval=100";
+                    // "defaults" -> compiled-in limits (kept in NVS either way);
+                    // "id=<n>" (unicast) -> this board becomes CannonN, restarts
+  TopicOta,         // "http://host[:port]/fw.bin[.gz]" -> pull and install;
+                    // "confirm", "rollback", "abort"
+  TopicPing,        // "<token>" -> pong; keeps probe records flowing for a while
+  TopicCount
+};
+
+class Topics {
+public:
+  /** Build all entries for cannon `id` under `base` (e.g. "MermaidsTale"). */
+  bool build(const char* base, uint8_t id) {
+    std::snprintf(device_, sizeof(device_), "Cannon%u", static_cast<unsigned>(id));
+    std::snprintf(base_, sizeof(base_), "%s/%s", base, device_);
+    std::snprintf(room_, sizeof(room_), "%s", base);
+
+    bool ok = true;
+    ok &= table_.set(TopicHor,         {base, device_, "Hor"});
+    ok &= table_.set(TopicLoaded,      {base, device_, "Loaded"});
+    ok &= table_.set(TopicFired,       {base, device_, "Fired"});
+    ok &= table_.set(TopicLoadedAt,    {base, device_, "Loaded", "at"});
+    ok &= table_.set(TopicFiredAt,     {base, device_, "Fired", "at"});
+    ok &= table_.set(TopicStatus,      {base, device_, "status"});
+    ok &= table_.set(TopicDiagnostics, {base, device_, "diagnostics"});
+    ok &= table_.set(TopicMemory,      {base, device_, "diagnostics", "memory"});
+    ok &= table_.set(TopicSensors,     {base, device_, "sensors"});
+    ok &= table_.set(TopicI2C,         {base, device_, "i2c"});
+    ok &= table_.set(TopicPerf,        {base, device_, "perf"});
+    ok &= table_.set(TopicTraceData,   {base, device_, "trace", "data"});
+    ok &= table_.set(TopicTransport,   {base, device_, "transport"});
+    ok &= table_.set(TopicBoot,        {base, device_, "boot"});
+    ok &= table_.set(TopicConfigState, {base, device_, "config", "current"});
+    ok &= table_.set(TopicOtaStatus,   {base, device_, "ota", "status"});
+    ok &= table_.set(TopicProbe,       {base, device_, "probe"});
+    ok &= table_.set(TopicPong,        {base, device_, "pong"});
+    ok &= table_.set(TopicReset,       {base, device_, "reset"});
+    ok &= table_.set(TopicTrace,       {base, device_, "trace"});
+    ok &= table_.set(TopicRates,       {base, device_, "rates"});
+    ok &= table_.set(TopicConfig,      {base, device_, "config"});
+    ok &= table_.set(TopicOta,         {base, device_, "ota"});
+    ok &= table_.set(TopicPing,        {base, device_, "ping"});
+    return ok;
+  }
+
+  const char* operator[](Topic t) const { return table_[t]; }
+
+  /** "<base>/Cannon<id>" (for TelemetryPublisher-style leaf joining). */
+  const char* base() const { return base_; }
+
+  /** Topic id for an inbound topic, or TopicCount if it is not ours. */
+  Topic find(const char* topic) const {
+    const int id = table_.find(topic);
+    return id < 0 ? TopicCount : static_cast<Topic>(id);
+  }
+
+  /** "<base>" (e.g. MermaidsTale), for command filters. */
+  const char* room() const { return room_; }
+
+  /** Unicast command topics, subscribed after every connect. */
+  static constexpr Topic kCommands[] = { TopicReset, TopicStatus, TopicTrace, TopicRates, TopicConfig,
+                                         TopicOta, TopicPing };
+
+  /** Device level of room-wide commands: "<base>/Cannons/<cmd>" reaches every cannon. */
+  static constexpr const char* kBroadcast = "Cannons";
+
+private:
+  mqttt::TopicTable<TopicCount> table_;
+  char device_[16] = {};
+  char base_[64] = {};
+  char room_[32] = {};
+};
+
+} // namespace cannon
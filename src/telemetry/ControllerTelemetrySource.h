@@ -7,23 +7,36 @@ class ControllerTelemetrySource : public ITelemetrySource {
 public:
   explicit ControllerTelemetrySource(ctl::State& s) : s_(s) {}
 
-  bool buildDeltaJson(char* out, std::size_t cap) override {
+  bool writeDeltaJson(util::ByteSink& out) override {
     const auto changed = s_.lastChangeMask();
     if (!changed) return false;
-    const auto n = s_.toDeltaJson(out, cap, changed);
-    safeTerm(out, cap, n);
-    return n > 0;
+    return s_.writeDeltaJson(out, changed);
   }
 
-  std::size_t buildSnapshotJson(char* out, std::size_t cap) override {
-    const auto n = s_.toJson(out, cap);
-    safeTerm(out, cap, n);
-    return n;
+  bool writeSnapshotJson(util::ByteSink& out) override {
+    return s_.writeJson(out);
+  }
+
+  bool writeDelta(util::ByteSink& out, TelemetryEncoding enc) override {
+    const auto changed = s_.lastChangeMask();
+    if (!changed) return false;
+    switch (enc) {
+      case TelemetryEncoding::Json:   return s_.writeDeltaJson(out, changed);
+      case TelemetryEncoding::Cbor:   return s_.writeCbor(out, changed);
+      case TelemetryEncoding::Packed: return s_.writePacked(out, changed);
+    }
+    return false;
+  }
+
+  bool writeSnapshot(util::ByteSink& out, TelemetryEncoding enc) override {
+    switch (enc) {
+      case TelemetryEncoding::Json:   return s_.writeJson(out);
+      case TelemetryEncoding::Cbor:   return s_.writeCbor(out, ctl::kAllFields);
+      case TelemetryEncoding::Packed: return s_.writePacked(out, ctl::kAllFields);
+    }
+    return false;
   }
 
 private:
   ctl::State& s_;
-  static void safeTerm(char* out, std::size_t cap, std::size_t n) {
-    if (cap) out[(n < cap) ? n : cap - 1] = '\0';
-  }
 };
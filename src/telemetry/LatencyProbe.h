@@ -0,0 +1,94 @@
+#pragma once
+/**
+ * @file LatencyProbe.h
+ * @brief Latency instrumentation records: one per game publish, plus the
+ *        ping/pong exchange a host uses to line up its clock with ours.
+ *
+ * While probing (armed by CannonN/ping), every Hor/Loaded/Fired publish is
+ * followed, in the same outbound order, by one text line on CannonN/probe:
+ *
+ *   "<kind> <seq> <sampleUs> <stateUs> <publishUs>"     e.g. "F 7 81234 81310 81502"
+ *
+ *   kind       H (angle), L (Loaded), F (Fired)
+ *   seq        per-cannon record counter (wraps); a gap = records lost
+ *   sampleUs   when it physically happened: button edge (ISR), ALS31300 or
+ *              VL6180X sample
+ *   stateUs    when the sensor task committed it to ctl::State
+ *   publishUs  when the network task handed the game message to the client
+ *
+ * All times are the device's micros() (32-bit, wraps every ~71 min; take
+ * differences as uint32_t). The game payloads themselves are unchanged.
+ *
+ * Clock offset: the host publishes "<token...>" on CannonN/ping (or the
+ * broadcast Cannons/ping); the device answers "<token...> <deviceUs>" on
+ * CannonN/pong. With the host's send/receive times, NTP-style
+ * offset = deviceUs - (sent + received) / 2; the lowest-RTT exchange wins.
+ *
+ * No Arduino deps; shared by the firmware and the host probe tool.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include "util/TextFormat.h"
+
+namespace integ {
+
+enum class ProbeKind : char { Angle = 'H', Loaded = 'L', Fired = 'F' };
+
+/** Longest probe line: kind, then four 10-digit fields, space separated. */
+constexpr std::size_t kMaxProbeLen = 2 + 4 * 10 + 3;
+/** Ping tokens echoed back; longer ones are cut to this. */
+constexpr std::size_t kMaxPingToken = 64;
+/** Longest pong: the token, a space, a 10-digit micros(). */
+constexpr std::size_t kMaxPongLen = kMaxPingToken + 1 + 10;
+
+struct ProbeRecord {
+  ProbeKind kind      = ProbeKind::Angle;
+  uint32_t  seq       = 0;
+  uint32_t  sampleUs  = 0;
+  uint32_t  stateUs   = 0;
+  uint32_t  publishUs = 0;
+};
+
+/** Record -> text line. False if it did not fit. */
+inline bool writeProbe(util::TextWriter& w, const ProbeRecord& r) {
+  return w.ch(static_cast<char>(r.kind)).ch(' ').u32(r.seq)
+          .ch(' ').u32(r.sampleUs).ch(' ').u32(r.stateUs).ch(' ').u32(r.publishUs).ok();
+}
+
+namespace probe_detail {
+// One unsigned decimal field; advances p past it and one trailing space
+inline bool field(const char*& p, const char* end, uint32_t& out) {
+  if (p >= end || *p < '0' || *p > '9') return false;
+  uint32_t v = 0;
+  while (p < end && *p >= '0' && *p <= '9') v = v * 10u + static_cast<uint32_t>(*p++ - '0');
+  if (p < end && *p == ' ') ++p;
+  out = v;
+  return true;
+}
+} // namespace probe_detail
+
+/** Text line (not NUL-terminated) -> record. False for anything malformed. */
+inline bool parseProbe(const char* text, std::size_t len, ProbeRecord& r) {
+  const char* p = text;
+  const char* end = text + len;
+  if (len < 2 || p[1] != ' ') return false;
+  switch (p[0]) {
+    case 'H': r.kind = ProbeKind::Angle;  break;
+    case 'L': r.kind = ProbeKind::Loaded; break;
+    case 'F': r.kind = ProbeKind::Fired;  break;
+    default:  return false;
+  }
+  p += 2;
+  using probe_detail::field;
+  return field(p, end, r.seq) && field(p, end, r.sampleUs) &&
+         field(p, end, r.stateUs) && field(p, end, r.publishUs) && p == end;
+}
+
+/** Pong payload: the ping payload echoed, then our micros(). */
+inline bool writePong(util::TextWriter& w, const char* ping, std::size_t len, uint32_t deviceUs) {
+  return w.str(ping, len).ch(' ').u32(deviceUs).ok();
+}
+
+} // namespace integ
@@ -0,0 +1,41 @@
+#include "ResourceMonitor.h"
+#include <esp_heap_caps.h>
+#include "util/JsonWriter.h"
+
+bool ResourceMonitor::watch(const char* name, TaskHandle_t task) {
+  if (!task || count_ >= kMaxTasks) return false;
+  tasks_[count_].name = name;
+  tasks_[count_].task = task;
+  ++count_;
+  return true;
+}
+
+// ============================================================================
+// Snapshot heap and stacks
+// ============================================================================
+void ResourceMonitor::capture() {
+  free_    = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  minFree_ = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  largest_ = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  for (size_t i = 0; i < count_; ++i) {
+    // ESP-IDF counts stack in bytes (StackType_t is uint8_t)
+    tasks_[i].spare = uxTaskGetStackHighWaterMark(tasks_[i].task) * sizeof(StackType_t);
+  }
+}
+
+// ============================================================================
+// JSON summary
+// ============================================================================
+bool ResourceMonitor::writeJson(util::ByteSink& out) const {
+  util::JsonWriter w(out);
+  w.beginObject()
+   .key(JSON_KEY("heap")).beginObject()
+     .key(JSON_KEY("free")).u32(free_)
+     .key(JSON_KEY("min")).u32(minFree_)
+     .key(JSON_KEY("largest")).u32(largest_)
+   .endObject()
+   .key(JSON_KEY("stack")).beginObject();
+  for (size_t i = 0; i < count_; ++i) w.key(tasks_[i].name).u32(tasks_[i].spare);
+  w.endObject().endObject();
+  return w.flush();
+}
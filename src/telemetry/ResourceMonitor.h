@@ -0,0 +1,48 @@
+#pragma once
+/**
+ * ResourceMonitor
+ * - Long-run health of the heap and the task stacks, for cannons that run
+ *   for weeks between power cycles.
+ * - capture() snapshots free heap, the lowest it has ever been, and the
+ *   largest free block (free minus largest = how fragmented it is), plus
+ *   each watched task's stack high-water mark (bytes never used).
+ * - writeJson() stays under ~300 bytes with kMaxTasks entries, so it fits
+ *   a buffer and one OutboundQueue slot (retained, replayed on reconnect).
+ * - Fixed table of tasks, no heap. Network task only.
+ *
+ * This file is framework-specific (ESP-IDF heap_caps / FreeRTOS under Arduino).
+ */
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "util/ByteSink.h"
+
+class ResourceMonitor {
+public:
+  static constexpr size_t kMaxTasks = 8;
+
+  /** Watch `task` under `name` (a literal); nullptr handles are skipped. */
+  bool watch(const char* name, TaskHandle_t task);
+
+  void capture();
+
+  /** {"heap":{"free":..,"min":..,"largest":..},"stack":{"net":1840,...}} (bytes) */
+  bool writeJson(util::ByteSink& out) const;
+
+  uint32_t freeHeap() const { return free_; }
+  uint32_t minFreeHeap() const { return minFree_; }
+  uint32_t largestFreeBlock() const { return largest_; }
+
+private:
+  struct Task {
+    const char*  name  = nullptr;
+    TaskHandle_t task  = nullptr;
+    uint32_t     spare = 0;   // high-water mark at the last capture
+  };
+
+  Task     tasks_[kMaxTasks];
+  size_t   count_   = 0;
+  uint32_t free_    = 0;
+  uint32_t minFree_ = 0;
+  uint32_t largest_ = 0;
+};
@@ -0,0 +1,117 @@
+#pragma once
+/**
+ * @file TraceFrame.h
+ * @brief Full-rate sensor trace samples and their batched, delta-encoded frames.
+ *
+ * The sensor task records one TraceSample per cycle while tracing is on.
+ * The network task batches N of them into one MQTT message:
+ *
+ *   Frame v1 (little-endian):
+ *     [0]    'T'
+ *     [1]    version (kTraceVersion)
+ *     [2]    sample count N (1..255)
+ *     [3]    reserved, 0
+ *     [4..5] frame sequence number (wraps)
+ *     [6..7] samples dropped since the previous frame (saturating)
+ *     then N samples; every field is a zigzag LEB128 varint of its
+ *     difference from the previous sample (the first sample is relative
+ *     to all-zero), in TraceSample field order:
+ *       tsMs, rawX, rawY, rawZ, x, y, z, angleCdeg, rangeMm, distanceMm,
+ *       rangeStatus, flags
+ *
+ * Steady signals delta to 0, so a sample is typically 12-16 bytes
+ * against 24 in memory. No Arduino deps.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace integ {
+
+constexpr uint8_t kTraceVersion = 1;
+
+/** Everything tuning needs from one sensor cycle. */
+struct TraceSample {
+  uint32_t tsMs        = 0;
+  int16_t  rawX        = 0;   // ALS31300 unfiltered field
+  int16_t  rawY        = 0;
+  int16_t  rawZ        = 0;
+  int16_t  x           = 0;   // ALS31300 filtered field
+  int16_t  y           = 0;
+  int16_t  z           = 0;
+  uint16_t angleCdeg   = 0;   // driver angle, centi-degrees
+  uint8_t  rangeMm     = 0;   // last raw VL6180X range
+  uint8_t  distanceMm  = 0;   // filtered distance fed to ctl::State
+  uint8_t  rangeStatus = 0;
+  uint8_t  flags       = 0;   // TraceFlag bits
+};
+
+enum TraceFlag : uint8_t {
+  TraceButton     = 1u << 0,
+  TraceAlsOk      = 1u << 1,
+  TraceRangeFresh = 1u << 2,  // rangeMm/rangeStatus are from this cycle
+  TracePresent    = 1u << 3,
+};
+
+/** Upper bound for one encoded sample (tsMs delta: 5 bytes, 11 others: 3). */
+constexpr std::size_t kTraceSampleMaxBytes = 5 + 11 * 3;
+constexpr std::size_t kTraceHeaderBytes    = 8;
+
+constexpr std::size_t traceFrameMaxBytes(std::size_t samples) {
+  return kTraceHeaderBytes + samples * kTraceSampleMaxBytes;
+}
+
+namespace detail {
+
+inline std::size_t putVarint(uint8_t* out, uint32_t v) {
+  std::size_t n = 0;
+  while (v >= 0x80) { out[n++] = uint8_t(v | 0x80); v >>= 7; }
+  out[n++] = uint8_t(v);
+  return n;
+}
+
+// Zigzag keeps small negative deltas small: 0,-1,1,-2 -> 0,1,2,3
+inline uint32_t zigzag(int32_t d) {
+  return (static_cast<uint32_t>(d) << 1) ^ static_cast<uint32_t>(d >> 31);
+}
+
+} // namespace detail
+
+/**
+ * Encode `n` samples (1..255) into out. Returns the frame length, or 0 if
+ * `cap` is below traceFrameMaxBytes(n) or n is out of range.
+ */
+inline std::size_t encodeTraceFrame(const TraceSample* s, std::size_t n,
+                                    uint16_t seq, uint16_t dropped,
+                                    uint8_t* out, std::size_t cap) {
+  if (!s || !out || n == 0 || n > 255 || cap < traceFrameMaxBytes(n)) return 0;
+
+  out[0] = 'T';
+  out[1] = kTraceVersion;
+  out[2] = uint8_t(n);
+  out[3] = 0;
+  out[4] = uint8_t(seq);     out[5] = uint8_t(seq >> 8);
+  out[6] = uint8_t(dropped); out[7] = uint8_t(dropped >> 8);
+  std::size_t len = kTraceHeaderBytes;
+
+  TraceSample prev{};
+  for (std::size_t i = 0; i < n; ++i) {
+    const TraceSample& c = s[i];
+    // Timestamps only move forward: plain varint of the (unsigned) step
+    len += detail::putVarint(out + len, c.tsMs - prev.tsMs);
+    const int32_t d[] = {
+      c.rawX - prev.rawX, c.rawY - prev.rawY, c.rawZ - prev.rawZ,
+      c.x - prev.x,       c.y - prev.y,       c.z - prev.z,
+      int32_t(c.angleCdeg) - prev.angleCdeg,
+      int32_t(c.rangeMm) - prev.rangeMm,
+      int32_t(c.distanceMm) - prev.distanceMm,
+      int32_t(c.rangeStatus) - prev.rangeStatus,
+      int32_t(c.flags) - prev.flags,
+    };
+    for (int32_t v : d) len += detail::putVarint(out + len, detail::zigzag(v));
+    prev = c;
+  }
+  return len;
+}
+
+} // namespace integ
@@ -0,0 +1,255 @@
+// Host latency probe: pio run -e probe && .pio/build/probe/program [--host h] [--seconds n]
+//
+// Subscribes to every cannon's CannonN/probe and CannonN/pong, pings the
+// room (Cannons/ping) to keep the probe records flowing and to line up each
+// cannon's micros() with the host clock, and reports per-stage latency
+// percentiles and sequence gaps. One JSON object per line, like the benches:
+//
+//   {"cannon":"Cannon2","kind":"F","stage":"total","n":40,"p50_us":..,"p90_us":..,"p99_us":..,"max_us":..}
+//   {"cannon":"Cannon2","records":120,"gaps":0,"rtt_min_us":2100,"offset_known":true}
+//
+// Stages (see telemetry/LatencyProbe.h):
+//   sample_to_state    physical event -> sensor task commit
+//   state_to_publish   commit -> network task publish call
+//   publish_to_host    publish call -> arrival here through the broker
+//   total              physical event -> arrival here
+// Run it on the broker's machine and publish_to_host is publish -> broker
+// receipt plus a loopback hop.
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "net/PosixSocketClient.h"
+#include "protocols/mqtt/MqttNativeClient.h"
+#include "telemetry/LatencyProbe.h"
+
+namespace {
+
+struct Options {
+  const char* host     = "10.1.10.115";
+  uint16_t    port     = 1883;
+  const char* room     = "MermaidsTale";
+  double      seconds  = 0;       // 0 = until Ctrl-C
+  uint32_t    pingMs   = 1000;
+  uint32_t    reportMs = 10000;
+};
+
+enum Stage : int { SampleToState, StateToPublish, PublishToHost, Total, StageCount };
+const char* const kStageNames[StageCount] = { "sample_to_state", "state_to_publish", "publish_to_host", "total" };
+const char kKinds[] = { 'H', 'L', 'F' };
+constexpr int kKindCount = 3;
+
+// Min-RTT pick over the last few pongs: tracks crystal drift, rejects queued ones
+constexpr int kOffsetWindow = 8;
+
+struct Cannon {
+  char     name[16] = {};
+  uint32_t records  = 0;
+  uint32_t gaps     = 0;
+  bool     seqKnown = false;
+  uint32_t lastSeq  = 0;
+
+  struct Sync { uint32_t rttUs; uint32_t offsetUs; };
+  Sync     sync[kOffsetWindow] = {};
+  int      syncCount = 0;
+  int      syncNext  = 0;
+
+  std::vector<uint32_t> samples[kKindCount][StageCount];
+
+  bool offsetKnown() const { return syncCount > 0; }
+  // device micros() - host micros(), from the lowest-RTT exchange in the window
+  uint32_t offset(uint32_t* rttOut = nullptr) const {
+    int best = 0;
+    for (int i = 1; i < syncCount; ++i) if (sync[i].rttUs < sync[best].rttUs) best = i;
+    if (rttOut) *rttOut = sync[best].rttUs;
+    return sync[best].offsetUs;
+  }
+};
+
+Options                 gOpt;
+std::vector<Cannon>     gCannons;
+uint32_t                gPingSeq = 0;
+volatile std::sig_atomic_t gStop = 0;
+
+uint32_t hostUs() {
+  using namespace std::chrono;
+  return static_cast<uint32_t>(duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count());
+}
+uint32_t hostMs() { return hostUs() / 1000u; }
+
+Cannon& cannonFor(const char* name, std::size_t len) {
+  for (Cannon& c : gCannons) {
+    if (std::strlen(c.name) == len && std::strncmp(c.name, name, len) == 0) return c;
+  }
+  gCannons.emplace_back();
+  Cannon& c = gCannons.back();
+  std::snprintf(c.name, sizeof(c.name), "%.*s", static_cast<int>(len), name);
+  return c;
+}
+
+int kindIndex(integ::ProbeKind k) {
+  for (int i = 0; i < kKindCount; ++i) if (kKinds[i] == static_cast<char>(k)) return i;
+  return 0;
+}
+
+// "<seq> <hostUs> <deviceUs>"
+void onPong(Cannon& c, const char* p, std::size_t len, uint32_t nowUs) {
+  char buf[64];
+  std::snprintf(buf, sizeof(buf), "%.*s", static_cast<int>(len < 63 ? len : 63), p);
+  char* end = nullptr;
+  std::strtoul(buf, &end, 10);
+  const uint32_t sentUs = static_cast<uint32_t>(std::strtoul(end, &end, 10));
+  const uint32_t devUs  = static_cast<uint32_t>(std::strtoul(end, &end, 10));
+  if (!end || end == buf) return;
+
+  const uint32_t rtt = nowUs - sentUs;
+  // Device clock read half way through the round trip (NTP midpoint)
+  c.sync[c.syncNext] = { rtt, devUs - (sentUs + rtt / 2) };
+  c.syncNext = (c.syncNext + 1) % kOffsetWindow;
+  if (c.syncCount < kOffsetWindow) ++c.syncCount;
+}
+
+void onProbe(Cannon& c, const char* p, std::size_t len, uint32_t nowUs) {
+  integ::ProbeRecord r;
+  if (!integ::parseProbe(p, len, r)) return;
+  ++c.records;
+  if (c.seqKnown && r.seq != c.lastSeq + 1) {
+    const uint32_t missed = r.seq - c.lastSeq - 1;   // wraps; a reboot restarts at 0
+    if (missed < 0x80000000u) c.gaps += missed;
+  }
+  c.seqKnown = true;
+  c.lastSeq = r.seq;
+
+  auto& s = c.samples[kindIndex(r.kind)];
+  s[SampleToState].push_back(r.stateUs - r.sampleUs);
+  s[StateToPublish].push_back(r.publishUs - r.stateUs);
+  if (c.offsetKnown()) {
+    const uint32_t arrivalDevUs = nowUs + c.offset();
+    s[PublishToHost].push_back(arrivalDevUs - r.publishUs);
+    s[Total].push_back(arrivalDevUs - r.sampleUs);
+  }
+}
+
+// "<room>/<CannonN>/<leaf>"
+void onMessage(const char* topic, const uint8_t* payload, std::size_t len) {
+  const uint32_t nowUs = hostUs();
+  const char* dev = std::strchr(topic, '/');
+  if (!dev) return;
+  ++dev;
+  const char* leaf = std::strchr(dev, '/');
+  if (!leaf) return;
+  Cannon& c = cannonFor(dev, static_cast<std::size_t>(leaf - dev));
+  ++leaf;
+  const char* text = reinterpret_cast<const char*>(payload);
+  if (std::strcmp(leaf, "probe") == 0) onProbe(c, text, len, nowUs);
+  else if (std::strcmp(leaf, "pong") == 0) onPong(c, text, len, nowUs);
+}
+
+uint32_t percentile(const std::vector<uint32_t>& sorted, double q) {
+  const std::size_t rank = static_cast<std::size_t>(q * static_cast<double>(sorted.size() - 1) + 0.5);
+  return sorted[rank];
+}
+
+void report() {
+  std::vector<uint32_t> v;
+  for (const Cannon& c : gCannons) {
+    for (int k = 0; k < kKindCount; ++k) {
+      for (int st = 0; st < StageCount; ++st) {
+        v = c.samples[k][st];
+        if (v.empty()) continue;
+        std::sort(v.begin(), v.end());
+        std::printf("{\"cannon\":\"%s\",\"kind\":\"%c\",\"stage\":\"%s\",\"n\":%zu,"
+                    "\"p50_us\":%u,\"p90_us\":%u,\"p99_us\":%u,\"max_us\":%u}\n",
+                    c.name, kKinds[k], kStageNames[st], v.size(),
+                    percentile(v, 0.50), percentile(v, 0.90), percentile(v, 0.99), v.back());
+      }
+    }
+    uint32_t rtt = 0;
+    if (c.offsetKnown()) c.offset(&rtt);
+    std::printf("{\"cannon\":\"%s\",\"records\":%u,\"gaps\":%u,\"rtt_min_us\":%u,\"offset_known\":%s}\n",
+                c.name, c.records, c.gaps, rtt, c.offsetKnown() ? "true" : "false");
+  }
+  std::fflush(stdout);
+}
+
+void ping(mqtt::IMqttClient& client) {
+  char topic[64];
+  char payload[32];
+  std::snprintf(topic, sizeof(topic), "%s/Cannons/ping", gOpt.room);
+  std::snprintf(payload, sizeof(payload), "%u %u", gPingSeq++, hostUs());
+  client.publish(topic, payload, false, 0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--host") && i + 1 < argc)           gOpt.host = argv[++i];
+    else if (!std::strcmp(argv[i], "--port") && i + 1 < argc)      gOpt.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+    else if (!std::strcmp(argv[i], "--room") && i + 1 < argc)      gOpt.room = argv[++i];
+    else if (!std::strcmp(argv[i], "--seconds") && i + 1 < argc)   gOpt.seconds = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "--ping-ms") && i + 1 < argc)   gOpt.pingMs = static_cast<uint32_t>(std::atoi(argv[++i]));
+    else if (!std::strcmp(argv[i], "--report-ms") && i + 1 < argc) gOpt.reportMs = static_cast<uint32_t>(std::atoi(argv[++i]));
+    else {
+      std::fprintf(stderr, "usage: %s [--host h] [--port n] [--room base] [--seconds n] "
+                           "[--ping-ms n] [--report-ms n]\n", argv[0]);
+      return 2;
+    }
+  }
+  std::signal(SIGINT, [](int) { gStop = 1; });
+
+  PosixSocketClient sock;
+  sock.setTimeout(2000);
+  mqtt::NativeClient<1024, 1024> client(sock, &hostMs);
+  mqtt::Config cfg;
+  cfg.brokerHost = gOpt.host;
+  cfg.brokerPort = gOpt.port;
+  cfg.clientId   = "latency-probe";
+  client.begin(cfg);
+  client.onMessage(&onMessage);
+
+  char probeFilter[64];
+  char pongFilter[64];
+  std::snprintf(probeFilter, sizeof(probeFilter), "%s/+/probe", gOpt.room);
+  std::snprintf(pongFilter, sizeof(pongFilter), "%s/+/pong", gOpt.room);
+
+  const uint32_t startMs = hostMs();
+  uint32_t lastPingMs = 0;
+  uint32_t lastReportMs = startMs;
+  bool subscribed = false;
+  while (!gStop) {
+    const uint32_t now = hostMs();
+    if (gOpt.seconds > 0 && now - startMs >= gOpt.seconds * 1000.0) break;
+
+    if (client.state() == mqtt::NativeClient<1024, 1024>::State::Disconnected) {
+      subscribed = false;
+      if (!client.connect()) {
+        std::fprintf(stderr, "broker %s:%u not reachable, retrying\n", gOpt.host, gOpt.port);
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        continue;
+      }
+    }
+    if (!subscribed) {
+      const char* const filters[] = { probeFilter, pongFilter };
+      subscribed = client.subscribeBatch(filters, nullptr, 2);
+    }
+    client.loop();
+
+    if (client.connected() && now - lastPingMs >= gOpt.pingMs) {
+      lastPingMs = now;
+      ping(client);
+    }
+    if (gOpt.reportMs && now - lastReportMs >= gOpt.reportMs) {
+      lastReportMs = now;
+      report();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  report();
+  client.disconnect();
+  return 0;
+}